@@ -0,0 +1,93 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Linear interpolating resampler. One frame of delay, two multiplies per sample.
+// Used while in slow-motion where sinc would be wasted on stretched audio.
+
+#include "resampler.h"
+#include <stdlib.h>
+
+#ifndef RESAMPLER_TEST
+#include "../general.h"
+#else
+#include <stdio.h>
+#define RARCH_LOG(...) fprintf(stderr, __VA_ARGS__)
+#endif
+
+typedef struct rarch_linear_resampler
+{
+   float prev[2]; // Last frame of previous input chunk.
+   double pos;    // Position of next output frame, relative to start of next input chunk.
+} rarch_linear_resampler_t;
+
+static void resampler_linear_process(void *re_, struct resampler_data *data)
+{
+   rarch_linear_resampler_t *re = (rarch_linear_resampler_t*)re_;
+
+   const float *input = data->data_in;
+   float *output = data->data_out;
+   size_t frames = data->input_frames;
+   size_t out_frames = 0;
+   double step = 1.0 / data->ratio;
+
+   while (re->pos < frames)
+   {
+      size_t i = (size_t)re->pos;
+      float frac = (float)(re->pos - i);
+
+      // Output lags input by one frame so we never need to look ahead.
+      const float *a = i ? input + ((i - 1) << 1) : re->prev;
+      const float *b = input + (i << 1);
+
+      output[0] = a[0] + (b[0] - a[0]) * frac;
+      output[1] = a[1] + (b[1] - a[1]) * frac;
+      output += 2;
+      out_frames++;
+      re->pos += step;
+   }
+
+   if (frames)
+   {
+      re->prev[0] = input[((frames - 1) << 1) + 0];
+      re->prev[1] = input[((frames - 1) << 1) + 1];
+   }
+
+   re->pos -= frames;
+   data->output_frames = out_frames;
+}
+
+static void resampler_linear_free(void *re)
+{
+   free(re);
+}
+
+static void *resampler_linear_new(double bandwidth_mod)
+{
+   rarch_linear_resampler_t *re = (rarch_linear_resampler_t*)calloc(1, sizeof(*re));
+   if (!re)
+      return NULL;
+
+   (void)bandwidth_mod;
+   RARCH_LOG("Linear resampler [C]\n");
+   return re;
+}
+
+const rarch_resampler_t linear_resampler = {
+   resampler_linear_new,
+   resampler_linear_process,
+   resampler_linear_free,
+   "linear",
+};
+
@@ -0,0 +1,81 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Nearest-neighbour resampler. Picks one input frame per output frame.
+// Quality is poor, but the cost is independent of the ratio, which makes it
+// useful as a decimator while fast-forwarding.
+
+#include "resampler.h"
+#include <stdlib.h>
+
+#ifndef RESAMPLER_TEST
+#include "../general.h"
+#else
+#include <stdio.h>
+#define RARCH_LOG(...) fprintf(stderr, __VA_ARGS__)
+#endif
+
+typedef struct rarch_nearest_resampler
+{
+   double pos; // Position of next output frame, relative to start of next input chunk.
+} rarch_nearest_resampler_t;
+
+static void resampler_nearest_process(void *re_, struct resampler_data *data)
+{
+   rarch_nearest_resampler_t *re = (rarch_nearest_resampler_t*)re_;
+
+   const float *input = data->data_in;
+   float *output = data->data_out;
+   size_t frames = data->input_frames;
+   size_t out_frames = 0;
+   double step = 1.0 / data->ratio;
+
+   while (re->pos < frames)
+   {
+      size_t i = (size_t)re->pos;
+      output[0] = input[(i << 1) + 0];
+      output[1] = input[(i << 1) + 1];
+      output += 2;
+      out_frames++;
+      re->pos += step;
+   }
+
+   re->pos -= frames;
+   data->output_frames = out_frames;
+}
+
+static void resampler_nearest_free(void *re)
+{
+   free(re);
+}
+
+static void *resampler_nearest_new(double bandwidth_mod)
+{
+   rarch_nearest_resampler_t *re = (rarch_nearest_resampler_t*)calloc(1, sizeof(*re));
+   if (!re)
+      return NULL;
+
+   (void)bandwidth_mod;
+   RARCH_LOG("Nearest resampler [C]\n");
+   return re;
+}
+
+const rarch_resampler_t nearest_resampler = {
+   resampler_nearest_new,
+   resampler_nearest_process,
+   resampler_nearest_free,
+   "nearest",
+};
+
@@ -0,0 +1,67 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Null audio driver. Swallows samples without blocking.
+
+#include "../driver.h"
+#include <stdlib.h>
+
+static void *null_audio_init(const char *device, unsigned rate, unsigned latency)
+{
+   (void)device;
+   (void)rate;
+   (void)latency;
+   return calloc(1, sizeof(int));
+}
+
+static ssize_t null_audio_write(void *data, const void *buf, size_t size)
+{
+   (void)data;
+   (void)buf;
+   return size;
+}
+
+static bool null_audio_stop(void *data)
+{
+   (void)data;
+   return true;
+}
+
+static bool null_audio_start(void *data)
+{
+   (void)data;
+   return true;
+}
+
+static void null_audio_set_nonblock_state(void *data, bool state)
+{
+   (void)data;
+   (void)state;
+}
+
+static void null_audio_free(void *data)
+{
+   free(data);
+}
+
+const audio_driver_t audio_null = {
+   .init = null_audio_init,
+   .write = null_audio_write,
+   .stop = null_audio_stop,
+   .start = null_audio_start,
+   .set_nonblock_state = null_audio_set_nonblock_state,
+   .free = null_audio_free,
+   .ident = "null",
+};
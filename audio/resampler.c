@@ -19,6 +19,8 @@
 
 static const rarch_resampler_t *backends[] = {
    &sinc_resampler,
+   &linear_resampler,
+   &nearest_resampler,
    NULL,
 };
 
@@ -47,6 +47,8 @@ typedef struct rarch_resampler
 } rarch_resampler_t;
 
 extern const rarch_resampler_t sinc_resampler;
+extern const rarch_resampler_t linear_resampler;
+extern const rarch_resampler_t nearest_resampler;
 
 // Reallocs resampler. Will free previous handle before allocating a new one.
 // If ident is NULL, first resampler will be used.
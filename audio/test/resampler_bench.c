@@ -0,0 +1,424 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host-side quality and throughput benchmark for the rarch_resampler_t backends.
+// Build with the Makefile in this directory. Prints a markdown table to stdout.
+
+#include "../resampler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(SINC_LOWEST_QUALITY)
+#define SINC_QUALITY "lowest"
+#elif defined(SINC_LOWER_QUALITY)
+#define SINC_QUALITY "lower"
+#elif defined(SINC_HIGHER_QUALITY)
+#define SINC_QUALITY "higher"
+#elif defined(SINC_HIGHEST_QUALITY)
+#define SINC_QUALITY "highest"
+#else
+#define SINC_QUALITY "normal"
+#endif
+
+#define CHUNK_FRAMES 256 // Same as AUDIO_CHUNK_SIZE_BLOCKING.
+#define TEST_SECONDS 4
+#define WARMUP_FRAMES 4096
+#define HARMONICS 5
+#define SWEEP_WINDOW 1024
+#define MAX_DELAY 128 // In input frames, more than the widest sinc filter.
+#define DELAY_STEPS 16 // Fractional delay resolution.
+#define DELAY_STRIDE 4 // Output frames skipped per sample in the coarse delay search.
+#define WOBBLE 0.005 // Same as DEFAULT_AUDIO_RATE_CONTROL_DELTA.
+#define WOBBLE_PERIOD 64 // In chunks.
+
+static const rarch_resampler_t *backends[] = {
+   &sinc_resampler,
+   &linear_resampler,
+   &nearest_resampler,
+   NULL,
+};
+
+struct conversion
+{
+   double in_rate;
+   double out_rate;
+   bool wobble;
+};
+
+static const struct conversion conversions[] = {
+   { 32040.0, 48000.0, false },
+   { 32040.0, 48000.0, true },
+   { 32040.0, 32000.0, false },
+   { 44100.0, 48000.0, false },
+   { 44100.0, 48000.0, true },
+   { 48000.0, 32000.0, false },
+   { 48000.0, 32000.0, true },
+};
+
+static double get_time(void)
+{
+   struct timespec tv;
+   clock_gettime(CLOCK_MONOTONIC, &tv);
+   return tv.tv_sec + tv.tv_nsec / 1000000000.0;
+}
+
+static double chunk_ratio(const struct conversion *conv, unsigned chunk)
+{
+   double ratio = conv->out_rate / conv->in_rate;
+   if (conv->wobble)
+      ratio *= 1.0 + WOBBLE * sin(2.0 * M_PI * chunk / WOBBLE_PERIOD);
+   return ratio;
+}
+
+// Runs the whole input through a fresh resampler in CHUNK_FRAMES pieces.
+// For every output frame, the corresponding input time (in input frames) is recorded,
+// so the reference signal can be reconstructed even when the ratio wobbles.
+// For the tones, a constant resampler delay is just a phase offset which the fit absorbs.
+// For the sweep it is not, see estimate_delay().
+static size_t run_resampler(const rarch_resampler_t *backend, const struct conversion *conv,
+      const float *input, size_t frames, float *output, double *out_time, double *elapsed)
+{
+   unsigned chunk;
+   size_t i, out_frames = 0;
+   double t = 0.0;
+
+   void *re = backend->init(conv->out_rate / conv->in_rate);
+   if (!re)
+      return 0;
+
+   double start = get_time();
+   for (chunk = 0, i = 0; i + CHUNK_FRAMES <= frames; i += CHUNK_FRAMES, chunk++)
+   {
+      struct resampler_data data = {0};
+      data.data_in       = input + (i << 1);
+      data.data_out      = output + (out_frames << 1);
+      data.input_frames  = CHUNK_FRAMES;
+      data.ratio         = chunk_ratio(conv, chunk);
+      backend->process(re, &data);
+
+      if (out_time)
+      {
+         size_t j;
+         for (j = 0; j < data.output_frames; j++, t += 1.0 / data.ratio)
+            out_time[out_frames + j] = t;
+      }
+
+      out_frames += data.output_frames;
+   }
+   if (elapsed)
+      *elapsed = get_time() - start;
+
+   backend->free(re);
+   return out_frames;
+}
+
+// Solves the normal equations in place with Gaussian elimination. n is small.
+static void solve(double *m, double *v, unsigned n)
+{
+   unsigned i, j, k;
+   for (i = 0; i < n; i++)
+   {
+      unsigned pivot = i;
+      for (j = i + 1; j < n; j++)
+         if (fabs(m[j * n + i]) > fabs(m[pivot * n + i]))
+            pivot = j;
+
+      for (k = 0; k < n; k++)
+      {
+         double tmp = m[i * n + k];
+         m[i * n + k] = m[pivot * n + k];
+         m[pivot * n + k] = tmp;
+      }
+      double tmp = v[i];
+      v[i] = v[pivot];
+      v[pivot] = tmp;
+
+      if (fabs(m[i * n + i]) < 1e-12)
+         continue;
+
+      for (j = i + 1; j < n; j++)
+      {
+         double f = m[j * n + i] / m[i * n + i];
+         for (k = i; k < n; k++)
+            m[j * n + k] -= f * m[i * n + k];
+         v[j] -= f * v[i];
+      }
+   }
+
+   for (i = n; i-- > 0; )
+   {
+      for (j = i + 1; j < n; j++)
+         v[i] -= m[i * n + j] * v[j];
+      v[i] = fabs(m[i * n + i]) < 1e-12 ? 0.0 : v[i] / m[i * n + i];
+   }
+}
+
+// Least-squares fit of the fundamental and its harmonics (below output Nyquist)
+// against the resampled tone. SNR counts everything that isn't the fundamental as noise.
+static void measure_tone(const float *output, const double *out_time, size_t frames,
+      double omega, double out_rate, double in_rate, double *snr, double *thd)
+{
+   size_t i;
+   unsigned h, a, b, harmonics = 0;
+   double m[(2 * HARMONICS) * (2 * HARMONICS)] = {0.0};
+   double v[2 * HARMONICS] = {0.0};
+   double basis[2 * HARMONICS];
+
+   for (h = 1; h <= HARMONICS; h++)
+      if (omega * h * in_rate / (2.0 * M_PI) < 0.5 * out_rate)
+         harmonics = h;
+   unsigned n = 2 * harmonics;
+
+   for (i = WARMUP_FRAMES; i < frames; i++)
+   {
+      for (h = 0; h < harmonics; h++)
+      {
+         basis[2 * h + 0] = sin(omega * (h + 1) * out_time[i]);
+         basis[2 * h + 1] = cos(omega * (h + 1) * out_time[i]);
+      }
+
+      for (a = 0; a < n; a++)
+      {
+         v[a] += basis[a] * output[i << 1];
+         for (b = 0; b < n; b++)
+            m[a * n + b] += basis[a] * basis[b];
+      }
+   }
+
+   solve(m, v, n);
+
+   double fund_pow = 0.0, harm_pow = 0.0, noise_pow = 0.0;
+   for (i = WARMUP_FRAMES; i < frames; i++)
+   {
+      double fund = 0.0, harm = 0.0;
+      for (h = 0; h < harmonics; h++)
+      {
+         double val = v[2 * h + 0] * sin(omega * (h + 1) * out_time[i]) +
+            v[2 * h + 1] * cos(omega * (h + 1) * out_time[i]);
+         if (h == 0)
+            fund = val;
+         else
+            harm += val;
+      }
+
+      double noise = output[i << 1] - fund;
+      fund_pow  += fund * fund;
+      harm_pow  += harm * harm;
+      noise_pow += noise * noise;
+   }
+
+   *snr = 10.0 * log10(fund_pow / (noise_pow + 1e-30));
+   // No harmonics below output Nyquist, THD is meaningless.
+   *thd = harmonics > 1 ? 10.0 * log10((harm_pow + 1e-30) / fund_pow) : NAN;
+}
+
+// Exponential sweep phase, in radians, at input time t (input frames).
+static double sweep_phase(double t, double f0, double f1, double in_rate, size_t frames)
+{
+   double len = frames / in_rate;
+   double k = log(f1 / f0);
+   return 2.0 * M_PI * f0 * len / k * (exp(k * (t / in_rate) / len) - 1.0);
+}
+
+// Correlates the output against the sweep delayed by delay input frames.
+// Sine and cosine are both correlated so a constant phase offset doesn't matter.
+static double sweep_correlation(const float *output, const double *out_time, size_t frames,
+      size_t stride, double delay, double f0, double f1, double in_rate, size_t in_frames)
+{
+   size_t i;
+   double ys = 0.0, yc = 0.0;
+   for (i = WARMUP_FRAMES; i < frames; i += stride)
+   {
+      double p = sweep_phase(out_time[i] - delay, f0, f1, in_rate, in_frames);
+      ys += output[i << 1] * sin(p);
+      yc += output[i << 1] * cos(p);
+   }
+   return ys * ys + yc * yc;
+}
+
+// A constant delay of d input frames turns into a phase error of
+// 2 * pi * f(t) * d / in_rate on an exponential sweep, which grows with frequency.
+// Find the group delay of the resampler by maximizing the correlation with the input,
+// first in whole frames, then in DELAY_STEPS fractions around the best one.
+static double estimate_delay(const float *output, const double *out_time, size_t frames,
+      double f0, double f1, double in_rate, size_t in_frames)
+{
+   int d;
+   double best = 0.0, best_corr = -1.0;
+
+   for (d = 0; d <= MAX_DELAY; d++)
+   {
+      double corr = sweep_correlation(output, out_time, frames, DELAY_STRIDE,
+            d, f0, f1, in_rate, in_frames);
+      if (corr > best_corr)
+      {
+         best_corr = corr;
+         best = d;
+      }
+   }
+
+   double coarse = best;
+   best_corr = -1.0;
+   for (d = -DELAY_STEPS; d <= DELAY_STEPS; d++)
+   {
+      double delay = coarse + (double)d / DELAY_STEPS;
+      double corr = sweep_correlation(output, out_time, frames, 1,
+            delay, f0, f1, in_rate, in_frames);
+      if (corr > best_corr)
+      {
+         best_corr = corr;
+         best = delay;
+      }
+   }
+
+   return best;
+}
+
+// Fits the sweep locally in short windows and reports the worst window.
+// out_time is shifted back by the resampler delay first.
+static double measure_sweep(const float *output, const double *out_time, size_t frames,
+      double delay, double f0, double f1, double in_rate, size_t in_frames)
+{
+   size_t i, w;
+   double worst = 1e30;
+
+   for (w = WARMUP_FRAMES; w + SWEEP_WINDOW <= frames; w += SWEEP_WINDOW)
+   {
+      double ss = 0.0, cc = 0.0, sc = 0.0, ys = 0.0, yc = 0.0;
+      for (i = w; i < w + SWEEP_WINDOW; i++)
+      {
+         double p = sweep_phase(out_time[i] - delay, f0, f1, in_rate, in_frames);
+         double s = sin(p), c = cos(p), y = output[i << 1];
+         ss += s * s; cc += c * c; sc += s * c;
+         ys += y * s; yc += y * c;
+      }
+
+      double det = ss * cc - sc * sc;
+      double a = (ys * cc - yc * sc) / det;
+      double b = (yc * ss - ys * sc) / det;
+
+      double sig_pow = 0.0, noise_pow = 0.0;
+      for (i = w; i < w + SWEEP_WINDOW; i++)
+      {
+         double p = sweep_phase(out_time[i] - delay, f0, f1, in_rate, in_frames);
+         double fit = a * sin(p) + b * cos(p);
+         double noise = output[i << 1] - fit;
+         sig_pow += fit * fit;
+         noise_pow += noise * noise;
+      }
+
+      double snr = 10.0 * log10(sig_pow / (noise_pow + 1e-30));
+      if (snr < worst)
+         worst = snr;
+   }
+
+   return worst;
+}
+
+static void gen_tone(float *buf, size_t frames, double omega)
+{
+   size_t i;
+   for (i = 0; i < frames; i++)
+      buf[(i << 1) + 0] = buf[(i << 1) + 1] = 0.5f * sin(omega * i);
+}
+
+static void gen_sweep(float *buf, size_t frames, double f0, double f1, double in_rate)
+{
+   size_t i;
+   for (i = 0; i < frames; i++)
+      buf[(i << 1) + 0] = buf[(i << 1) + 1] = 0.5f * sin(sweep_phase(i, f0, f1, in_rate, frames));
+}
+
+static void format_thd(char *buf, size_t size, double thd)
+{
+   if (isnan(thd))
+      snprintf(buf, size, "n/a");
+   else
+      snprintf(buf, size, "%.1f", thd);
+}
+
+int main(void)
+{
+   unsigned b, c;
+   size_t max_frames = 48000 * TEST_SECONDS;
+   size_t max_out    = max_frames * 2 + CHUNK_FRAMES * 4;
+
+   float *input     = (float*)malloc(max_frames * 2 * sizeof(float));
+   float *output    = (float*)malloc(max_out * 2 * sizeof(float));
+   double *out_time = (double*)malloc(max_out * sizeof(double));
+   if (!input || !output || !out_time)
+      return 1;
+
+   printf("Resampler benchmark. %d s per test, %d frame chunks, sinc quality: %s.\n",
+         TEST_SECONDS, CHUNK_FRAMES, SINC_QUALITY);
+   printf("Throughput is input frames per second. SNR/THD in dB, measured on 1 kHz and 10 kHz tones.\n");
+   printf("Sweep is the worst %d frame window SNR of a 20 Hz - 0.45 * min(in, out) exponential sweep,\n",
+         SWEEP_WINDOW);
+   printf("after compensating for the resampler delay (in input frames) found by correlating with the input.\n\n");
+
+   printf("| Resampler | Conversion | Mframes/s | x realtime | SNR 1k | THD 1k | SNR 10k | THD 10k | Delay | Sweep |\n");
+   printf("|-----------|------------|-----------|------------|--------|--------|---------|---------|-------|-------|\n");
+
+   for (b = 0; backends[b]; b++)
+   {
+      for (c = 0; c < sizeof(conversions) / sizeof(conversions[0]); c++)
+      {
+         const struct conversion *conv = &conversions[c];
+         size_t frames = (size_t)(conv->in_rate * TEST_SECONDS);
+         double elapsed = 0.0, snr_lo, thd_lo, snr_hi, thd_hi;
+
+         double omega_lo = 2.0 * M_PI * 1000.0 / conv->in_rate;
+         double omega_hi = 2.0 * M_PI * 10000.0 / conv->in_rate;
+         double f1 = 0.45 * (conv->in_rate < conv->out_rate ? conv->in_rate : conv->out_rate);
+
+         gen_tone(input, frames, omega_lo);
+         size_t out_frames = run_resampler(backends[b], conv, input, frames, output, out_time, NULL);
+         measure_tone(output, out_time, out_frames, omega_lo, conv->out_rate, conv->in_rate, &snr_lo, &thd_lo);
+
+         gen_tone(input, frames, omega_hi);
+         out_frames = run_resampler(backends[b], conv, input, frames, output, out_time, NULL);
+         measure_tone(output, out_time, out_frames, omega_hi, conv->out_rate, conv->in_rate, &snr_hi, &thd_hi);
+
+         gen_sweep(input, frames, 20.0, f1, conv->in_rate);
+         out_frames = run_resampler(backends[b], conv, input, frames, output, out_time, NULL);
+         double delay = estimate_delay(output, out_time, out_frames, 20.0, f1, conv->in_rate, frames);
+         double sweep = measure_sweep(output, out_time, out_frames, delay, 20.0, f1, conv->in_rate, frames);
+
+         // Timed run without bookkeeping.
+         run_resampler(backends[b], conv, input, frames, output, NULL, &elapsed);
+         double fps = frames / elapsed;
+
+         char desc[64];
+         snprintf(desc, sizeof(desc), "%.0f -> %.0f%s", conv->in_rate, conv->out_rate,
+               conv->wobble ? " ±0.5%" : "");
+
+         char thd_lo_str[16], thd_hi_str[16];
+         format_thd(thd_lo_str, sizeof(thd_lo_str), thd_lo);
+         format_thd(thd_hi_str, sizeof(thd_hi_str), thd_hi);
+
+         printf("| %s | %s | %.2f | %.0f | %.1f | %s | %.1f | %s | %.2f | %.1f |\n",
+               backends[b]->ident, desc, fps / 1000000.0, fps / conv->in_rate,
+               snr_lo, thd_lo_str, snr_hi, thd_hi_str, delay, sweep);
+      }
+   }
+
+   free(input);
+   free(output);
+   free(out_time);
+   return 0;
+}
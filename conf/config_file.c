@@ -23,6 +23,8 @@
 #include "../compat/strl.h"
 #include "../file.h"
 #include <sys/param.h> // PATH_MAX
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #ifndef PATH_MAX
 #ifdef PATH_MAX
@@ -37,11 +39,34 @@
 struct config_entry_list
 {
    bool readonly; // If we got this from an #include, do not allow write.
-   char *key;
+   bool owned; // value was allocated by a setter. Otherwise it points into a file buffer.
+   bool pooled; // Part of config_file::pool rather than allocated on its own.
+   char *key; // Interned, owned by the key index of the config.
    char *value;
    struct config_entry_list *next;
 };
 
+// Open addressing hash index over the keys. Each distinct key is stored once here
+// and shared by every entry using it. The entry list itself keeps file order for writing.
+struct config_key
+{
+   uint32_t hash;
+   bool owned; // key was copied. Otherwise it points into a file buffer.
+   char *key; // NULL if the slot is free.
+   struct config_entry_list *first; // First entry with this key. What getters see.
+   struct config_entry_list *writable; // First entry not from an #include. What setters modify.
+};
+
+#define CONFIG_INDEX_MIN_SIZE 64
+
+// Whole files are read into these and tokenized in place.
+// Parsed keys and values are slices into them, so they live as long as the config.
+struct config_buffer
+{
+   char *data;
+   struct config_buffer *next;
+};
+
 struct include_list
 {
    char *path;
@@ -56,32 +81,156 @@ struct config_file
    unsigned include_depth;
 
    struct include_list *includes;
+   struct include_list *sources; // Resolved paths of all #includes, nested ones too. Used by config_cache.
+   struct config_buffer *buffers;
+   struct config_entry_list *pool; // Entries restored from config_cache, allocated in one go.
+
+   struct config_key *index;
+   size_t index_size; // Power of two.
+   size_t index_count;
+
+   bool modified; // A setter changed or added a value since loading.
 };
 
-static config_file_t *config_file_new_internal(const char *path, unsigned depth);
+static uint32_t config_hash(const char *key)
+{
+   // FNV-1a
+   uint32_t hash = 2166136261u;
+   while (*key)
+   {
+      hash ^= (uint8_t)*key++;
+      hash *= 16777619u;
+   }
+   return hash;
+}
+
+// Returns the slot holding key, or the free slot where it would be inserted.
+static struct config_key *config_index_slot(struct config_key *index, size_t size,
+      const char *key, uint32_t hash)
+{
+   size_t mask = size - 1;
+   size_t i = hash & mask;
+
+   while (index[i].key && (index[i].hash != hash || strcmp(index[i].key, key) != 0))
+      i = (i + 1) & mask;
+
+   return &index[i];
+}
 
-static char *getaline(FILE *file)
+static struct config_key *config_index_find(config_file_t *conf, const char *key)
 {
-   char *newline = (char*)malloc(9);
-   size_t cur_size = 8;
-   size_t index = 0;
+   if (!conf->index)
+      return NULL;
+
+   struct config_key *slot = config_index_slot(conf->index, conf->index_size, key, config_hash(key));
+   return slot->key ? slot : NULL;
+}
 
-   int in = getc(file);
-   while (in != EOF && in != '\n')
+static bool config_index_resize(config_file_t *conf, size_t new_size)
+{
+   size_t i;
+   struct config_key *index = (struct config_key*)calloc(new_size, sizeof(*index));
+   if (!index)
+      return false;
+
+   for (i = 0; i < conf->index_size; i++)
    {
-      if (index == cur_size)
-      {
-         cur_size *= 2;
-         newline = (char*)realloc(newline, cur_size + 1);
-      }
+      if (conf->index[i].key)
+         *config_index_slot(index, new_size, conf->index[i].key, conf->index[i].hash) = conf->index[i];
+   }
 
-      newline[index++] = in;
-      in = getc(file);
+   free(conf->index);
+   conf->index = index;
+   conf->index_size = new_size;
+   return true;
+}
+
+static bool config_index_grow(config_file_t *conf)
+{
+   return config_index_resize(conf, conf->index_size ? conf->index_size * 2 : CONFIG_INDEX_MIN_SIZE);
+}
+
+// Sizes the index for count keys up front, so it isn't rehashed while filling it.
+static bool config_index_reserve(config_file_t *conf, size_t count)
+{
+   size_t size = conf->index_size ? conf->index_size : CONFIG_INDEX_MIN_SIZE;
+   while (count * 4 > size * 3)
+      size *= 2;
+   return size == conf->index_size || config_index_resize(conf, size);
+}
+
+// Indexes a new entry under key. entry->key is pointed at the interned key.
+// If copy is false, key must live as long as conf, i.e. point into one of its buffers.
+static bool config_index_add(config_file_t *conf, struct config_entry_list *entry,
+      char *key, bool copy)
+{
+   // Keep load below 3/4.
+   if ((conf->index_count + 1) * 4 > conf->index_size * 3 && !config_index_grow(conf))
+      return false;
+
+   uint32_t hash = config_hash(key);
+   struct config_key *slot = config_index_slot(conf->index, conf->index_size, key, hash);
+   if (!slot->key)
+   {
+      slot->key = copy ? strdup(key) : key;
+      if (!slot->key)
+         return false;
+      slot->owned = copy;
+      slot->hash = hash;
+      conf->index_count++;
    }
-   newline[index] = '\0';
-   return newline; 
+
+   entry->key = slot->key;
+   if (!slot->first)
+      slot->first = entry;
+   if (!entry->readonly && !slot->writable)
+      slot->writable = entry;
+   return true;
 }
 
+static void config_index_free(config_file_t *conf)
+{
+   size_t i;
+   for (i = 0; i < conf->index_size; i++)
+   {
+      if (conf->index[i].owned)
+         free(conf->index[i].key);
+   }
+   free(conf->index);
+   conf->index = NULL;
+   conf->index_size = 0;
+   conf->index_count = 0;
+}
+
+static struct config_entry_list *config_get_entry(config_file_t *conf, const char *key)
+{
+   struct config_key *slot = config_index_find(conf, key);
+   return slot ? slot->first : NULL;
+}
+
+static void config_append_entry(config_file_t *conf, struct config_entry_list *entry)
+{
+   if (conf->tail)
+      conf->tail->next = entry;
+   else
+      conf->entries = entry;
+   conf->tail = entry;
+}
+
+static bool config_add_buffer(config_file_t *conf, char *data)
+{
+   struct config_buffer *buffer = (struct config_buffer*)calloc(1, sizeof(*buffer));
+   if (!buffer)
+      return false;
+
+   buffer->data = data;
+   buffer->next = conf->buffers;
+   conf->buffers = buffer;
+   return true;
+}
+
+static config_file_t *config_file_new_internal(const char *path, unsigned depth);
+
 static char *extract_value(char *line, bool is_value)
 {
    if (is_value)
@@ -107,67 +256,68 @@ static char *extract_value(char *line, bool is_value)
    {
       line++;
       tok = strtok_r(line, "\"", &save);
-      if (!tok)
-         return NULL;
-      return strdup(tok);
+      return tok;
    }
    else if (*line == '\0') // Nothing :(
       return NULL;
    else // We don't have that... Read till next space.
    {
       tok = strtok_r(line, " \n\t\f\r\v", &save);
-      if (tok)
-         return strdup(tok);
-      else
-         return NULL;
-   }
-}
-
-static void set_list_readonly(struct config_entry_list *list)
-{
-   while (list)
-   {
-      list->readonly = true;
-      list = list->next;
+      return tok;
    }
 }
 
 // Move semantics? :)
 static void add_child_list(config_file_t *parent, config_file_t *child)
 {
-   if (parent->entries)
-   {
-      struct config_entry_list *head = parent->entries;
-      while (head->next)
-         head = head->next;
-
-      set_list_readonly(child->entries);
-      head->next = child->entries;
-   }
-   else
+   // Buffers move over to the parent, so slices into them stay valid.
+   struct config_buffer *buffer = child->buffers;
+   while (buffer)
    {
-      set_list_readonly(child->entries);
-      parent->entries = child->entries;
+      struct config_buffer *next = buffer->next;
+      buffer->next = parent->buffers;
+      parent->buffers = buffer;
+      buffer = next;
    }
+   child->buffers = NULL;
 
-   child->entries = NULL;
+   struct include_list **sources = &parent->sources;
+   while (*sources)
+      sources = &(*sources)->next;
+   *sources = child->sources;
+   child->sources = NULL;
 
-   // Rebase tail.
-   if (parent->entries)
+   struct config_entry_list *list = child->entries;
+   while (list)
    {
-      struct config_entry_list *head = parent->entries;
-      while (head->next)
-         head = head->next;
-      parent->tail = head;
+      struct config_entry_list *next = list->next;
+
+      // Keys move over to the index of the parent, the child index is freed with the child.
+      struct config_key *slot = config_index_find(child, list->key);
+      list->readonly = true;
+      list->next = NULL;
+      if (config_index_add(parent, list, list->key, !slot || slot->owned))
+         config_append_entry(parent, list);
+      else
+      {
+         if (list->owned)
+            free(list->value);
+         free(list);
+      }
+
+      list = next;
    }
-   else
-      parent->tail = NULL;
+
+   child->entries = NULL;
+   child->tail = NULL;
 }
 
-static void add_include_list(config_file_t *conf, const char *path)
+static void add_include_list(struct include_list **list, const char *path)
 {
-   struct include_list *head = conf->includes;
+   struct include_list *head = *list;
    struct include_list *node = (struct include_list*)calloc(1, sizeof(*node));
+   if (!node)
+      return;
    node->path = strdup(path);
 
    if (head)
@@ -178,7 +328,18 @@ static void add_include_list(config_file_t *conf, const char *path)
       head->next = node;
    }
    else
-      conf->includes = node;
+      *list = node;
+}
+
+static void free_include_list(struct include_list *list)
+{
+   while (list)
+   {
+      free(list->path);
+      struct include_list *hold = list;
+      list = list->next;
+      free(hold);
+   }
 }
 
 static void add_sub_conf(config_file_t *conf, char *line)
@@ -187,7 +348,7 @@ static void add_sub_conf(config_file_t *conf, char *line)
    if (!path)
       return;
 
-   add_include_list(conf, path);
+   add_include_list(&conf->includes, path);
    char real_path[PATH_MAX];
 
    if (*path == '~')
@@ -199,17 +360,16 @@ static void add_sub_conf(config_file_t *conf, char *line)
    else
       fill_pathname_resolve_relative(real_path, conf->path, path, sizeof(real_path));
 
+   // Recorded even if missing, so a cached config is invalidated once it shows up.
+   add_include_list(&conf->sources, real_path);
+
    config_file_t *sub_conf = config_file_new_internal(real_path, conf->include_depth + 1);
    if (!sub_conf)
-   {
-      free(path);
       return;
-   }
 
    // Pilfer internal list. :D
    add_child_list(conf, sub_conf);
    config_file_free(sub_conf);
-   free(path);
 }
 
 static char *strip_comment(char *str)
@@ -273,34 +433,53 @@ static bool parse_line(config_file_t *conf, struct config_entry_list *list, char
    while (isspace(*line))
       line++;
 
-   char *key = (char*)malloc(9);
-   size_t cur_size = 8;
-   size_t index = 0;
-
+   char *key = line;
    while (isgraph(*line))
-   {
-      if (index == cur_size)
-      {
-         cur_size *= 2;
-         key = (char*)realloc(key, cur_size + 1);
-      }
-
-      key[index++] = *line++;
-   }
-   key[index] = '\0';
-   list->key = key;
+      line++;
+   char *key_end = line;
 
    list->value = extract_value(line, true);
    if (!list->value)
+      return false;
+
+   // Only terminate the key now, the value parser needs to see a '=' right after it.
+   *key_end = '\0';
+   if (!config_index_add(conf, list, key, false))
    {
-      list->key = NULL;
-      free(key);
+      list->value = NULL;
       return false;
    }
 
    return true;
 }
 
+// Tokenizes buf in place. buf must already be owned by conf.
+static void parse_buffer(config_file_t *conf, char *buf)
+{
+   struct config_entry_list *list = NULL;
+
+   while (buf)
+   {
+      char *line = buf;
+      buf = strchr(buf, '\n');
+      if (buf)
+         *buf++ = '\0';
+
+      if (!list)
+         list = (struct config_entry_list*)calloc(1, sizeof(*list));
+      if (!list)
+         break;
+
+      if (parse_line(conf, list, line))
+      {
+         config_append_entry(conf, list);
+         list = NULL;
+      }
+   }
+
+   free(list);
+}
+
 static config_file_t *config_file_new_internal(const char *path, unsigned depth)
 {
    struct config_file *conf = (struct config_file*)calloc(1, sizeof(*conf));
@@ -318,46 +497,22 @@ static config_file_t *config_file_new_internal(const char *path, unsigned depth)
    }
 
    conf->include_depth = depth;
-   FILE *file = fopen(path, "r");
 
-   if (!file)
+   char *buf = NULL;
+   if (read_file(path, (void**)&buf) < 0 || !config_add_buffer(conf, buf))
    {
+      free(buf);
       free(conf->path);
       free(conf);
       return NULL;
    }
 
-   while (!feof(file))
-   {
-      struct config_entry_list *list = (struct config_entry_list*)calloc(1, sizeof(*list));
-      char *line = getaline(file);
-
-      if (line)
-      {
-         if (parse_line(conf, list, line))
-         {
-            if (conf->entries)
-               conf->tail->next = list;
-            else
-               conf->entries = list;
-               
-            conf->tail = list;
-         }
-
-         free(line);
-      }
-
-      if (list != conf->tail)
-         free(list);
-   }
-   fclose(file);
-
+   parse_buffer(conf, buf);
    return conf;
 }
 
 config_file_t *config_file_new_from_string(const char *from_string)
 {
-   size_t i;
    struct config_file *conf = (struct config_file*)calloc(1, sizeof(*conf));
    if (!conf)
       return NULL;
@@ -367,40 +522,15 @@ config_file_t *config_file_new_from_string(const char *from_string)
 
    conf->path = NULL;
    conf->include_depth = 0;
-   
-   struct string_list *lines = string_split(from_string, "\n");
-   if (!lines)
-      return conf;
 
-   for (i = 0; i < lines->size; i++)
+   char *buf = strdup(from_string);
+   if (!buf || !config_add_buffer(conf, buf))
    {
-      struct config_entry_list *list = (struct config_entry_list*)calloc(1, sizeof(*list));
-      
-      char* line = lines->elems[i].data;
-    
-      if (line)
-      {
-         if (parse_line(conf, list, line))
-         {
-            if (conf->entries)
-            {
-               conf->tail->next = list;
-               conf->tail = list;
-            }
-            else
-            {
-               conf->entries = list;
-               conf->tail = list;
-            }
-         }
-      }
-
-      if (list != conf->tail)
-         free(list);
+      free(buf);
+      return conf;
    }
-   
-   string_list_free(lines);
 
+   parse_buffer(conf, buf);
    return conf;
 }
 
@@ -417,197 +547,142 @@ void config_file_free(config_file_t *conf)
    struct config_entry_list *tmp = conf->entries;
    while (tmp)
    {
-      free(tmp->key);
-      free(tmp->value);
+      if (tmp->owned)
+         free(tmp->value);
       struct config_entry_list *hold = tmp;
       tmp = tmp->next;
-      free(hold);
+      if (!hold->pooled)
+         free(hold);
    }
+   free(conf->pool);
+
+   free_include_list(conf->includes);
+   free_include_list(conf->sources);
 
-   struct include_list *inc_tmp = conf->includes;
-   while (inc_tmp)
+   struct config_buffer *buffer = conf->buffers;
+   while (buffer)
    {
-      free(inc_tmp->path);
-      struct include_list *hold = inc_tmp;
-      inc_tmp = inc_tmp->next;
+      free(buffer->data);
+      struct config_buffer *hold = buffer;
+      buffer = buffer->next;
       free(hold);
    }
 
+   config_index_free(conf);
    free(conf->path);
    free(conf);
 }
 
 bool config_get_double(config_file_t *conf, const char *key, double *in)
 {
-   struct config_entry_list *list = conf->entries;
+   struct config_entry_list *list = config_get_entry(conf, key);
+   if (!list)
+      return false;
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         *in = strtod(list->value, NULL);
-         return true;
-      }
-      list = list->next;
-   }
-   return false;
+   *in = strtod(list->value, NULL);
+   return true;
 }
 
 bool config_get_float(config_file_t *conf, const char *key, float *in)
 {
-   struct config_entry_list *list = conf->entries;
+   struct config_entry_list *list = config_get_entry(conf, key);
+   if (!list)
+      return false;
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         // strtof() is C99/POSIX. Just use the more portable kind.
-         *in = (float)strtod(list->value, NULL);
-         return true;
-      }
-      list = list->next;
-   }
-   return false;
+   // strtof() is C99/POSIX. Just use the more portable kind.
+   *in = (float)strtod(list->value, NULL);
+   return true;
 }
 
 bool config_get_int(config_file_t *conf, const char *key, int *in)
 {
-   struct config_entry_list *list = conf->entries;
+   struct config_entry_list *list = config_get_entry(conf, key);
+   if (!list)
+      return false;
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         errno = 0;
-         int val = strtol(list->value, NULL, 0);
-         if (errno == 0)
-         {
-            *in = val;
-            return true;
-         }
-         else
-            return false;
-      }
-      list = list->next;
-   }
-   return false;
+   errno = 0;
+   int val = strtol(list->value, NULL, 0);
+   if (errno != 0)
+      return false;
+
+   *in = val;
+   return true;
 }
 
 bool config_get_uint64(config_file_t *conf, const char *key, uint64_t *in)
 {
-   struct config_entry_list *list = conf->entries;
+   struct config_entry_list *list = config_get_entry(conf, key);
+   if (!list)
+      return false;
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         errno = 0;
-         uint64_t val = strtoull(list->value, NULL, 0);
-         if (errno == 0)
-         {
-            *in = val;
-            return true;
-         }
-         else
-            return false;
-      }
-      list = list->next;
-   }
-   return false;
+   errno = 0;
+   uint64_t val = strtoull(list->value, NULL, 0);
+   if (errno != 0)
+      return false;
+
+   *in = val;
+   return true;
 }
 
 bool config_get_uint(config_file_t *conf, const char *key, unsigned *in)
 {
-   struct config_entry_list *list = conf->entries;
+   struct config_entry_list *list = config_get_entry(conf, key);
+   if (!list)
+      return false;
 
-   while (list != NULL)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         errno = 0;
-         unsigned val = strtoul(list->value, NULL, 0);
-         if (errno == 0)
-         {
-            *in = val;
-            return true;
-         }
-         else
-            return false;
-      }
-      list = list->next;
-   }
+   errno = 0;
+   unsigned val = strtoul(list->value, NULL, 0);
+   if (errno != 0)
+      return false;
 
-   return false;
+   *in = val;
+   return true;
 }
 
 bool config_get_hex(config_file_t *conf, const char *key, unsigned *in)
 {
-   struct config_entry_list *list = conf->entries;
+   struct config_entry_list *list = config_get_entry(conf, key);
+   if (!list)
+      return false;
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         errno = 0;
-         unsigned val = strtoul(list->value, NULL, 16);
-         if (errno == 0)
-         {
-            *in = val;
-            return true;
-         }
-         else
-            return false;
-      }
-      list = list->next;
-   }
-   return false;
+   errno = 0;
+   unsigned val = strtoul(list->value, NULL, 16);
+   if (errno != 0)
+      return false;
+
+   *in = val;
+   return true;
 }
 
 bool config_get_char(config_file_t *conf, const char *key, char *in)
 {
-   struct config_entry_list *list = conf->entries;
+   struct config_entry_list *list = config_get_entry(conf, key);
+   if (!list)
+      return false;
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         if (list->value[0] && list->value[1])
-            return false;
-         *in = *list->value;
-         return true;
-      }
-      list = list->next;
-   }
-   return false;
+   if (list->value[0] && list->value[1])
+      return false;
+   *in = *list->value;
+   return true;
 }
 
 bool config_get_string(config_file_t *conf, const char *key, char **str)
 {
-   struct config_entry_list *list = conf->entries;
+   struct config_entry_list *list = config_get_entry(conf, key);
+   if (!list)
+      return false;
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         *str = strdup(list->value);
-         return true;
-      }
-      list = list->next;
-   }
-   return false;
+   *str = strdup(list->value);
+   return true;
 }
 
 bool config_get_array(config_file_t *conf, const char *key, char *buf, size_t size)
 {
-   struct config_entry_list *list = conf->entries;
+   struct config_entry_list *list = config_get_entry(conf, key);
+   if (!list)
+      return false;
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-         return strlcpy(buf, list->value, size) < size;
-      list = list->next;
-   }
-   return false;
+   return strlcpy(buf, list->value, size) < size;
 }
 
 bool config_get_path(config_file_t *conf, const char *key, char *buf, size_t size)
@@ -617,55 +692,60 @@ bool config_get_path(config_file_t *conf, const char *key, char *buf, size_t siz
 
 bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 {
-   struct config_entry_list *list = conf->entries;
+   struct config_entry_list *list = config_get_entry(conf, key);
+   if (!list)
+      return false;
 
-   while (list)
-   {
-      if (strcmp(key, list->key) == 0)
-      {
-         if (strcasecmp(list->value, "true") == 0)
-            *in = true;
-         else if (strcasecmp(list->value, "1") == 0)
-            *in = true;
-         else if (strcasecmp(list->value, "false") == 0)
-            *in = false;
-         else if (strcasecmp(list->value, "0") == 0)
-            *in = false;
-         else
-            return false;
-
-         return true;
-      }
-      list = list->next;
-   }
-   return false;
+   if (strcasecmp(list->value, "true") == 0)
+      *in = true;
+   else if (strcasecmp(list->value, "1") == 0)
+      *in = true;
+   else if (strcasecmp(list->value, "false") == 0)
+      *in = false;
+   else if (strcasecmp(list->value, "0") == 0)
+      *in = false;
+   else
+      return false;
+
+   return true;
 }
 
 void config_set_string(config_file_t *conf, const char *key, const char *val)
 {
-   struct config_entry_list *list = conf->entries;
-   struct config_entry_list *last = list;
-   while (list)
+   struct config_key *slot = config_index_find(conf, key);
+   if (slot && slot->writable)
    {
-      if (!list->readonly && (strcmp(key, list->key) == 0))
-      {
-         free(list->value);
-         list->value = strdup(val);
+      if (strcmp(slot->writable->value, val) == 0)
          return;
-      }
 
-      last = list;
-      list = list->next;
+      // Only copy values once they are modified.
+      char *value = strdup(val);
+      if (!value)
+         return;
+
+      if (slot->writable->owned)
+         free(slot->writable->value);
+      slot->writable->value = value;
+      slot->writable->owned = true;
+      conf->modified = true;
+      return;
    }
 
    struct config_entry_list *elem = (struct config_entry_list*)calloc(1, sizeof(*elem));
-   elem->key = strdup(key);
+   if (!elem)
+      return;
+
    elem->value = strdup(val);
+   elem->owned = true;
+   if (!elem->value || !config_index_add(conf, elem, (char*)key, true))
+   {
+      free(elem->value);
+      free(elem);
+      return;
+   }
 
-   if (last)
-      last->next = elem;
-   else
-      conf->entries = elem;
+   config_append_entry(conf, elem);
+   conf->modified = true;
 }
 
 void config_set_path(config_file_t *conf, const char *entry, const char *val)
@@ -724,6 +804,11 @@ void config_set_bool(config_file_t *conf, const char *key, bool val)
    config_set_string(conf, key, val ? "true" : "false");
 }
 
+bool config_file_is_modified(const config_file_t *conf)
+{
+   return conf->modified;
+}
+
 bool config_file_write(config_file_t *conf, const char *path)
 {
    FILE *file;
@@ -782,16 +867,7 @@ void config_file_dump_all(config_file_t *conf, FILE *file)
 
 bool config_entry_exists(config_file_t *conf, const char *entry)
 {
-   struct config_entry_list *list = conf->entries;
-
-   while (list)
-   {
-      if (strcmp(entry, list->key) == 0)
-         return true;
-      list = list->next;
-   }
-
-   return false;
+   return config_get_entry(conf, entry) != NULL;
 }
 
 bool config_get_entry_list_head(config_file_t *conf, struct config_file_entry *entry)
@@ -818,3 +894,486 @@ bool config_get_entry_list_next(struct config_file_entry *entry)
    return true;
 }
 
+
+// Cache file layout, native endian:
+// config_cache_header, then num_records records back to back.
+// Each record is config_cache_record, sources, includes, entries and a string table.
+// String offsets are relative to the string table. The config path is at offset 0.
+#define CONFIG_CACHE_MAGIC 0x43434152 // "RACC"
+#define CONFIG_CACHE_VERSION 1
+
+struct config_cache_header
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t num_records;
+   uint32_t pad;
+};
+
+struct config_cache_record
+{
+   uint32_t size; // In bytes, including this header. Multiple of 8.
+   uint32_t hash;
+   uint32_t num_sources; // The config itself, then everything it #included.
+   uint32_t num_includes;
+   uint32_t num_entries;
+   uint32_t strings_size;
+};
+
+struct config_cache_source
+{
+   uint64_t size;
+   int64_t mtime;
+   uint32_t path;
+   uint32_t exists;
+};
+
+struct config_cache_entry
+{
+   uint32_t key;
+   uint32_t value;
+   uint32_t readonly;
+};
+
+struct config_cache_slot
+{
+   struct config_cache_record *record;
+   bool owned; // Allocated on a miss. Otherwise it points into the cache file data.
+};
+
+struct config_cache
+{
+   char *path;
+   uint8_t *data;
+
+   struct config_cache_slot *slots;
+   size_t count;
+   size_t capacity;
+
+   bool dirty;
+   unsigned hits;
+   unsigned misses;
+};
+
+static const struct config_cache_source *config_cache_sources(const struct config_cache_record *record)
+{
+   return (const struct config_cache_source*)(record + 1);
+}
+
+static const uint32_t *config_cache_includes(const struct config_cache_record *record)
+{
+   return (const uint32_t*)(config_cache_sources(record) + record->num_sources);
+}
+
+static const struct config_cache_entry *config_cache_entries(const struct config_cache_record *record)
+{
+   return (const struct config_cache_entry*)(config_cache_includes(record) + record->num_includes);
+}
+
+static const char *config_cache_strings(const struct config_cache_record *record)
+{
+   return (const char*)(config_cache_entries(record) + record->num_entries);
+}
+
+static bool config_cache_stat(const char *path, uint64_t *size, int64_t *mtime)
+{
+   struct stat buf;
+   if (stat(path, &buf) < 0)
+      return false;
+
+   *size = buf.st_size;
+   *mtime = buf.st_mtime;
+   return true;
+}
+
+// Checks that a record read from disk is self-consistent. size is what is left of the file.
+static bool config_cache_record_check(const struct config_cache_record *record, size_t size)
+{
+   size_t i;
+   if (size < sizeof(*record) || record->size < sizeof(*record) || record->size > size || (record->size & 7))
+      return false;
+
+   // Bound the counts before computing the layout so it can't overflow.
+   if (record->num_sources < 1 || record->num_sources > record->size ||
+         record->num_includes > record->size || record->num_entries > record->size ||
+         record->strings_size < 1 || record->strings_size > record->size)
+      return false;
+
+   size_t layout = sizeof(*record) +
+      record->num_sources * sizeof(struct config_cache_source) +
+      record->num_includes * sizeof(uint32_t) +
+      record->num_entries * sizeof(struct config_cache_entry) +
+      record->strings_size;
+   if (layout > record->size)
+      return false;
+
+   const char *strings = config_cache_strings(record);
+   if (strings[record->strings_size - 1] != '\0')
+      return false;
+
+   const struct config_cache_source *sources = config_cache_sources(record);
+   for (i = 0; i < record->num_sources; i++)
+      if (sources[i].path >= record->strings_size)
+         return false;
+
+   const uint32_t *includes = config_cache_includes(record);
+   for (i = 0; i < record->num_includes; i++)
+      if (includes[i] >= record->strings_size)
+         return false;
+
+   const struct config_cache_entry *entries = config_cache_entries(record);
+   for (i = 0; i < record->num_entries; i++)
+      if (entries[i].key >= record->strings_size || entries[i].value >= record->strings_size)
+         return false;
+
+   return true;
+}
+
+// Checks the record against the file system.
+static bool config_cache_record_valid(const struct config_cache_record *record)
+{
+   size_t i;
+   const struct config_cache_source *sources = config_cache_sources(record);
+   const char *strings = config_cache_strings(record);
+
+   for (i = 0; i < record->num_sources; i++)
+   {
+      uint64_t size = 0;
+      int64_t mtime = 0;
+      bool exists = config_cache_stat(strings + sources[i].path, &size, &mtime);
+
+      if (exists != !!sources[i].exists)
+         return false;
+      if (exists && (size != sources[i].size || mtime != sources[i].mtime))
+         return false;
+   }
+
+   return true;
+}
+
+// One copy of the string table, then pointer fix-ups.
+static config_file_t *config_cache_record_load(const struct config_cache_record *record)
+{
+   size_t i;
+   const char *strings = config_cache_strings(record);
+   const uint32_t *includes = config_cache_includes(record);
+   const struct config_cache_entry *entries = config_cache_entries(record);
+
+   struct config_file *conf = (struct config_file*)calloc(1, sizeof(*conf));
+   if (!conf)
+      return NULL;
+
+   conf->path = strdup(strings);
+   char *buf = (char*)malloc(record->strings_size);
+   if (!conf->path || !buf || !config_add_buffer(conf, buf))
+   {
+      free(buf);
+      goto error;
+   }
+   memcpy(buf, strings, record->strings_size);
+
+   // Sources are not needed here. Hits are never serialized again.
+   for (i = 0; i < record->num_includes; i++)
+      add_include_list(&conf->includes, buf + includes[i]);
+
+   if (!record->num_entries)
+      return conf;
+
+   conf->pool = (struct config_entry_list*)calloc(record->num_entries, sizeof(*conf->pool));
+   if (!conf->pool || !config_index_reserve(conf, record->num_entries))
+      goto error;
+
+   for (i = 0; i < record->num_entries; i++)
+   {
+      struct config_entry_list *list = &conf->pool[i];
+      list->pooled = true;
+      list->readonly = entries[i].readonly;
+      list->value = buf + entries[i].value;
+      if (!config_index_add(conf, list, buf + entries[i].key, false))
+         goto error;
+
+      config_append_entry(conf, list);
+   }
+
+   return conf;
+
+error:
+   config_file_free(conf);
+   return NULL;
+}
+
+static uint32_t config_cache_add_string(char *strings, size_t *offset, const char *str)
+{
+   uint32_t ret = *offset;
+   size_t len = strlen(str) + 1;
+   memcpy(strings + *offset, str, len);
+   *offset += len;
+   return ret;
+}
+
+static struct config_cache_record *config_cache_record_new(config_file_t *conf)
+{
+   size_t strings_size = strlen(conf->path) + 1;
+   uint32_t num_sources = 1, num_includes = 0, num_entries = 0;
+   const struct include_list *inc;
+   const struct config_entry_list *list;
+
+   for (inc = conf->sources; inc; inc = inc->next, num_sources++)
+      strings_size += strlen(inc->path) + 1;
+   for (inc = conf->includes; inc; inc = inc->next, num_includes++)
+      strings_size += strlen(inc->path) + 1;
+   for (list = conf->entries; list; list = list->next, num_entries++)
+      strings_size += strlen(list->key) + strlen(list->value) + 2;
+
+   size_t size = sizeof(struct config_cache_record) +
+      num_sources * sizeof(struct config_cache_source) +
+      num_includes * sizeof(uint32_t) +
+      num_entries * sizeof(struct config_cache_entry) +
+      strings_size;
+   size = (size + 7) & ~(size_t)7;
+
+   struct config_cache_record *record = (struct config_cache_record*)calloc(1, size);
+   if (!record)
+      return NULL;
+
+   record->size = size;
+   record->hash = config_hash(conf->path);
+   record->num_sources = num_sources;
+   record->num_includes = num_includes;
+   record->num_entries = num_entries;
+   record->strings_size = strings_size;
+
+   struct config_cache_source *sources = (struct config_cache_source*)config_cache_sources(record);
+   uint32_t *includes = (uint32_t*)config_cache_includes(record);
+   struct config_cache_entry *entries = (struct config_cache_entry*)config_cache_entries(record);
+   char *strings = (char*)config_cache_strings(record);
+   size_t offset = 0;
+
+   sources->path = config_cache_add_string(strings, &offset, conf->path);
+   sources++;
+   for (inc = conf->sources; inc; inc = inc->next, sources++)
+      sources->path = config_cache_add_string(strings, &offset, inc->path);
+   for (inc = conf->includes; inc; inc = inc->next)
+      *includes++ = config_cache_add_string(strings, &offset, inc->path);
+   for (list = conf->entries; list; list = list->next, entries++)
+   {
+      entries->key = config_cache_add_string(strings, &offset, list->key);
+      entries->value = config_cache_add_string(strings, &offset, list->value);
+      entries->readonly = list->readonly;
+   }
+
+   // Stat after parsing. A file changed in between would be parsed again next time anyway,
+   // unless it kept both size and mtime.
+   sources = (struct config_cache_source*)config_cache_sources(record);
+   for (num_sources = 0; num_sources < record->num_sources; num_sources++)
+   {
+      sources[num_sources].exists = config_cache_stat(strings + sources[num_sources].path,
+            &sources[num_sources].size, &sources[num_sources].mtime);
+   }
+
+   return record;
+}
+
+static struct config_cache_slot *config_cache_find(config_cache_t *cache, const char *path)
+{
+   size_t i;
+   uint32_t hash = config_hash(path);
+   for (i = 0; i < cache->count; i++)
+   {
+      const struct config_cache_record *record = cache->slots[i].record;
+      if (record->hash == hash && strcmp(config_cache_strings(record), path) == 0)
+         return &cache->slots[i];
+   }
+
+   return NULL;
+}
+
+static bool config_cache_push(config_cache_t *cache, struct config_cache_record *record, bool owned)
+{
+   if (cache->count == cache->capacity)
+   {
+      size_t capacity = cache->capacity ? cache->capacity * 2 : 32;
+      struct config_cache_slot *slots = (struct config_cache_slot*)realloc(cache->slots,
+            capacity * sizeof(*slots));
+      if (!slots)
+         return false;
+
+      cache->slots = slots;
+      cache->capacity = capacity;
+   }
+
+   cache->slots[cache->count].record = record;
+   cache->slots[cache->count].owned = owned;
+   cache->count++;
+   return true;
+}
+
+config_cache_t *config_cache_new(const char *path)
+{
+   config_cache_t *cache = (config_cache_t*)calloc(1, sizeof(*cache));
+   if (!cache)
+      return NULL;
+
+   cache->path = strdup(path);
+   if (!cache->path)
+   {
+      free(cache);
+      return NULL;
+   }
+
+   void *data = NULL;
+   long size = read_file(path, &data);
+   if (size < 0)
+      return cache;
+
+   cache->data = (uint8_t*)data;
+
+   const struct config_cache_header *header = (const struct config_cache_header*)cache->data;
+   if ((size_t)size < sizeof(*header) || header->magic != CONFIG_CACHE_MAGIC ||
+         header->version != CONFIG_CACHE_VERSION)
+   {
+      RARCH_WARN("Config cache \"%s\" is invalid or from another version, rebuilding.\n", path);
+      cache->dirty = true;
+      return cache;
+   }
+
+   uint32_t i;
+   size_t offset = sizeof(*header);
+   for (i = 0; i < header->num_records; i++)
+   {
+      struct config_cache_record *record = (struct config_cache_record*)(cache->data + offset);
+      if (!config_cache_record_check(record, size - offset) || !config_cache_push(cache, record, false))
+      {
+         RARCH_WARN("Config cache \"%s\" is truncated or corrupt, rebuilding.\n", path);
+         cache->count = 0;
+         cache->dirty = true;
+         break;
+      }
+
+      offset += record->size;
+   }
+
+   return cache;
+}
+
+static void config_cache_remove(config_cache_t *cache, struct config_cache_slot *slot)
+{
+   if (slot->owned)
+      free(slot->record);
+   *slot = cache->slots[--cache->count];
+   cache->dirty = true;
+}
+
+config_file_t *config_cache_lookup(config_cache_t *cache, const char *path)
+{
+   if (!cache || !path)
+      return NULL;
+
+   struct config_cache_slot *slot = config_cache_find(cache, path);
+   if (slot && config_cache_record_valid(slot->record))
+   {
+      config_file_t *conf = config_cache_record_load(slot->record);
+      if (conf)
+      {
+         cache->hits++;
+         return conf;
+      }
+   }
+
+   // Stale records are dropped.
+   cache->misses++;
+   if (slot)
+      config_cache_remove(cache, slot);
+   return NULL;
+}
+
+void config_cache_store(config_cache_t *cache, config_file_t *conf)
+{
+   if (!cache || !conf || !conf->path)
+      return;
+
+   struct config_cache_slot *slot = config_cache_find(cache, conf->path);
+   if (slot)
+      config_cache_remove(cache, slot);
+
+   struct config_cache_record *record = config_cache_record_new(conf);
+   if (record && config_cache_push(cache, record, true))
+      cache->dirty = true;
+   else
+      free(record);
+}
+
+config_file_t *config_cache_load(config_cache_t *cache, const char *path)
+{
+   config_file_t *conf = config_cache_lookup(cache, path);
+   if (conf)
+      return conf;
+
+   // Failed loads are not cached.
+   conf = config_file_new(path);
+   config_cache_store(cache, conf);
+   return conf;
+}
+
+bool config_cache_flush(config_cache_t *cache)
+{
+   size_t i;
+   if (!cache || !cache->dirty)
+      return true;
+
+   FILE *file = fopen(cache->path, "wb");
+   if (!file)
+   {
+      RARCH_WARN("Failed to write config cache to \"%s\".\n", cache->path);
+      return false;
+   }
+
+   struct config_cache_header header = {0};
+   header.magic = CONFIG_CACHE_MAGIC;
+   header.version = CONFIG_CACHE_VERSION;
+   header.num_records = cache->count;
+
+   bool ret = fwrite(&header, sizeof(header), 1, file) == 1;
+   for (i = 0; i < cache->count && ret; i++)
+      ret = fwrite(cache->slots[i].record, cache->slots[i].record->size, 1, file) == 1;
+
+   if (fclose(file) != 0)
+      ret = false;
+
+   if (ret)
+   {
+      RARCH_LOG("Wrote config cache with %u entries to \"%s\".\n", (unsigned)cache->count, cache->path);
+      cache->dirty = false;
+   }
+   else
+   {
+      // A short cache fails validation when it's read back.
+      RARCH_WARN("Failed to write config cache to \"%s\".\n", cache->path);
+   }
+
+   return ret;
+}
+
+void config_cache_free(config_cache_t *cache)
+{
+   size_t i;
+   if (!cache)
+      return;
+
+   for (i = 0; i < cache->count; i++)
+   {
+      if (cache->slots[i].owned)
+         free(cache->slots[i].record);
+   }
+
+   free(cache->slots);
+   free(cache->data);
+   free(cache->path);
+   free(cache);
+}
+
+void config_cache_get_stats(const config_cache_t *cache, unsigned *hits, unsigned *misses)
+{
+   *hits = cache ? cache->hits : 0;
+   *misses = cache ? cache->misses : 0;
+}
@@ -97,6 +97,10 @@ void config_set_string(config_file_t *conf, const char *entry, const char *val);
 void config_set_path(config_file_t *conf, const char *entry, const char *val);
 void config_set_bool(config_file_t *conf, const char *entry, bool val);
 
+// True if a setter changed or added a value since the config was loaded.
+// Setting a value to what it already is does not count.
+bool config_file_is_modified(const config_file_t *conf);
+
 // Write the current config to a file.
 bool config_file_write(config_file_t *conf, const char *path);
 
@@ -105,6 +109,32 @@ void config_file_dump(config_file_t *conf, FILE *file);
 // Also dumps inherited values, useful for logging.
 void config_file_dump_all(config_file_t *conf, FILE *file);
 
+/////
+// Binary cache of parsed config files.
+// A single file holding the parsed entries of every config loaded through it,
+// keyed on path together with size and mtime of the file and everything it #includes.
+// A hit costs a stat() per source file and no parsing. Misses parse normally and update the cache.
+// The cache is native endian and versioned. Anything which does not validate is rebuilt.
+
+typedef struct config_cache config_cache_t;
+
+// Opens the cache at path. Missing or invalid caches start out empty.
+config_cache_t *config_cache_new(const char *path);
+// Like config_file_new(), but served from the cache when it is up to date.
+// A NULL cache simply calls config_file_new().
+config_file_t *config_cache_load(config_cache_t *cache, const char *path);
+// The two halves of config_cache_load(), for callers parsing misses elsewhere, e.g. on other threads.
+// The cache itself is not thread safe.
+// Returns NULL on a miss.
+config_file_t *config_cache_lookup(config_cache_t *cache, const char *path);
+// Records a config freshly loaded with config_file_new(). Must not have been modified yet.
+void config_cache_store(config_cache_t *cache, config_file_t *conf);
+// Writes the cache back if anything changed.
+bool config_cache_flush(config_cache_t *cache);
+void config_cache_free(config_cache_t *cache);
+// Number of loads served from the cache, and loads which had to parse.
+void config_cache_get_stats(const config_cache_t *cache, unsigned *hits, unsigned *misses);
+
 #ifdef __cplusplus
 }
 #endif
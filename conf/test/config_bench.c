@@ -0,0 +1,443 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host-side microbenchmark for config_file_t.
+// Generates overlay style configs of increasing size and times parsing, lookups, writing
+// and loading through config_cache. Also checks lookup, setter, #include and write semantics,
+// for parsed and cache loaded configs alike.
+// Build with the Makefile in this directory. Prints a markdown table to stdout and
+// exits non-zero if a check fails.
+
+#include "../config_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_PATH "config_bench.cfg"
+#define BENCH_OUT_PATH "config_bench_out.cfg"
+#define BENCH_CACHE_PATH "config_bench.cache"
+#define CHECK_PATH "config_bench_check.cfg"
+#define CHECK_INCLUDE_PATH "config_bench_include.cfg"
+#define MIN_SECONDS 0.5
+#define DESC_KEYS 6
+
+#define INFO_FILES 128
+#define INFO_KEYS 24
+
+static unsigned failures;
+
+#define CHECK(cond, ...) do { \
+      if (!(cond)) \
+      { \
+         fprintf(stderr, "FAIL: " __VA_ARGS__); \
+         fprintf(stderr, "\n"); \
+         failures++; \
+      } \
+   } while (0)
+
+static const unsigned sizes[] = { 96, 960, 3840, 15360 };
+
+static const char *desc_keys[DESC_KEYS] = {
+   "x", "y", "range_x", "range_y", "image", "overlay",
+};
+
+static double get_time(void)
+{
+   struct timespec tv;
+   clock_gettime(CLOCK_MONOTONIC, &tv);
+   return tv.tv_sec + tv.tv_nsec / 1000000000.0;
+}
+
+// Keys follow input_overlay_load_desc(), the worst case seen at runtime.
+static void make_key(char *buf, size_t size, unsigned i)
+{
+   snprintf(buf, size, "overlay%u_desc%u_%s", i / (64 * DESC_KEYS), (i / DESC_KEYS) % 64,
+         desc_keys[i % DESC_KEYS]);
+}
+
+static bool write_config(unsigned entries)
+{
+   unsigned i;
+   char key[64];
+   FILE *file = fopen(BENCH_PATH, "w");
+   if (!file)
+      return false;
+
+   fprintf(file, "# Generated by config_bench.\n");
+   for (i = 0; i < entries; i++)
+   {
+      make_key(key, sizeof(key), i);
+      fprintf(file, "%s = \"%u,%u,radial,0.0%u\"\n", key, i, i * 3, i % 10);
+   }
+
+   fclose(file);
+   return true;
+}
+
+static void info_path(char *buf, size_t size, unsigned i)
+{
+   snprintf(buf, size, "config_bench_%u.info", i);
+}
+
+static bool write_file(const char *path, const char *data)
+{
+   FILE *file = fopen(path, "w");
+   if (!file)
+      return false;
+   fputs(data, file);
+   fclose(file);
+   return true;
+}
+
+static char *read_file(const char *path)
+{
+   long len;
+   char *buf = NULL;
+   FILE *file = fopen(path, "r");
+   if (!file)
+      return NULL;
+
+   if (fseek(file, 0, SEEK_END) == 0 && (len = ftell(file)) >= 0 &&
+         fseek(file, 0, SEEK_SET) == 0 && (buf = (char*)malloc(len + 1)))
+   {
+      buf[fread(buf, 1, len, file)] = '\0';
+   }
+
+   fclose(file);
+   return buf;
+}
+
+static void check_value(config_file_t *conf, const char *desc, const char *key, const char *expected)
+{
+   char buf[64];
+   bool found = config_get_array(conf, key, buf, sizeof(buf));
+   CHECK(found && strcmp(buf, expected) == 0, "%s: %s is \"%s\", expected \"%s\"",
+         desc, key, found ? buf : "(missing)", expected);
+}
+
+static const char check_include[] =
+   "shared = \"included\"\n"
+   "include_only = \"included\"\n"
+   "dup = \"included\"\n";
+
+static const char check_config[] =
+   "#include \"" CHECK_INCLUDE_PATH "\"\n"
+   "first = \"1\"\n"
+   "dup = \"a\"\n"
+   "second = \"2\"\n"
+   "dup = \"b\"\n"
+   "shared = \"main\"\n"
+   "twice = \"x\"\n"
+   "twice = \"y\"\n";
+
+// What check_conf() should leave behind. Included entries are not written,
+// the rest keep their order and new keys go last.
+static const char check_written[] =
+   "#include \"" CHECK_INCLUDE_PATH "\"\n"
+   "first = \"1\"\n"
+   "dup = \"set\"\n"
+   "second = \"2\"\n"
+   "dup = \"b\"\n"
+   "shared = \"set\"\n"
+   "twice = \"set\"\n"
+   "twice = \"y\"\n"
+   "include_only = \"set\"\n"
+   "added = \"set\"\n";
+
+static void check_conf(config_file_t *conf, const char *desc)
+{
+   // First match wins, #include or not.
+   check_value(conf, desc, "twice", "x");
+   check_value(conf, desc, "dup", "included");
+   check_value(conf, desc, "shared", "included");
+   check_value(conf, desc, "include_only", "included");
+   CHECK(!config_file_is_modified(conf), "%s: modified after load", desc);
+
+   // Setters write the first entry not from an #include, or append one.
+   config_set_string(conf, "dup", "set");
+   config_set_string(conf, "shared", "set");
+   config_set_string(conf, "twice", "set");
+   config_set_string(conf, "include_only", "set");
+   config_set_string(conf, "added", "set");
+   CHECK(config_file_is_modified(conf), "%s: not modified after setting values", desc);
+
+   // Included entries still come first.
+   check_value(conf, desc, "dup", "included");
+   check_value(conf, desc, "include_only", "included");
+   check_value(conf, desc, "twice", "set");
+   check_value(conf, desc, "added", "set");
+
+   config_file_write(conf, BENCH_OUT_PATH);
+   char *written = read_file(BENCH_OUT_PATH);
+   CHECK(written && strcmp(written, check_written) == 0, "%s: wrote\n%s\nexpected\n%s",
+         desc, written ? written : "(nothing)", check_written);
+   free(written);
+}
+
+// Both configs must list the same entries in the same order.
+static void check_same_entries(config_file_t *a, config_file_t *b, const char *desc)
+{
+   struct config_file_entry ea, eb;
+   bool more_a = config_get_entry_list_head(a, &ea);
+   bool more_b = config_get_entry_list_head(b, &eb);
+   unsigned i = 0;
+
+   for (; more_a && more_b; i++)
+   {
+      CHECK(strcmp(ea.key, eb.key) == 0 && strcmp(ea.value, eb.value) == 0,
+            "%s: entry %u is %s = \"%s\", expected %s = \"%s\"", desc, i, eb.key, eb.value, ea.key, ea.value);
+      more_a = config_get_entry_list_next(&ea);
+      more_b = config_get_entry_list_next(&eb);
+   }
+   CHECK(more_a == more_b, "%s: entry count differs after %u entries", desc, i);
+}
+
+static void check_semantics(void)
+{
+   unsigned hits, misses;
+
+   if (!write_file(CHECK_INCLUDE_PATH, check_include) || !write_file(CHECK_PATH, check_config))
+   {
+      CHECK(false, "failed to write %s", CHECK_PATH);
+      return;
+   }
+
+   config_file_t *conf = config_file_new(CHECK_PATH);
+   CHECK(conf, "failed to parse %s", CHECK_PATH);
+   if (conf)
+      check_conf(conf, "parsed");
+
+   // A miss parses and fills the cache, a fresh cache then serves the same config.
+   remove(BENCH_CACHE_PATH);
+   config_cache_t *cache = config_cache_new(BENCH_CACHE_PATH);
+   config_file_free(config_cache_load(cache, CHECK_PATH));
+   config_cache_get_stats(cache, &hits, &misses);
+   CHECK(hits == 0 && misses == 1, "empty cache: %u hits, %u misses", hits, misses);
+   config_cache_flush(cache);
+   config_cache_free(cache);
+
+   cache = config_cache_new(BENCH_CACHE_PATH);
+   config_file_t *cached = config_cache_load(cache, CHECK_PATH);
+   config_cache_get_stats(cache, &hits, &misses);
+   CHECK(hits == 1 && misses == 0, "filled cache: %u hits, %u misses", hits, misses);
+   config_cache_free(cache);
+
+   config_file_t *parsed = config_file_new(CHECK_PATH);
+   CHECK(cached && parsed, "failed to load %s through the cache", CHECK_PATH);
+   if (cached && parsed)
+   {
+      check_same_entries(parsed, cached, "cached");
+      check_conf(cached, "cached");
+      check_conf(parsed, "parsed again");
+      check_same_entries(parsed, cached, "cached after setting values");
+   }
+
+   config_file_free(conf);
+   config_file_free(cached);
+   config_file_free(parsed);
+   remove(CHECK_PATH);
+   remove(CHECK_INCLUDE_PATH);
+}
+
+// Mimics core_info_list_new(), which loads one small .info file per core.
+static double bench_info_files(config_cache_t *cache)
+{
+   unsigned runs, i;
+   char path[64];
+   double start = get_time();
+
+   for (runs = 0; get_time() - start < MIN_SECONDS; runs++)
+   {
+      for (i = 0; i < INFO_FILES; i++)
+      {
+         info_path(path, sizeof(path), i);
+         config_file_free(config_cache_load(cache, path));
+      }
+   }
+
+   return (get_time() - start) / runs;
+}
+
+static void bench_info(void)
+{
+   unsigned i, j;
+   char path[64];
+
+   for (i = 0; i < INFO_FILES; i++)
+   {
+      info_path(path, sizeof(path), i);
+      FILE *file = fopen(path, "w");
+      if (!file)
+         return;
+
+      fprintf(file, "display_name = \"Core %u\"\n", i);
+      fprintf(file, "supported_extensions = \"bin|rom|img|zip\"\n");
+      for (j = 2; j < INFO_KEYS; j++)
+         fprintf(file, "key%u = \"Some longer value for key %u of core %u\"\n", j, j, i);
+      fclose(file);
+   }
+
+   double parse_time = bench_info_files(NULL);
+
+   remove(BENCH_CACHE_PATH);
+   config_cache_t *cache = config_cache_new(BENCH_CACHE_PATH);
+   bench_info_files(cache);
+   config_cache_flush(cache);
+   config_cache_free(cache);
+
+   cache = config_cache_new(BENCH_CACHE_PATH);
+   double cache_time = bench_info_files(cache);
+   unsigned hits, misses;
+   config_cache_get_stats(cache, &hits, &misses);
+   CHECK(misses == 0 && hits && hits % INFO_FILES == 0, "info files: %u cache hits, %u misses", hits, misses);
+   config_cache_free(cache);
+
+   printf("\n%d core info style files with %d keys each, all loaded in turn.\n\n", INFO_FILES, INFO_KEYS);
+   printf("| Parse ms | Cache hit ms |\n");
+   printf("|----------|--------------|\n");
+   printf("| %.3f | %.3f |\n", parse_time * 1000.0, cache_time * 1000.0);
+
+   for (i = 0; i < INFO_FILES; i++)
+   {
+      info_path(path, sizeof(path), i);
+      remove(path);
+   }
+}
+
+int main(void)
+{
+   unsigned s, i;
+   char buf[64];
+
+   check_semantics();
+
+   printf("config_file benchmark. Overlay style keys (overlayN_descM_*), %d key kinds per desc.\n",
+         DESC_KEYS);
+   printf("Parse and write per file, lookups per call.\n\n");
+   printf("| Entries | Parse ms | Get hit ns | Get miss ns | Set ns | Write ms |\n");
+   printf("|---------|----------|------------|-------------|--------|----------|\n");
+
+   double cache_times[sizeof(sizes) / sizeof(sizes[0])];
+
+   for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+   {
+      unsigned entries = sizes[s];
+      unsigned runs;
+      double start, parse_time, hit_time, miss_time, set_time, write_time;
+      unsigned long long found = 0;
+      char (*keys)[64], (*missing)[64];
+
+      if (!write_config(entries))
+      {
+         fprintf(stderr, "Failed to write %s.\n", BENCH_PATH);
+         return 1;
+      }
+
+      start = get_time();
+      for (runs = 0; get_time() - start < MIN_SECONDS; runs++)
+         config_file_free(config_file_new(BENCH_PATH));
+      parse_time = (get_time() - start) / runs;
+
+      // The first load through the cache parses and fills it, the rest are hits.
+      remove(BENCH_CACHE_PATH);
+      config_cache_t *cache = config_cache_new(BENCH_CACHE_PATH);
+      config_file_free(config_cache_load(cache, BENCH_PATH));
+      config_cache_flush(cache);
+      config_cache_free(cache);
+      cache = config_cache_new(BENCH_CACHE_PATH);
+
+      start = get_time();
+      for (runs = 0; get_time() - start < MIN_SECONDS; runs++)
+         config_file_free(config_cache_load(cache, BENCH_PATH));
+      cache_times[s] = (get_time() - start) / runs;
+
+      unsigned hits, misses;
+      config_cache_get_stats(cache, &hits, &misses);
+      CHECK(misses == 0 && hits == runs, "%u entries: %u cache hits, %u misses in %u loads",
+            entries, hits, misses, runs);
+      config_cache_free(cache);
+
+      config_file_t *conf = config_file_new(BENCH_PATH);
+      keys = calloc(entries, sizeof(*keys));
+      missing = calloc(entries, sizeof(*missing));
+      if (!conf || !keys || !missing)
+         return 1;
+
+      // Keys are formatted up front so the timings only cover config_file.
+      for (i = 0; i < entries; i++)
+      {
+         make_key(keys[i], sizeof(keys[i]), i);
+         snprintf(missing[i], sizeof(missing[i]), "%s_missing", keys[i]);
+      }
+
+      start = get_time();
+      for (runs = 0; get_time() - start < MIN_SECONDS; runs++)
+      {
+         for (i = 0; i < entries; i++)
+            found += config_get_array(conf, keys[i], buf, sizeof(buf));
+      }
+      hit_time = (get_time() - start) / ((double)runs * entries);
+      CHECK(found == (unsigned long long)runs * entries, "%u entries: %llu of %llu lookups found",
+            entries, found, (unsigned long long)runs * entries);
+
+      found = 0;
+
+      start = get_time();
+      for (runs = 0; get_time() - start < MIN_SECONDS; runs++)
+      {
+         for (i = 0; i < entries; i++)
+            found += config_get_array(conf, missing[i], buf, sizeof(buf));
+      }
+      miss_time = (get_time() - start) / ((double)runs * entries);
+      CHECK(found == 0, "%u entries: %llu lookups of missing keys found", entries, found);
+
+      start = get_time();
+      for (runs = 0; get_time() - start < MIN_SECONDS; runs++)
+      {
+         for (i = 0; i < entries; i++)
+            config_set_int(conf, keys[i], runs);
+      }
+      set_time = (get_time() - start) / ((double)runs * entries);
+
+      start = get_time();
+      for (runs = 0; get_time() - start < MIN_SECONDS; runs++)
+         config_file_write(conf, BENCH_OUT_PATH);
+      write_time = (get_time() - start) / runs;
+
+      config_file_free(conf);
+      free(keys);
+      free(missing);
+
+      printf("| %u | %.3f | %.1f | %.1f | %.1f | %.3f |\n", entries,
+            parse_time * 1000.0, hit_time * 1000000000.0, miss_time * 1000000000.0,
+            set_time * 1000000000.0, write_time * 1000.0);
+   }
+
+   printf("\nLoad through config_cache, hits only.\n\n");
+   printf("| Entries | Cache hit ms |\n");
+   printf("|---------|--------------|\n");
+   for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+      printf("| %u | %.3f |\n", sizes[s], cache_times[s] * 1000.0);
+
+   bench_info();
+
+   remove(BENCH_PATH);
+   remove(BENCH_OUT_PATH);
+   remove(BENCH_CACHE_PATH);
+
+   printf("\n%s\n", failures ? "FAILED" : "All checks passed.");
+   return failures ? 1 : 0;
+}
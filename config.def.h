@@ -49,6 +49,12 @@
 // Video VSYNC (recommended)
 #define DEFAULT_VIDEO_VSYNC true
 
+// Filter, convert and present frames on a separate thread while the next frame is emulated.
+#define DEFAULT_VIDEO_THREADED false
+
+// While fast-forwarding, present every Nth emulated frame. 0 presents at most one frame per display refresh.
+#define DEFAULT_VIDEO_FASTFORWARD_FRAMESKIP 0
+
 // Smooths picture
 #define DEFAULT_VIDEO_BILINEAR_FILTER false
 
@@ -127,6 +133,12 @@
 
 #define DEFAULT_AUDIO_MUTE false
 
+// Swap to cheap resamplers while fast-forwarding (nearest) or in slowmotion (linear).
+#define DEFAULT_AUDIO_FAST_RESAMPLER true
+
+// Drop audio entirely while fast-forwarding. Gives maximum speed.
+#define DEFAULT_AUDIO_FASTFORWARD_MUTE false
+
 //////////////
 // Rewind
 //////////////
@@ -140,6 +152,12 @@
 // How many frames to rewind at a time.
 #define DEFAULT_REWIND_GRANULARITY 1
 
+// Keep recording rewind states while fast-forwarding. Disabling this speeds up fast-forward.
+#define DEFAULT_REWIND_FASTFORWARD true
+
+// Recorded movies store a checksum of the save state every this many frames. 0 disables.
+#define DEFAULT_MOVIE_CHECKSUM_INTERVAL 60
+
 //////////////
 // Saves
 //////////////
@@ -186,6 +204,9 @@
 // Enable input auto-config gamepad buttons, plug-and-play style.
 #define DEFAULT_INPUT_AUTOCONF_BUTTONS true
 
+// Defer polling the controllers until the core first reads input during the frame.
+#define DEFAULT_INPUT_LAZY_POLL false
+
 // Number of players to rotate using the quick swap controller feature.
 // 1 means disabled.
 #define DEFAULT_QUICK_SWAP_PLAYERS 1
@@ -135,7 +135,7 @@ core_option_manager_t *core_option_new(const char *conf_path, const struct retro
    size_t size = 0;
 
    if (*conf_path)
-      opt->conf = config_file_new(conf_path);
+      opt->conf = config_cache_load(g_extern.config_cache, conf_path);
    if (!opt->conf)
       opt->conf = config_file_new(NULL);
 
@@ -26,19 +26,34 @@
 #include "gfx/gfx_common.h"
 
 static const audio_driver_t *audio_drivers[] = {
+#if defined(HW_RVL) || defined(HW_DOL)
    &audio_gx,
+#endif
+#ifdef HAVE_NULLDRIVERS
+   &audio_null,
+#endif
    NULL,
 };
 
 static const video_driver_t *video_drivers[] = {
+#if defined(HW_RVL) || defined(HW_DOL)
    &video_gx,
+#endif
+#ifdef HAVE_NULLDRIVERS
+   &video_null,
+#endif
    NULL,
 };
 
 static const input_driver_t *input_drivers[] = {
+#if defined(HW_RVL) || defined(HW_DOL)
    &input_gx,
+#endif
 #if defined (HW_RVL) && defined(HAVE_WIIUSBPAD)
    &input_gx_hid,
+#endif
+#ifdef HAVE_NULLDRIVERS
+   &input_null,
 #endif
    NULL,
 };
@@ -448,12 +463,29 @@ void init_audio(void)
       g_extern.audio_active = false;
    }
 
+   g_extern.audio_data.resampler_mode = AUDIO_RESAMPLER_QUALITY;
+   g_extern.audio_data.fade_mode      = AUDIO_RESAMPLER_QUALITY;
+   g_extern.audio_data.fade_frames    = 0;
+
+   if (g_settings.audio.fast_resampler)
+   {
+      // Not fatal, audio_flush() falls back to the quality resampler.
+      if (!rarch_resampler_realloc(&g_extern.audio_data.fast_resampler_data, &g_extern.audio_data.fast_resampler,
+            "nearest", g_extern.audio_data.orig_src_ratio))
+         RARCH_WARN("Failed to initialize fast-forward resampler.\n");
+      if (!rarch_resampler_realloc(&g_extern.audio_data.slow_resampler_data, &g_extern.audio_data.slow_resampler,
+            "linear", g_extern.audio_data.orig_src_ratio))
+         RARCH_WARN("Failed to initialize slowmotion resampler.\n");
+   }
+
    rarch_assert(g_extern.audio_data.data = (float*)malloc(max_bufsamples * sizeof(float)));
 
    g_extern.audio_data.data_ptr = 0;
 
    rarch_assert(g_settings.audio.out_rate < g_extern.audio_data.in_rate * AUDIO_MAX_RATIO);
    rarch_assert(g_extern.audio_data.outsamples = (float*)malloc(outsamples_max * sizeof(float)));
+   if (g_extern.audio_data.fast_resampler || g_extern.audio_data.slow_resampler)
+      rarch_assert(g_extern.audio_data.fade_outsamples = (float*)malloc(outsamples_max * sizeof(float)));
 
    g_extern.audio_data.rate_control = false;
    if (g_extern.audio_active && g_settings.audio.rate_control)
@@ -493,12 +525,17 @@ void uninit_audio(void)
    }
 
    rarch_resampler_freep(&g_extern.audio_data.resampler, &g_extern.audio_data.resampler_data);
+   rarch_resampler_freep(&g_extern.audio_data.fast_resampler, &g_extern.audio_data.fast_resampler_data);
+   rarch_resampler_freep(&g_extern.audio_data.slow_resampler, &g_extern.audio_data.slow_resampler_data);
 
    free(g_extern.audio_data.data);
    g_extern.audio_data.data = NULL;
 
    free(g_extern.audio_data.outsamples);
    g_extern.audio_data.outsamples = NULL;
+
+   free(g_extern.audio_data.fade_outsamples);
+   g_extern.audio_data.fade_outsamples = NULL;
 }
 
 void init_video_input(void)
@@ -550,6 +587,15 @@ void init_video_input(void)
    driver.video->poke_interface(driver.video_data, &driver.video_poke);
    driver.video_poke->set_refresh_rate(driver.video_data, g_settings.video.resolution_idx);
 
+#ifdef HAVE_THREADS
+   if (g_settings.video.threaded && !driver.video_thread)
+   {
+      driver.video_thread = rarch_threaded_video_new();
+      if (driver.video_thread)
+         rarch_threaded_video_get_poke_interface(driver.video_thread, &driver.video_poke);
+   }
+#endif
+
    /* Do not initilize twice the input driver. */
    if (driver.input && !driver.input_data)
    {
@@ -564,6 +610,17 @@ void init_video_input(void)
 
 void uninit_video_input(void)
 {
+#ifdef HAVE_THREADS
+   // Stop the thread even if the driver stays locked, the filter is freed right after this.
+   if (driver.video_thread)
+   {
+      rarch_threaded_video_free(driver.video_thread);
+      driver.video_thread = NULL;
+      if (driver.video && driver.video_data)
+         driver.video->poke_interface(driver.video_data, &driver.video_poke);
+   }
+#endif
+
    if (!driver.video_input_locked) /* if locked, it will be done later */
    {
       if (driver.input && driver.input_data)
@@ -27,6 +27,9 @@
 #ifdef HAVE_SCALERS_BUILTIN
 #include "gfx/filters/softfilter.h"
 #endif
+#ifdef HAVE_THREADS
+#include "gfx/thread_wrapper.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,6 +38,7 @@ extern "C" {
 #define AUDIO_CHUNK_SIZE_BLOCKING 512
 #define AUDIO_CHUNK_SIZE_NONBLOCKING 2048 // So we don't get complete line-noise when fast-forwarding audio.
 #define AUDIO_MAX_RATIO 16
+#define AUDIO_RESAMPLER_FADE_FRAMES 256 // Crossfade length when switching back to the quality resampler.
 
 // Specialized _POINTER that targets the full screen regardless of viewport.
 // Should not be used by a libretro implementation as coordinates returned make no sense.
@@ -129,8 +133,6 @@ struct retro_keybind
 
    uint32_t joyaxis;
    uint32_t def_joyaxis;
-
-   uint32_t orig_joyaxis; // Used by input_{push,pop}_analog_dpad().
 };
 
 struct platform_bind
@@ -292,6 +294,11 @@ typedef struct driver
 
    // last message given to the video driver
    const char *current_msg;
+
+#ifdef HAVE_THREADS
+   // Set while video_threaded is active. driver.video keeps pointing to the real driver.
+   thread_video_t *video_thread;
+#endif
 } driver_t;
 
 void init_drivers(void);
@@ -27,26 +27,35 @@
 #define audio_write_avail_func()                driver.audio->write_avail(driver.audio_data)
 #define audio_buffer_size_func()                driver.audio->buffer_size(driver.audio_data)
 
-#define video_init_func(data, scale, rgb32) driver.video->init(data, scale, rgb32)
+#ifdef HAVE_THREADS
+// Anything but frames must wait for the video thread to go idle.
+#define video_thread_sync() (driver.video_thread ? rarch_threaded_video_sync(driver.video_thread) : (void)0)
+#define video_frame_func(data, width, height, pitch, msg) (driver.video_thread ? \
+      rarch_threaded_video_frame(driver.video_thread, data, width, height, pitch, msg) : \
+      driver.video->frame(driver.video_data, data, width, height, pitch, msg))
+#define video_overlay_interface_func(iface) (driver.video_thread ? \
+      rarch_threaded_video_get_overlay_interface(driver.video_thread, iface) : \
+      driver.video->overlay_interface(driver.video_data, iface))
+#else
+#define video_thread_sync() ((void)0)
 #define video_frame_func(data, width, height, pitch, msg) driver.video->frame(driver.video_data, data, width, height, pitch, msg)
-#define video_set_nonblock_state_func(state) driver.video->set_nonblock_state(driver.video_data, state)
-#define video_set_rotation_func(rotate) driver.video->set_rotation(driver.video_data, rotate)
-#define video_viewport_info_func(info) driver.video->viewport_info(driver.video_data, info)
 #define video_overlay_interface_func(iface) driver.video->overlay_interface(driver.video_data, iface)
+#endif
+
+#define video_init_func(data, scale, rgb32) driver.video->init(data, scale, rgb32)
+#define video_set_nonblock_state_func(state) (video_thread_sync(), driver.video->set_nonblock_state(driver.video_data, state))
+#define video_set_rotation_func(rotate) (video_thread_sync(), driver.video->set_rotation(driver.video_data, rotate))
+#define video_viewport_info_func(info) (video_thread_sync(), driver.video->viewport_info(driver.video_data, info))
 #define video_free_func() driver.video->free(driver.video_data)
 #define input_init_func() driver.input->init()
 #define input_poll_func() driver.input->poll(driver.input_data)
 #define input_input_state_func(retro_keybinds, port, device, index, id) driver.input->input_state(driver.input_data, retro_keybinds, port, device, index, id)
 #define input_free_func() driver.input->free(driver.input_data)
 
-static inline bool input_key_pressed_func(int key)
-{
-   bool ret = false;
-
-   if (!driver.block_hotkey)
-      ret = ret || driver.input->key_pressed(driver.input_data, key);
-
-   return ret;
-}
+// Hotkeys are bit tests on the input snapshot, lifecycle commands are read live.
+#define input_key_pressed_func(key) (!driver.block_hotkey && \
+      ((g_extern.input.buttons[0] | g_extern.lifecycle_state) & (1ULL << (key))))
+#define input_key_pressed_last_func(key) ((g_extern.input.keys_last & (1ULL << (key))) != 0)
+#define input_key_triggered_func(key) (input_key_pressed_func(key) && !input_key_pressed_last_func(key))
 
 #endif /* _RARCH_DRIVER_FUNCS_H */
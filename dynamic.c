@@ -26,11 +26,24 @@
 #include <stdbool.h>
 #include "libretro_private.h"
 #include "dynamic_dummy.h"
-
+#ifdef HAVE_STRESS_CORE
+#include "dynamic_stress.h"
+#endif
+
+#ifdef NO_LINKED_CORE
+// Host builds without a static core run the synthetic core only.
+#ifndef HAVE_STRESS_CORE
+#error "NO_LINKED_CORE requires HAVE_STRESS_CORE."
+#endif
+#define SYM(x) p##x = libretro_stress_##x
+#else
 #define SYM(x) p##x = x
+#endif
 
 #define SYM_DUMMY(x) p##x = libretro_dummy_##x
 
+#define SYM_STRESS(x) p##x = libretro_stress_##x
+
 void (*pretro_init)(void);
 void (*pretro_deinit)(void);
 
@@ -112,6 +125,41 @@ static void load_symbols(bool is_dummy)
       SYM_DUMMY(retro_get_memory_data);
       SYM_DUMMY(retro_get_memory_size);
    }
+#ifdef HAVE_STRESS_CORE
+   else if (g_extern.libretro_stress)
+   {
+      SYM_STRESS(retro_init);
+      SYM_STRESS(retro_deinit);
+
+      SYM_STRESS(retro_api_version);
+      SYM_STRESS(retro_get_system_info);
+      SYM_STRESS(retro_get_system_av_info);
+
+      SYM_STRESS(retro_set_environment);
+      SYM_STRESS(retro_set_video_refresh);
+      SYM_STRESS(retro_set_audio_sample);
+      SYM_STRESS(retro_set_audio_sample_batch);
+      SYM_STRESS(retro_set_input_poll);
+      SYM_STRESS(retro_set_input_state);
+
+      SYM_STRESS(retro_set_controller_port_device);
+
+      SYM_STRESS(retro_reset);
+      SYM_STRESS(retro_run);
+
+      SYM_STRESS(retro_serialize_size);
+      SYM_STRESS(retro_serialize);
+      SYM_STRESS(retro_unserialize);
+
+      SYM_STRESS(retro_load_game);
+      SYM_STRESS(retro_load_game_special);
+
+      SYM_STRESS(retro_unload_game);
+      SYM_STRESS(retro_get_region);
+      SYM_STRESS(retro_get_memory_data);
+      SYM_STRESS(retro_get_memory_size);
+   }
+#endif
    else
    {
       SYM(retro_init);
@@ -470,8 +518,8 @@ bool rarch_environment_cb(unsigned cmd, void *data)
          cb->get_cpu_features = rarch_get_cpu_features;
          cb->get_perf_counter = rarch_get_perf_counter;
          cb->perf_register    = retro_perf_register; // libretro specific path.
-         cb->perf_start       = rarch_perf_start;
-         cb->perf_stop        = rarch_perf_stop;
+         cb->perf_start       = retro_perf_start;
+         cb->perf_stop        = retro_perf_stop;
          cb->perf_log         = retro_perf_log; // libretro specific path.
          break;
       }
@@ -0,0 +1,395 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2014 - Daniel De Matteis
+ *  Copyright (C) 2012-2014 - Michael Lelli
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dynamic_stress.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STRESS_FPS 60
+
+static const struct retro_variable stress_vars[] = {
+   { "stress_resolution", "Resolution; 320x240|256x224|512x448|640x480|1280x720|1920x1080" },
+   { "stress_pixel_format", "Pixel format; RGB565|XRGB8888|0RGB1555" },
+   { "stress_video_dirty", "Changed pixels per frame (%); 100|0|1|10|25|50|75" },
+   { "stress_audio_rate", "Audio rate; 32040|32000|44100|48000|96000" },
+   { "stress_audio_batch", "Audio frames per batch call; frame|1|16|64|256|1024" },
+   { "stress_state_size", "Save state size (KiB); 64|0|1|16|256|1024|4096" },
+   { "stress_state_dirty", "Changed state bytes per frame (%); 1|0|10|50|100" },
+   { "stress_input_polls", "input_state calls per frame; 16|0|1|64|256|1024" },
+   { NULL, NULL },
+};
+
+// Everything a frame depends on. Kept at the front of the save state so rewind and movies round-trip.
+struct stress_core_state
+{
+   uint32_t frame;
+   uint32_t rng;
+   uint32_t input_acc;
+   uint32_t audio_phase;
+};
+
+static struct
+{
+   unsigned width, height;
+   enum retro_pixel_format fmt;
+   unsigned bpp;
+   unsigned video_dirty;
+
+   unsigned audio_rate;
+   unsigned audio_batch; // 0 means the whole frame in one call.
+
+   size_t state_size;
+   unsigned state_dirty;
+
+   unsigned input_polls;
+
+   uint8_t *frame_buf;
+   uint8_t *state_buf;
+   int16_t *audio_buf;
+   size_t audio_buf_frames;
+
+   struct stress_core_state s;
+} stress;
+
+static retro_video_refresh_t stress_video_cb;
+static retro_audio_sample_t stress_audio_cb;
+static retro_audio_sample_batch_t stress_audio_batch_cb;
+static retro_environment_t stress_environ_cb;
+static retro_input_poll_t stress_input_poll_cb;
+static retro_input_state_t stress_input_state_cb;
+
+static const char *stress_get_var(const char *key)
+{
+   struct retro_variable var = { key, NULL };
+   if (!stress_environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) || !var.value)
+      return NULL;
+   return var.value;
+}
+
+// Falls back to the default (first value) if the frontend has no value.
+static unsigned stress_get_uint(const char *key, unsigned def)
+{
+   const char *val = stress_get_var(key);
+   return val ? strtoul(val, NULL, 0) : def;
+}
+
+static uint32_t stress_rand(void)
+{
+   // xorshift32
+   uint32_t x = stress.s.rng;
+   x ^= x << 13;
+   x ^= x >> 17;
+   x ^= x << 5;
+   stress.s.rng = x;
+   return x;
+}
+
+void libretro_stress_retro_init(void)
+{
+   memset(&stress, 0, sizeof(stress));
+}
+
+void libretro_stress_retro_deinit(void)
+{
+   libretro_stress_retro_unload_game();
+}
+
+unsigned libretro_stress_retro_api_version(void)
+{
+   return RETRO_API_VERSION;
+}
+
+void libretro_stress_retro_set_controller_port_device(unsigned port, unsigned device)
+{
+   (void)port;
+   (void)device;
+}
+
+void libretro_stress_retro_get_system_info(struct retro_system_info *info)
+{
+   memset(info, 0, sizeof(*info));
+   info->library_name     = "Stress Core";
+   info->library_version  = "1";
+   info->need_fullpath    = false;
+   info->valid_extensions = ""; // Nothing.
+}
+
+void libretro_stress_retro_get_system_av_info(struct retro_system_av_info *info)
+{
+   info->timing.fps = STRESS_FPS;
+   info->timing.sample_rate = stress.audio_rate;
+
+   info->geometry.base_width  = stress.width;
+   info->geometry.base_height = stress.height;
+   info->geometry.max_width   = stress.width;
+   info->geometry.max_height  = stress.height;
+   info->geometry.aspect_ratio = (float)stress.width / stress.height;
+}
+
+void libretro_stress_retro_set_environment(retro_environment_t cb)
+{
+   bool no_game = true;
+   stress_environ_cb = cb;
+
+   stress_environ_cb(RETRO_ENVIRONMENT_SET_VARIABLES, (void*)stress_vars);
+   stress_environ_cb(RETRO_ENVIRONMENT_SET_SUPPORT_NO_GAME, &no_game);
+}
+
+void libretro_stress_retro_set_audio_sample(retro_audio_sample_t cb)
+{
+   stress_audio_cb = cb;
+}
+
+void libretro_stress_retro_set_audio_sample_batch(retro_audio_sample_batch_t cb)
+{
+   stress_audio_batch_cb = cb;
+}
+
+void libretro_stress_retro_set_input_poll(retro_input_poll_t cb)
+{
+   stress_input_poll_cb = cb;
+}
+
+void libretro_stress_retro_set_input_state(retro_input_state_t cb)
+{
+   stress_input_state_cb = cb;
+}
+
+void libretro_stress_retro_set_video_refresh(retro_video_refresh_t cb)
+{
+   stress_video_cb = cb;
+}
+
+void libretro_stress_retro_reset(void)
+{
+   memset(&stress.s, 0, sizeof(stress.s));
+   stress.s.rng = 1;
+}
+
+static void stress_run_input(void)
+{
+   unsigned i;
+   stress_input_poll_cb();
+   for (i = 0; i < stress.input_polls; i++)
+      stress.s.input_acc += stress_input_state_cb(i & 1, RETRO_DEVICE_JOYPAD, 0, (i >> 1) & 15);
+}
+
+// Touches a window of video_dirty percent of the pixels, moving every frame.
+static void stress_run_video(void)
+{
+   size_t i;
+   size_t pixels = stress.width * stress.height;
+   size_t dirty  = pixels * stress.video_dirty / 100;
+   size_t pos    = (size_t)stress.s.frame * dirty % pixels;
+   uint32_t seed = stress.s.frame * 0x9e3779b9u;
+
+   if (stress.bpp == 4)
+   {
+      uint32_t *buf = (uint32_t*)stress.frame_buf;
+      for (i = 0; i < dirty; i++, pos = pos + 1 < pixels ? pos + 1 : 0)
+         buf[pos] = (seed + i) & 0xffffff;
+   }
+   else
+   {
+      uint16_t *buf = (uint16_t*)stress.frame_buf;
+      for (i = 0; i < dirty; i++, pos = pos + 1 < pixels ? pos + 1 : 0)
+         buf[pos] = seed + i;
+   }
+
+   stress_video_cb(stress.frame_buf, stress.width, stress.height, stress.width * stress.bpp);
+}
+
+static void stress_run_audio(void)
+{
+   size_t i;
+
+   // Exact long term rate even when the rate is not a multiple of the frame rate.
+   uint64_t frame = stress.s.frame;
+   size_t frames = (frame + 1) * stress.audio_rate / STRESS_FPS - frame * stress.audio_rate / STRESS_FPS;
+   if (frames > stress.audio_buf_frames)
+      frames = stress.audio_buf_frames;
+
+   // Triangle wave, ~440 Hz at 48 kHz.
+   for (i = 0; i < frames; i++)
+   {
+      uint32_t phase = stress.s.audio_phase++ % 108;
+      int16_t s = (int16_t)((phase < 54 ? phase : 108 - phase) * 512 - 13824);
+      stress.audio_buf[2 * i + 0] = s;
+      stress.audio_buf[2 * i + 1] = s;
+   }
+
+   if (stress.audio_batch == 1)
+   {
+      for (i = 0; i < frames; i++)
+         stress_audio_cb(stress.audio_buf[2 * i + 0], stress.audio_buf[2 * i + 1]);
+   }
+   else
+   {
+      size_t batch = stress.audio_batch ? stress.audio_batch : frames;
+      for (i = 0; i < frames; i += batch)
+         stress_audio_batch_cb(stress.audio_buf + 2 * i, frames - i < batch ? frames - i : batch);
+   }
+}
+
+// Dirties state_dirty percent of the save state, moving every frame like the video.
+static void stress_run_state(void)
+{
+   size_t i;
+   if (stress.state_size <= sizeof(stress.s))
+      return;
+
+   size_t body  = stress.state_size - sizeof(stress.s);
+   size_t dirty = body * stress.state_dirty / 100;
+   size_t pos   = (size_t)stress.s.frame * dirty % body;
+   uint8_t *buf = stress.state_buf + sizeof(stress.s);
+
+   for (i = 0; i < dirty; i++, pos = pos + 1 < body ? pos + 1 : 0)
+      buf[pos] = stress_rand();
+}
+
+void libretro_stress_retro_run(void)
+{
+   stress_run_input();
+   stress_run_state();
+   stress_run_audio();
+   stress_run_video();
+   stress.s.frame++;
+}
+
+bool libretro_stress_retro_load_game(const struct retro_game_info *info)
+{
+   const char *val;
+   (void)info;
+
+   stress.width = 320;
+   stress.height = 240;
+   if ((val = stress_get_var("stress_resolution")))
+   {
+      char *end;
+      unsigned w = strtoul(val, &end, 0);
+      unsigned h = *end == 'x' ? strtoul(end + 1, NULL, 0) : 0;
+      if (w && h)
+      {
+         stress.width = w;
+         stress.height = h;
+      }
+   }
+
+   stress.fmt = RETRO_PIXEL_FORMAT_RGB565;
+   if ((val = stress_get_var("stress_pixel_format")))
+   {
+      if (!strcmp(val, "XRGB8888"))
+         stress.fmt = RETRO_PIXEL_FORMAT_XRGB8888;
+      else if (!strcmp(val, "0RGB1555"))
+         stress.fmt = RETRO_PIXEL_FORMAT_0RGB1555;
+   }
+   if (!stress_environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &stress.fmt))
+      stress.fmt = RETRO_PIXEL_FORMAT_0RGB1555;
+   stress.bpp = stress.fmt == RETRO_PIXEL_FORMAT_XRGB8888 ? 4 : 2;
+
+   stress.video_dirty = stress_get_uint("stress_video_dirty", 100);
+   stress.audio_rate  = stress_get_uint("stress_audio_rate", 32040);
+   stress.audio_batch = stress_get_uint("stress_audio_batch", 0); // "frame" parses as 0.
+   stress.state_size  = stress_get_uint("stress_state_size", 64) * 1024;
+   stress.state_dirty = stress_get_uint("stress_state_dirty", 1);
+   stress.input_polls = stress_get_uint("stress_input_polls", 16);
+
+   if (stress.video_dirty > 100)
+      stress.video_dirty = 100;
+   if (stress.state_dirty > 100)
+      stress.state_dirty = 100;
+   if (!stress.audio_rate)
+      stress.audio_rate = 32040;
+   if (stress.state_size && stress.state_size < sizeof(stress.s))
+      stress.state_size = sizeof(stress.s);
+
+   stress.audio_buf_frames = stress.audio_rate / STRESS_FPS + 1;
+
+   stress.frame_buf = (uint8_t*)calloc(stress.width * stress.height, stress.bpp);
+   stress.audio_buf = (int16_t*)calloc(stress.audio_buf_frames * 2, sizeof(int16_t));
+   stress.state_buf = stress.state_size ? (uint8_t*)calloc(1, stress.state_size) : NULL;
+
+   if (!stress.frame_buf || !stress.audio_buf || (stress.state_size && !stress.state_buf))
+   {
+      libretro_stress_retro_unload_game();
+      return false;
+   }
+
+   libretro_stress_retro_reset();
+   return true;
+}
+
+void libretro_stress_retro_unload_game(void)
+{
+   free(stress.frame_buf);
+   free(stress.audio_buf);
+   free(stress.state_buf);
+   stress.frame_buf = NULL;
+   stress.audio_buf = NULL;
+   stress.state_buf = NULL;
+}
+
+unsigned libretro_stress_retro_get_region(void)
+{
+   return RETRO_REGION_NTSC;
+}
+
+bool libretro_stress_retro_load_game_special(unsigned type, const struct retro_game_info *info, size_t num)
+{
+   (void)type;
+   (void)info;
+   (void)num;
+   return false;
+}
+
+size_t libretro_stress_retro_serialize_size(void)
+{
+   return stress.state_size;
+}
+
+bool libretro_stress_retro_serialize(void *data, size_t size)
+{
+   if (!stress.state_size || size < stress.state_size)
+      return false;
+
+   memcpy(stress.state_buf, &stress.s, sizeof(stress.s));
+   memcpy(data, stress.state_buf, stress.state_size);
+   return true;
+}
+
+bool libretro_stress_retro_unserialize(const void *data, size_t size)
+{
+   if (!stress.state_size || size < stress.state_size)
+      return false;
+
+   memcpy(stress.state_buf, data, stress.state_size);
+   memcpy(&stress.s, stress.state_buf, sizeof(stress.s));
+   return true;
+}
+
+void *libretro_stress_retro_get_memory_data(unsigned id)
+{
+   (void)id;
+   return NULL;
+}
+
+size_t libretro_stress_retro_get_memory_size(unsigned id)
+{
+   (void)id;
+   return 0;
+}
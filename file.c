@@ -23,6 +23,7 @@
 #include "dynamic.h"
 #include "compat/strl.h"
 #include "file_extract.h"
+#include "hash.h"
 
 static const char *ramtype2str(int type)
 {
@@ -204,34 +205,56 @@ void save_ram_file(const char *path, int type)
 
 #define MAX_ROMS 4
 
-static bool load_roms(unsigned rom_type, const char **rom_paths, size_t roms)
+// If rom0_buf is set, the first ROM was already loaded, e.g. inflated from a ZIP, and its CRC is rom0_crc.
+// load_roms() takes ownership of rom0_buf.
+static bool load_roms(unsigned rom_type, const char **rom_paths, size_t roms,
+      void *rom0_buf, long rom0_len, uint32_t rom0_crc)
 {
    size_t i;
    bool ret = true;
 
-   if (roms == 0)
-      return false;
-
-   if (roms > MAX_ROMS)
-      return false;
-
    void *rom_buf[MAX_ROMS] = {NULL};
    long rom_len[MAX_ROMS] = {0};
    struct retro_game_info info[MAX_ROMS] = {{NULL}};
 
+   rom_buf[0] = rom0_buf;
+   rom_len[0] = rom0_len;
+
+   if (roms == 0 || roms > MAX_ROMS)
+   {
+      ret = false;
+      goto end;
+   }
+
+   g_extern.content_crc = 0;
+
    for (i = 0; i < roms; i++)
    {
-      RARCH_LOG("Loading ROM file: %s.\n", rom_paths[i]);
-      if (rom_paths[i] &&
-            !g_extern.system.info.need_fullpath &&
-            (rom_len[i] = read_file(rom_paths[i], &rom_buf[i])) == -1)
+      if (i == 0 && rom0_buf)
       {
-         RARCH_ERR("Could not read ROM file: \"%s\".\n", rom_paths[i]);
-         ret = false;
-         goto end;
+         RARCH_LOG("Loading ROM from memory: %s.\n", rom_paths[i]);
+         g_extern.content_crc = rom0_crc;
+      }
+      else
+      {
+         RARCH_LOG("Loading ROM file: %s.\n", rom_paths[i]);
+         if (rom_paths[i] &&
+               !g_extern.system.info.need_fullpath &&
+               (rom_len[i] = read_file(rom_paths[i], &rom_buf[i])) == -1)
+         {
+            RARCH_ERR("Could not read ROM file: \"%s\".\n", rom_paths[i]);
+            ret = false;
+            goto end;
+         }
+
+         if (i == 0 && rom_buf[i])
+            g_extern.content_crc = crc32_calculate((const uint8_t*)rom_buf[i], rom_len[i]);
+         // The core loads the file itself, hash it here so movies can still check the content.
+         else if (i == 0 && rom_paths[i] && !crc32_file(rom_paths[i], &g_extern.content_crc))
+            RARCH_WARN("Could not read \"%s\" to compute its CRC32.\n", rom_paths[i]);
       }
       RARCH_LOG("ROM size: %u bytes.\n", (unsigned)rom_len[i]);
-      
+
       info[i].path = rom_paths[i];
       info[i].data = rom_buf[i];
       info[i].size = rom_len[i];
@@ -252,7 +275,7 @@ end:
    return ret;
 }
 
-static bool load_normal_rom(void)
+static bool load_normal_rom(void *rom_buf, long rom_len, uint32_t rom_crc)
 {
    if (g_extern.libretro_no_rom && g_extern.system.no_game)
       return pretro_load_game(NULL);
@@ -264,18 +287,37 @@ static bool load_normal_rom(void)
    else
    {
       const char *path = g_extern.fullpath;
-      return load_roms(0, &path, 1);
+      return load_roms(0, &path, 1, rom_buf, rom_len, rom_crc);
    }
 }
 
 bool init_rom_file(void)
 {
+   void *rom_buf = NULL;
+   long rom_len = 0;
+   uint32_t rom_crc = 0;
+
 #ifdef HAVE_ZLIB
    if (*g_extern.fullpath && !g_extern.system.block_extract)
    {
       const char *ext = path_get_extension(g_extern.fullpath);
-      if (ext && !strcasecmp(ext, "zip"))
+      if (ext && !strcasecmp(ext, "zip") && !g_extern.system.info.need_fullpath)
+      {
+         // Core takes the ROM from memory, so inflate straight into the buffer we hand it.
+         // No temporary file is written, and the CRC is computed while inflating.
+         // fullpath becomes the path the ROM would have been extracted to, so saves are named as before.
+         size_t size = 0;
+         if (!zlib_extract_first_rom_to_memory(g_extern.fullpath, sizeof(g_extern.fullpath),
+                  g_extern.system.valid_extensions, &rom_buf, &size, &rom_crc))
+         {
+            RARCH_ERR("Failed to extract ROM from zipped file: %s.\n", g_extern.fullpath);
+            return false;
+         }
+         rom_len = size;
+      }
+      else if (ext && !strcasecmp(ext, "zip"))
       {
+         // Core wants a path, extract to a temporary file next to the ZIP.
          g_extern.rom_file_temporary = true;
 
          if (!zlib_extract_first_rom(g_extern.fullpath, sizeof(g_extern.fullpath), g_extern.system.valid_extensions))
@@ -290,7 +332,7 @@ bool init_rom_file(void)
    }
 #endif
 
-   if (!load_normal_rom())
+   if (!load_normal_rom(rom_buf, rom_len, rom_crc))
       return false;
 
    return true;
@@ -20,21 +20,24 @@
 #include <stdlib.h>
 #include <string.h>
 #include <zlib.h>
+#include <sys/stat.h>
+#include <time.h>
 #include "hash.h"
 
 // File backends. Can be fleshed out later, but keep it simple for now.
-// The file is mapped to memory directly (via mmap() or just plain read_file()).
+// Archives are read with seek+read, so only the central directory and the entries
+// which are actually extracted are ever read from disk.
 struct zlib_file_backend
 {
    void *(*open)(const char *path);
-   const uint8_t *(*data)(void *handle);
    size_t (*size)(void *handle);
-   void (*free)(void *handle); // Closes, unmaps and frees.
+   bool (*read)(void *handle, size_t offset, void *buf, size_t size);
+   void (*free)(void *handle); // Closes and frees.
 };
 
 typedef struct
 {
-   void *data;
+   FILE *file;
    size_t size;
 } zlib_file_data_t;
 
@@ -43,36 +46,46 @@ static void zlib_file_free(void *handle)
    zlib_file_data_t *data = (zlib_file_data_t*)handle;
    if (!data)
       return;
-   free(data->data);
+   if (data->file)
+      fclose(data->file);
    free(data);
 }
 
-static const uint8_t *zlib_file_data(void *handle)
+static size_t zlib_file_size(void *handle)
 {
    zlib_file_data_t *data = (zlib_file_data_t*)handle;
-   return (const uint8_t*)data->data;
+   return data->size;
 }
 
-static size_t zlib_file_size(void *handle)
+static bool zlib_file_read(void *handle, size_t offset, void *buf, size_t size)
 {
    zlib_file_data_t *data = (zlib_file_data_t*)handle;
-   return data->size;
+   if (offset > data->size || size > data->size - offset)
+      return false;
+   if (fseek(data->file, (long)offset, SEEK_SET) != 0)
+      return false;
+   return fread(buf, 1, size, data->file) == size;
 }
 
 static void *zlib_file_open(const char *path)
 {
+   long size;
    zlib_file_data_t *data = (zlib_file_data_t*)calloc(1, sizeof(*data));
    if (!data)
       return NULL;
-   ssize_t ret = read_file(path, &data->data);
-   if (ret < 0)
+
+   data->file = fopen(path, "rb");
+   if (!data->file)
    {
       RARCH_ERR("Failed to open archive: %s.\n",
             path);
       goto error;
    }
 
-   data->size = ret;
+   if (fseek(data->file, 0, SEEK_END) != 0 || (size = ftell(data->file)) < 0)
+      goto error;
+
+   data->size = size;
    return data;
 
 error:
@@ -82,8 +95,8 @@ error:
 
 static const struct zlib_file_backend zlib_backend = {
    zlib_file_open,
-   zlib_file_data,
    zlib_file_size,
+   zlib_file_read,
    zlib_file_free,
 };
 
@@ -92,7 +105,6 @@ const struct zlib_file_backend *zlib_get_default_file_backend(void)
    return &zlib_backend;
 }
 
-
 // Modified from nall::unzip (higan).
 
 #undef GOTO_END_ERROR
@@ -108,41 +120,82 @@ static uint32_t read_le(const uint8_t *data, unsigned size)
    uint32_t val = 0;
    size *= 8;
    for (i = 0; i < size; i += 8)
-      val |= *data++ << i;
+      val |= (uint32_t)*data++ << i;
 
    return val;
 }
 
-bool zlib_inflate_data_to_file(const char *path, const uint8_t *cdata,
-      uint32_t csize, uint32_t size, uint32_t crc32)
+// Output is checksummed a chunk at a time, right after inflate wrote it and while it is still in cache.
+#define ZLIB_INFLATE_CHUNK (32 * 1024)
+
+// Inflates, or copies for stored entries, into out and computes the CRC32 of the result on the way.
+static bool zlib_inflate_entry(const uint8_t *cdata, unsigned cmode,
+      uint32_t csize, uint32_t size, uint8_t *out, uint32_t *crc32_out)
 {
-   bool ret = true;
-   uint8_t *out_data = (uint8_t*)malloc(size);
-   if (!out_data)
+   uint32_t crc = 0;
+
+   if (cmode == 0)
+   {
+      if (csize < size)
+         return false;
+      memcpy(out, cdata, size);
+      *crc32_out = crc32_update(crc, out, size);
+      return true;
+   }
+   else if (cmode != 8)
       return false;
 
-   uint32_t real_crc32 = 0;
    z_stream stream = {0};
+   int zret = Z_OK;
 
    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
-      GOTO_END_ERROR();
+      return false;
 
-   stream.next_in = (uint8_t*)cdata;
+   stream.next_in  = (uint8_t*)cdata;
    stream.avail_in = csize;
-   stream.next_out = out_data;
-   stream.avail_out = size;
+   stream.next_out = out;
 
-   if (inflate(&stream, Z_FINISH) != Z_STREAM_END)
+   while (zret == Z_OK)
    {
-      inflateEnd(&stream);
-      GOTO_END_ERROR();
+      uint8_t *chunk = stream.next_out;
+      uint32_t left = size - (uint32_t)(stream.next_out - out);
+
+      stream.avail_out = left < ZLIB_INFLATE_CHUNK ? left : ZLIB_INFLATE_CHUNK;
+      zret = inflate(&stream, stream.avail_out == left ? Z_FINISH : Z_NO_FLUSH);
+      crc = crc32_update(crc, chunk, stream.next_out - chunk);
+
+      if (zret == Z_BUF_ERROR && stream.avail_out == 0 && stream.next_out < out + size)
+         zret = Z_OK; // Chunk filled up, more to come.
    }
+
    inflateEnd(&stream);
+   if (zret != Z_STREAM_END || stream.total_out != size)
+      return false;
+
+   *crc32_out = crc;
+   return true;
+}
 
-   real_crc32 = crc32_calculate(out_data, size);
+static void zlib_check_crc32(uint32_t real_crc32, uint32_t crc32)
+{
    if (real_crc32 != crc32)
       RARCH_WARN("File CRC differs from ZIP CRC. File: 0x%x, ZIP: 0x%x.\n",
             (unsigned)real_crc32, (unsigned)crc32);
+}
+
+bool zlib_inflate_data_to_file(const char *path, const uint8_t *cdata,
+      uint32_t csize, uint32_t size, uint32_t crc32)
+{
+   bool ret = true;
+   uint32_t real_crc32 = 0;
+   uint8_t *out_data = (uint8_t*)malloc(size);
+   if (!out_data)
+      return false;
+
+   if (!zlib_inflate_entry(cdata, 8, csize, size, out_data, &real_crc32))
+      GOTO_END_ERROR();
+
+   zlib_check_crc32(real_crc32, crc32);
 
    if (!write_file(path, out_data, size))
       GOTO_END_ERROR();
@@ -152,77 +205,295 @@ end:
    return ret;
 }
 
-bool zlib_parse_file(const char *file, zlib_file_cb file_cb, void *userdata)
+// Parsed central directory. Entry names point into names.
+struct zlib_dir_entry
 {
-   const uint8_t *footer = NULL;
-   const uint8_t *directory = NULL;
+   const char *name;
+   unsigned cmode;
+   uint32_t crc32;
+   uint32_t csize;
+   uint32_t size;
+   uint32_t offset; // Of the local header.
+};
 
-   bool ret = true;
-   const uint8_t *data = NULL;
+struct zlib_dir
+{
+   struct zlib_dir_entry *entries;
+   size_t count;
+   char *names;
+};
 
-   const struct zlib_file_backend *backend = zlib_get_default_file_backend();
-   if (!backend)
-      return NULL;
+static void zlib_dir_free(struct zlib_dir *dir)
+{
+   if (!dir)
+      return;
+   free(dir->entries);
+   free(dir->names);
+   free(dir);
+}
 
-   ssize_t zip_size = 0;
-   void *handle = backend->open(file);
-   if (!handle)
-      GOTO_END_ERROR();
+// The end of central directory record is 22 bytes, followed by a comment of up to 64 KB.
+#define ZLIB_EOCD_SIZE 22
+#define ZLIB_EOCD_MAX_SEARCH (ZLIB_EOCD_SIZE + 0xffff)
 
-   zip_size = backend->size(handle);
-   if (zip_size < 22)
+static struct zlib_dir *zlib_dir_parse(const struct zlib_file_backend *backend, void *handle)
+{
+   bool ret = true;
+   struct zlib_dir *dir = NULL;
+   uint8_t *tail = NULL, *cd = NULL;
+   const uint8_t *footer = NULL, *directory = NULL, *cd_end = NULL;
+   size_t zip_size = backend->size(handle);
+   size_t tail_size, footer_offset, entries = 0;
+   uint32_t cd_offset, cd_size;
+   char *names = NULL;
+
+   if (zip_size < ZLIB_EOCD_SIZE)
       GOTO_END_ERROR();
 
-   data = backend->data(handle);
+   // Only the tail of the archive is needed to find the central directory.
+   tail_size = zip_size < ZLIB_EOCD_MAX_SEARCH ? zip_size : ZLIB_EOCD_MAX_SEARCH;
+   tail = (uint8_t*)malloc(tail_size);
+   if (!tail || !backend->read(handle, zip_size - tail_size, tail, tail_size))
+      GOTO_END_ERROR();
 
-   footer = data + zip_size - 22;
-   for (;; footer--)
+   for (footer = tail + tail_size - ZLIB_EOCD_SIZE;; footer--)
    {
-      if (footer <= data + 22)
-         GOTO_END_ERROR();
       if (read_le(footer, 4) == 0x06054b50)
       {
          unsigned comment_len = read_le(footer + 20, 2);
-         if (footer + 22 + comment_len == data + zip_size)
+         if (footer + ZLIB_EOCD_SIZE + comment_len == tail + tail_size)
             break;
       }
+
+      if (footer == tail)
+         GOTO_END_ERROR();
    }
 
-   directory = data + read_le(footer + 16, 4);
+   footer_offset = zip_size - tail_size + (footer - tail);
+   cd_size   = read_le(footer + 12, 4);
+   cd_offset = read_le(footer + 16, 4);
+   if (cd_offset > footer_offset || cd_size > footer_offset - cd_offset)
+      GOTO_END_ERROR();
+
+   cd = (uint8_t*)malloc(cd_size + 1);
+   dir = (struct zlib_dir*)calloc(1, sizeof(*dir));
+   // Every record is at least 46 bytes, so names with terminators fit in cd_size.
+   names = (char*)malloc(cd_size + 1);
+   if (!cd || !dir || !names || !backend->read(handle, cd_offset, cd, cd_size))
+      GOTO_END_ERROR();
+
+   dir->names = names;
+   dir->entries = (struct zlib_dir_entry*)calloc(cd_size / 46 + 1, sizeof(*dir->entries));
+   if (!dir->entries)
+      GOTO_END_ERROR();
 
-   for (;;)
+   directory = cd;
+   cd_end    = cd + cd_size;
+   while (cd_end - directory >= 46)
    {
       uint32_t signature = read_le(directory + 0, 4);
       if (signature != 0x02014b50)
          break;
 
-      unsigned cmode = read_le(directory + 10, 2);
-      uint32_t crc32 = read_le(directory + 16, 4);
-      uint32_t csize = read_le(directory + 20, 4);
-      uint32_t size  = read_le(directory + 24, 4);
-
+      struct zlib_dir_entry *entry = &dir->entries[entries];
       unsigned namelength    = read_le(directory + 28, 2);
       unsigned extralength   = read_le(directory + 30, 2);
       unsigned commentlength = read_le(directory + 32, 2);
+      size_t record_size     = 46 + namelength + extralength + commentlength;
 
-      char filename[PATH_MAX] = {0};
-      if (namelength >= PATH_MAX)
+      if (namelength >= PATH_MAX || record_size > (size_t)(cd_end - directory))
          GOTO_END_ERROR();
 
-      memcpy(filename, directory + 46, namelength);
+      entry->cmode  = read_le(directory + 10, 2);
+      entry->crc32  = read_le(directory + 16, 4);
+      entry->csize  = read_le(directory + 20, 4);
+      entry->size   = read_le(directory + 24, 4);
+      entry->offset = read_le(directory + 42, 4);
 
-      uint32_t offset   = read_le(directory + 42, 4);
-      unsigned offsetNL = read_le(data + offset + 26, 2);
-      unsigned offsetEL = read_le(data + offset + 28, 2);
+      memcpy(names, directory + 46, namelength);
+      names[namelength] = '\0';
+      entry->name = names;
+      names += namelength + 1;
 
-      const uint8_t *cdata = data + offset + 30 + offsetNL + offsetEL;
+      entries++;
+      directory += record_size;
+   }
 
-      //RARCH_LOG("OFFSET: %u, CSIZE: %u, SIZE: %u.\n", offset + 30 + offsetNL + offsetEL, csize, size);
+   dir->count = entries;
 
-      if (!file_cb(filename, cdata, cmode, csize, size, crc32, userdata))
-         break;
+end:
+   free(tail);
+   free(cd);
+   if (!ret)
+   {
+      if (!dir || !dir->names)
+         free(names);
+      zlib_dir_free(dir);
+      return NULL;
+   }
+   return dir;
+}
+
+// Reads the compressed data of an entry. The local header is only looked at here,
+// as its extra field can differ from the one in the central directory.
+static uint8_t *zlib_read_entry(const struct zlib_file_backend *backend, void *handle,
+      const struct zlib_dir_entry *entry)
+{
+   uint8_t header[30];
+   uint8_t *cdata;
+   size_t offset;
+
+   if (!backend->read(handle, entry->offset, header, sizeof(header)) ||
+         read_le(header, 4) != 0x04034b50)
+      return NULL;
 
-      directory += 46 + namelength + extralength + commentlength;
+   offset = (size_t)entry->offset + sizeof(header) + read_le(header + 26, 2) + read_le(header + 28, 2);
+   cdata = (uint8_t*)malloc(entry->csize ? entry->csize : 1);
+   if (cdata && !backend->read(handle, offset, cdata, entry->csize))
+   {
+      free(cdata);
+      return NULL;
+   }
+
+   return cdata;
+}
+
+// Parsed directories of recently opened archives, validated by size and mtime.
+// Listing an archive a second time only costs a stat().
+#define ZLIB_DIR_CACHE_SIZE 4
+
+struct zlib_dir_cache_entry
+{
+   char *path;
+   time_t mtime;
+   off_t size;
+   unsigned last_use;
+   struct zlib_dir *dir;
+};
+
+static struct
+{
+   struct zlib_dir_cache_entry entries[ZLIB_DIR_CACHE_SIZE];
+   unsigned use_count;
+} zlib_dir_cache;
+
+static void zlib_dir_cache_entry_free(struct zlib_dir_cache_entry *entry)
+{
+   free(entry->path);
+   zlib_dir_free(entry->dir);
+   memset(entry, 0, sizeof(*entry));
+}
+
+void zlib_dir_cache_free(void)
+{
+   unsigned i;
+   for (i = 0; i < ZLIB_DIR_CACHE_SIZE; i++)
+      zlib_dir_cache_entry_free(&zlib_dir_cache.entries[i]);
+   zlib_dir_cache.use_count = 0;
+}
+
+// The directory stays owned by the cache, and is valid until the next call.
+static const struct zlib_dir *zlib_dir_get(const char *path)
+{
+   unsigned i;
+   struct stat buf;
+   void *handle;
+   char *path_copy;
+   struct zlib_dir *dir;
+   struct zlib_dir_cache_entry *entry = NULL;
+   const struct zlib_file_backend *backend = zlib_get_default_file_backend();
+
+   if (stat(path, &buf) < 0)
+   {
+      RARCH_ERR("Failed to open archive: %s.\n", path);
+      return NULL;
+   }
+
+   for (i = 0; i < ZLIB_DIR_CACHE_SIZE; i++)
+   {
+      struct zlib_dir_cache_entry *cached = &zlib_dir_cache.entries[i];
+      if (!cached->dir || strcmp(cached->path, path) != 0)
+         continue;
+
+      if (cached->mtime == buf.st_mtime && cached->size == buf.st_size)
+      {
+         cached->last_use = ++zlib_dir_cache.use_count;
+         return cached->dir;
+      }
+
+      entry = cached;
+      break;
+   }
+
+   handle = backend->open(path);
+   if (!handle)
+      return NULL;
+   dir = zlib_dir_parse(backend, handle);
+   backend->free(handle);
+   if (!dir)
+      return NULL;
+
+   path_copy = strdup(path);
+   if (!path_copy)
+   {
+      zlib_dir_free(dir);
+      return NULL;
+   }
+
+   if (!entry)
+   {
+      entry = &zlib_dir_cache.entries[0];
+      for (i = 1; i < ZLIB_DIR_CACHE_SIZE; i++)
+      {
+         if (zlib_dir_cache.entries[i].last_use < entry->last_use)
+            entry = &zlib_dir_cache.entries[i];
+      }
+   }
+
+   zlib_dir_cache_entry_free(entry);
+   entry->path     = path_copy;
+   entry->mtime    = buf.st_mtime;
+   entry->size     = buf.st_size;
+   entry->last_use = ++zlib_dir_cache.use_count;
+   entry->dir      = dir;
+   return dir;
+}
+
+// Returns true if the entry's data should be read and passed to file_cb.
+typedef bool (*zlib_filter_cb)(const char *name, void *userdata);
+
+// Calls file_cb for the entries passing filter_cb. Data is read one entry at a time, right before file_cb.
+static bool zlib_parse_file_filtered(const char *file, zlib_filter_cb filter_cb,
+      zlib_file_cb file_cb, void *userdata)
+{
+   size_t i;
+   bool ret = true;
+   void *handle = NULL;
+   const struct zlib_file_backend *backend = zlib_get_default_file_backend();
+   const struct zlib_dir *dir = zlib_dir_get(file);
+   if (!dir)
+      GOTO_END_ERROR();
+
+   for (i = 0; i < dir->count; i++)
+   {
+      bool more;
+      uint8_t *cdata;
+      const struct zlib_dir_entry *entry = &dir->entries[i];
+
+      if (filter_cb && !filter_cb(entry->name, userdata))
+         continue;
+
+      if (!handle && !(handle = backend->open(file)))
+         GOTO_END_ERROR();
+
+      cdata = zlib_read_entry(backend, handle, entry);
+      if (!cdata)
+         GOTO_END_ERROR();
+
+      more = file_cb(entry->name, cdata, entry->cmode, entry->csize, entry->size, entry->crc32, userdata);
+      free(cdata);
+      if (!more)
+         break;
    }
 
 end:
@@ -231,31 +502,72 @@ end:
    return ret;
 }
 
+bool zlib_parse_file(const char *file, zlib_file_cb file_cb, void *userdata)
+{
+   return zlib_parse_file_filtered(file, NULL, file_cb, userdata);
+}
+
 struct zip_extract_userdata
 {
    char *zip_path;
    size_t zip_path_size;
    struct string_list *ext;
    bool found_rom;
+
+   // Set to extract into memory instead of next to the ZIP.
+   bool to_memory;
+   void *buf;
+   size_t size;
+   uint32_t crc32;
 };
 
+static bool zip_extract_filter_cb(const char *name, void *userdata)
+{
+   struct zip_extract_userdata *data = (struct zip_extract_userdata*)userdata;
+   const char *ext = path_get_extension(name);
+   return ext && string_list_find_elem(data->ext, ext);
+}
+
 static bool zip_extract_cb(const char *name, const uint8_t *cdata, unsigned cmode, uint32_t csize, uint32_t size,
       uint32_t crc32, void *userdata)
 {
    struct zip_extract_userdata *data = (struct zip_extract_userdata*)userdata;
 
-   // Extract first ROM that matches our list.
-   const char *ext = path_get_extension(name);
-   if (ext && string_list_find_elem(data->ext, ext))
+   // Extract first ROM that matches our list. Only matching entries are read.
+   if (zip_extract_filter_cb(name, userdata))
    {
       char new_path[PATH_MAX];
       fill_pathname_resolve_relative(new_path, data->zip_path,
             path_basename(name), sizeof(new_path));
 
+      if (data->to_memory)
+      {
+         // NUL terminated like read_file().
+         uint8_t *buf = (uint8_t*)malloc(size + 1);
+         if (!buf)
+            return false;
+
+         if (!zlib_inflate_entry(cdata, cmode, csize, size, buf, &data->crc32))
+         {
+            free(buf);
+            return false;
+         }
+         buf[size] = '\0';
+         zlib_check_crc32(data->crc32, crc32);
+
+         data->buf  = buf;
+         data->size = size;
+         strlcpy(data->zip_path, new_path, data->zip_path_size);
+         data->found_rom = true;
+         return false;
+      }
+
       switch (cmode)
       {
          case 0: // Uncompressed
             data->found_rom = write_file(new_path, cdata, size);
+            if (data->found_rom)
+               strlcpy(data->zip_path, new_path, data->zip_path_size);
             return false;
 
          case 8: // Deflate
@@ -276,10 +588,10 @@ static bool zip_extract_cb(const char *name, const uint8_t *cdata, unsigned cmod
    return true;
 }
 
-bool zlib_extract_first_rom(char *zip_path, size_t zip_path_size, const char *valid_exts)
+static bool zlib_extract_first_rom_internal(struct zip_extract_userdata *userdata,
+      char *zip_path, size_t zip_path_size, const char *valid_exts)
 {
    bool ret;
-   struct zip_extract_userdata userdata = {0};
    struct string_list *list;
 
    if (!valid_exts)
@@ -293,17 +605,17 @@ bool zlib_extract_first_rom(char *zip_path, size_t zip_path_size, const char *va
    if (!list)
       GOTO_END_ERROR();
 
-   userdata.zip_path = zip_path;
-   userdata.zip_path_size = zip_path_size;
-   userdata.ext = list;
+   userdata->zip_path = zip_path;
+   userdata->zip_path_size = zip_path_size;
+   userdata->ext = list;
 
-   if (!zlib_parse_file(zip_path, zip_extract_cb, &userdata))
+   if (!zlib_parse_file_filtered(zip_path, zip_extract_filter_cb, zip_extract_cb, userdata))
    {
       RARCH_ERR("Parsing ZIP failed.\n");
       GOTO_END_ERROR();
    }
 
-   if (!userdata.found_rom)
+   if (!userdata->found_rom)
    {
       RARCH_ERR("Didn't find any ROMS that matched valid extensions for libretro implementation.\n");
       GOTO_END_ERROR();
@@ -315,34 +627,55 @@ end:
    return ret;
 }
 
-static bool zlib_get_file_list_cb(const char *path, const uint8_t *cdata, unsigned cmode,
-      uint32_t csize, uint32_t size,
-      uint32_t crc32, void *userdata)
+bool zlib_extract_first_rom(char *zip_path, size_t zip_path_size, const char *valid_exts)
 {
-   (void)cdata;
-   (void)cmode;
-   (void)csize;
-   (void)size;
-   (void)crc32;
-   struct string_list *list = (struct string_list*)userdata;
-   union string_list_elem_attr attr;
-   memset(&attr, 0, sizeof(attr));
-   return string_list_append(list, path, attr);
+   struct zip_extract_userdata userdata = {0};
+   return zlib_extract_first_rom_internal(&userdata, zip_path, zip_path_size, valid_exts);
+}
+
+bool zlib_extract_first_rom_to_memory(char *zip_path, size_t zip_path_size, const char *valid_exts,
+      void **buf, size_t *size, uint32_t *crc32)
+{
+   struct zip_extract_userdata userdata = {0};
+   userdata.to_memory = true;
+
+   if (!zlib_extract_first_rom_internal(&userdata, zip_path, zip_path_size, valid_exts))
+   {
+      free(userdata.buf);
+      return false;
+   }
+
+   *buf   = userdata.buf;
+   *size  = userdata.size;
+   *crc32 = userdata.crc32;
+   return true;
 }
 
 struct string_list *zlib_get_file_list(const char *path)
 {
-   struct string_list *list = string_list_new();
+   size_t i;
+   union string_list_elem_attr attr;
+   struct string_list *list;
+   const struct zlib_dir *dir = zlib_dir_get(path);
+   if (!dir)
+   {
+      RARCH_ERR("Parsing ZIP failed.\n");
+      return NULL;
+   }
+
+   list = string_list_new_arena();
    if (!list)
       return NULL;
 
-   if (!zlib_parse_file(path, zlib_get_file_list_cb, list))
+   memset(&attr, 0, sizeof(attr));
+   for (i = 0; i < dir->count; i++)
    {
-      RARCH_ERR("Parsing ZIP failed.\n");
-      string_list_free(list);
-      return NULL;
+      if (!string_list_append(list, dir->entries[i].name, attr))
+      {
+         string_list_free(list);
+         return NULL;
+      }
    }
-   else
-      return list;
-}
 
+   return list;
+}
@@ -27,11 +27,20 @@ typedef bool (*zlib_file_cb)(const char *name,
       uint32_t crc32, void *userdata);
 
 // Low-level file parsing. Enumerates over all files and calls file_cb with userdata.
+// Only the central directory is read up front. Entry data is read as each file_cb is called.
 bool zlib_parse_file(const char *file, zlib_file_cb file_cb, void *userdata);
 
 // Built with zlib_parse_file.
 bool zlib_extract_first_rom(char *zip_path, size_t zip_path_size, const char *valid_exts);
+// Like zlib_extract_first_rom(), but inflates into a malloc()-ed buffer instead of a file.
+// zip_path is still set to where the ROM would have been extracted to.
+// crc32 is computed while inflating.
+bool zlib_extract_first_rom_to_memory(char *zip_path, size_t zip_path_size, const char *valid_exts,
+      void **buf, size_t *size, uint32_t *crc32);
+// Served from the central directory alone. Directories of recently used archives are cached.
 struct string_list *zlib_get_file_list(const char *path);
+// Frees the cached directories.
+void zlib_dir_cache_free(void);
 
 bool zlib_inflate_data_to_file(const char *path, const uint8_t *data,
       uint32_t csize, uint32_t size, uint32_t crc32);
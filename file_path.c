@@ -124,6 +124,11 @@ error:
    return false;
 }
 
+static bool string_list_in_arena(const struct string_list *list, const char *data)
+{
+   return list->arena && data >= list->arena && data < list->arena + list->arena_size;
+}
+
 void string_list_free(struct string_list *list)
 {
    size_t i;
@@ -131,8 +136,12 @@ void string_list_free(struct string_list *list)
       return;
 
    for (i = 0; i < list->size; i++)
-      free(list->elems[i].data);
+   {
+      if (!string_list_in_arena(list, list->elems[i].data))
+         free(list->elems[i].data);
+   }
    free(list->elems);
+   free(list->arena);
    free(list);
 }
 
@@ -146,6 +155,54 @@ static bool string_list_capacity(struct string_list *list, size_t cap)
 
    list->elems = new_data;
    list->cap   = cap;
+   list->allocs++;
+   return true;
+}
+
+// Appends a copy of str to the arena of the list, moving arena backed elements along when it grows.
+static bool string_list_append_arena(struct string_list *list, const char *str, size_t len,
+      union string_list_elem_attr attr)
+{
+   size_t i;
+
+   if (list->size >= list->cap &&
+         !string_list_capacity(list, list->cap * 2))
+      return false;
+
+   if (list->arena_size + len + 1 > list->arena_cap)
+   {
+      size_t cap = list->arena_cap ? list->arena_cap * 2 : 4096;
+      while (cap < list->arena_size + len + 1)
+         cap *= 2;
+
+      uintptr_t old_arena = (uintptr_t)list->arena;
+      char *arena = (char*)realloc(list->arena, cap);
+      if (!arena)
+         return false;
+
+      if ((uintptr_t)arena != old_arena)
+      {
+         for (i = 0; i < list->size; i++)
+         {
+            uintptr_t data = (uintptr_t)list->elems[i].data;
+            if (old_arena && data >= old_arena && data < old_arena + list->arena_size)
+               list->elems[i].data = arena + (data - old_arena);
+         }
+      }
+
+      list->arena     = arena;
+      list->arena_cap = cap;
+      list->allocs++;
+   }
+
+   char *data = list->arena + list->arena_size;
+   memcpy(data, str, len);
+   data[len] = '\0';
+   list->arena_size += len + 1;
+
+   list->elems[list->size].data = data;
+   list->elems[list->size].attr = attr;
+   list->size++;
    return true;
 }
 
@@ -155,6 +212,7 @@ struct string_list *string_list_new(void)
    if (!list)
       return NULL;
 
+   list->allocs = 1;
    if (!string_list_capacity(list, 32))
    {
       string_list_free(list);
@@ -164,8 +222,19 @@ struct string_list *string_list_new(void)
    return list;
 }
 
+struct string_list *string_list_new_arena(void)
+{
+   struct string_list *list = string_list_new();
+   if (list)
+      list->arena_backed = true;
+   return list;
+}
+
 bool string_list_append(struct string_list *list, const char *elem, union string_list_elem_attr attr)
 {
+   if (list->arena_backed)
+      return string_list_append_arena(list, elem, strlen(elem), attr);
+
    if (list->size >= list->cap &&
          !string_list_capacity(list, list->cap * 2))
       return false;
@@ -173,6 +242,7 @@ bool string_list_append(struct string_list *list, const char *elem, union string
    char *dup = strdup(elem);
    if (!dup)
       return false;
+   list->allocs++;
 
    list->elems[list->size].data = dup;
    list->elems[list->size].attr = attr;
@@ -202,7 +272,7 @@ struct string_list *string_split(const char *str, const char *delim)
    char *copy      = NULL;
    const char *tmp = NULL;
 
-   struct string_list *list = string_list_new();
+   struct string_list *list = string_list_new_arena();
    if (!list)
       goto error;
 
@@ -305,93 +375,530 @@ static int qstrcmp_dir(const void *a_, const void *b_)
       return strcasecmp(a->data, b->data);
 }
 
+static inline char ascii_tolower(char c)
+{
+   return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+struct dir_list_sort_key
+{
+   uint64_t prefix; // First 8 folded bytes, big endian, so integer order is string order.
+   const char *rest; // Folded bytes after the prefix.
+   size_t index;
+   bool dir;
+};
+
+static int dir_list_sort_key_cmp(const struct dir_list_sort_key *a, const struct dir_list_sort_key *b)
+{
+   if (a->prefix != b->prefix)
+      return a->prefix < b->prefix ? -1 : 1;
+
+   // Equal prefixes which end early mean equal strings, and both rests are empty.
+   int ret = strcmp(a->rest, b->rest);
+   if (ret)
+      return ret;
+
+   // Keeps the order of entries which only differ in case stable.
+   return a->index < b->index ? -1 : (a->index > b->index);
+}
+
+static int dir_list_sort_plain(const void *a_, const void *b_)
+{
+   return dir_list_sort_key_cmp((const struct dir_list_sort_key*)a_, (const struct dir_list_sort_key*)b_);
+}
+
+static int dir_list_sort_dir(const void *a_, const void *b_)
+{
+   const struct dir_list_sort_key *a = (const struct dir_list_sort_key*)a_;
+   const struct dir_list_sort_key *b = (const struct dir_list_sort_key*)b_;
+
+   // Sort directories before files.
+   if (a->dir != b->dir)
+      return b->dir - a->dir;
+   return dir_list_sort_key_cmp(a, b);
+}
+
+// Folds every element once up front, instead of strcasecmp() folding both sides of every comparison.
+// The shared directory prefix is skipped, so most comparisons are decided by the integer prefix alone.
 void dir_list_sort(struct string_list *list, bool dir_first)
 {
-   if (!list)
+   size_t i, j, skip, total = 0;
+   struct dir_list_sort_key *keys = NULL;
+   struct string_list_elem *sorted = NULL;
+   char *folded = NULL, *ptr;
+
+   if (!list || list->size < 2)
       return;
 
-   qsort(list->elems, list->size, sizeof(struct string_list_elem),
-         dir_first ? qstrcmp_dir : qstrcmp_plain);
+   skip = strlen(list->elems[0].data);
+   for (i = 1; i < list->size; i++)
+   {
+      const char *a = list->elems[0].data;
+      const char *b = list->elems[i].data;
+      for (j = 0; j < skip && ascii_tolower(a[j]) == ascii_tolower(b[j]); j++);
+      skip = j;
+   }
+
+   for (i = 0; i < list->size; i++)
+      total += strlen(list->elems[i].data + skip) + 1;
+
+   keys   = (struct dir_list_sort_key*)malloc(list->size * sizeof(*keys));
+   sorted = (struct string_list_elem*)malloc(list->size * sizeof(*sorted));
+   folded = (char*)malloc(total);
+   if (!keys || !sorted || !folded)
+   {
+      qsort(list->elems, list->size, sizeof(struct string_list_elem),
+            dir_first ? qstrcmp_dir : qstrcmp_plain);
+      goto end;
+   }
+
+   ptr = folded;
+   for (i = 0; i < list->size; i++)
+   {
+      const char *src = list->elems[i].data + skip;
+      uint64_t prefix = 0;
+
+      for (j = 0; src[j]; j++)
+         ptr[j] = ascii_tolower(src[j]);
+      ptr[j] = '\0';
+
+      for (j = 0; j < 8; j++)
+         prefix = (prefix << 8) | (uint8_t)(ptr[0] ? *ptr++ : 0);
+
+      keys[i].prefix = prefix;
+      keys[i].rest   = ptr;
+      keys[i].index  = i;
+      keys[i].dir    = list->elems[i].attr.b;
+      ptr += strlen(ptr) + 1;
+   }
+
+   qsort(keys, list->size, sizeof(*keys), dir_first ? dir_list_sort_dir : dir_list_sort_plain);
+
+   for (i = 0; i < list->size; i++)
+      sorted[i] = list->elems[keys[i].index];
+   memcpy(list->elems, sorted, list->size * sizeof(*sorted));
+
+end:
+   free(keys);
+   free(sorted);
+   free(folded);
 }
 
-static bool dirent_is_directory(const char *path, const struct dirent *entry)
+// Returns 1 for directories, 0 for anything else and -1 when the file system does not tell.
+static int dirent_type(const struct dirent *entry)
 {
 #ifdef DT_DIR
    if (entry->d_type == DT_DIR)
-      return true;
+      return 1;
    else if (entry->d_type == DT_UNKNOWN // This can happen on certain file systems.
          || entry->d_type == DT_LNK)
-      return path_is_directory(path);
+      return -1;
    else
-      return false;
+      return 0;
 #else // dirent struct doesn't have d_type, do it the slow way ...
-   return path_is_directory(path);
+   return -1;
 #endif
 }
 
-struct string_list *dir_list_new(const char *dir, const char *ext, bool include_dirs)
+static bool dir_list_ext_match(const struct string_list *ext_list, const char *name)
 {
-   struct string_list *list = string_list_new();
-   if (!list)
-      return NULL;
+   size_t i;
+   char ext[32];
+   const char *file_ext = strrchr(name, '.');
 
-   DIR *directory = NULL;
-   const struct dirent *entry = NULL;
+   if (!file_ext || strlcpy(ext, file_ext + 1, sizeof(ext)) >= sizeof(ext))
+      return false;
 
-   struct string_list *ext_list = NULL;
+   for (i = 0; ext[i]; i++)
+      ext[i] = ascii_tolower(ext[i]);
+
+   for (i = 0; i < ext_list->size; i++)
+   {
+      const char *elem = ext_list->elems[i].data;
+      if (*elem == *ext && strcmp(elem, ext) == 0)
+         return true;
+   }
+
+   return false;
+}
+
+struct dir_list_stream
+{
+   DIR *directory;
+   struct string_list *ext_list;
+   bool include_dirs;
+   char path[PATH_MAX];
+   size_t dir_len;
+};
+
+dir_list_stream_t *dir_list_stream_new(const char *dir, const char *ext, bool include_dirs)
+{
+   size_t i;
+   dir_list_stream_t *stream = (dir_list_stream_t*)calloc(1, sizeof(*stream));
+   if (!stream)
+      return NULL;
+
+   // Extensions are matched against the file names folded to lower case, without leading '.'.
    if (ext)
-      ext_list = string_split(ext, "|");
+   {
+      stream->ext_list = string_split(ext, "|");
+      if (!stream->ext_list)
+         goto error;
 
-   directory = opendir(dir);
-   if (!directory)
+      for (i = 0; i < stream->ext_list->size; i++)
+      {
+         char *elem = stream->ext_list->elems[i].data;
+         if (*elem == '.')
+            memmove(elem, elem + 1, strlen(elem));
+         for (; *elem; elem++)
+            *elem = ascii_tolower(*elem);
+      }
+   }
+
+   stream->include_dirs = include_dirs;
+   fill_pathname_join(stream->path, dir, "", sizeof(stream->path));
+   stream->dir_len = strlen(stream->path);
+
+   stream->directory = opendir(dir);
+   if (!stream->directory)
       goto error;
 
-   while ((entry = readdir(directory)))
+   return stream;
+
+error:
+   RARCH_ERR("Failed to open directory: \"%s\"\n", dir);
+   dir_list_stream_free(stream);
+   return NULL;
+}
+
+int dir_list_stream_read(dir_list_stream_t *stream, struct string_list *list, size_t max)
+{
+   const struct dirent *entry = NULL;
+   size_t dir_len = stream->dir_len;
+   size_t read = 0;
+
+   while (read < max && (entry = readdir(stream->directory)))
    {
-      const char *name     = entry->d_name;
-      const char *file_ext = path_get_extension(name);
+      const char *name = entry->d_name;
+      if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
+         continue;
 
-      char file_path[PATH_MAX];
-      fill_pathname_join(file_path, dir, name, sizeof(file_path));
+      int type = dirent_type(entry);
+      bool ext_match = !stream->ext_list || dir_list_ext_match(stream->ext_list, name);
 
-      bool is_dir = dirent_is_directory(file_path, entry);
-      if (!include_dirs && is_dir)
+      // Anything that would be filtered out whatever it is needs no stat().
+      if ((type == 0 || (type < 0 && !stream->include_dirs)) && !ext_match)
+         continue;
+      if (type == 1 && !stream->include_dirs)
          continue;
 
-      if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
+      size_t name_len = strlcpy(stream->path + dir_len, name, sizeof(stream->path) - dir_len);
+      if (name_len >= sizeof(stream->path) - dir_len)
          continue;
 
-      if (!is_dir && ext_list && !string_list_find_elem_prefix(ext_list, ".", file_ext))
+      bool is_dir = type < 0 ? path_is_directory(stream->path) : type;
+      if (!stream->include_dirs && is_dir)
+         continue;
+      if (!is_dir && !ext_match)
          continue;
 
       union string_list_elem_attr attr;
       attr.b = is_dir;
-
-      if (!string_list_append(list, file_path, attr))
-         goto error;
+      if (!string_list_append_arena(list, stream->path, dir_len + name_len, attr))
+         return -1;
+      read++;
    }
 
-   closedir(directory);
+   return entry != NULL;
+}
 
-   string_list_free(ext_list);
-   return list;
+void dir_list_stream_free(dir_list_stream_t *stream)
+{
+   if (!stream)
+      return;
 
-error:
-   RARCH_ERR("Failed to open directory: \"%s\"\n", dir);
+   if (stream->directory)
+      closedir(stream->directory);
+   string_list_free(stream->ext_list);
+   free(stream);
+}
+
+struct string_list *dir_list_new(const char *dir, const char *ext, bool include_dirs)
+{
+   struct string_list *list = NULL;
+   dir_list_stream_t *stream = dir_list_stream_new(dir, ext, include_dirs);
+   if (!stream)
+      return NULL;
 
-   if (directory)
-      closedir(directory);
+   list = string_list_new_arena();
+   if (!list)
+      goto error;
+
+   if (dir_list_stream_read(stream, list, (size_t)-1) < 0)
+      goto error;
 
+   dir_list_stream_free(stream);
+   return list;
+
+error:
+   RARCH_ERR("Failed to list directory: \"%s\"\n", dir);
+   dir_list_stream_free(stream);
    string_list_free(list);
-   string_list_free(ext_list);
    return NULL;
 }
 
+// Same order as dir_list_sort(list, true).
+static int dir_list_elem_cmp(const struct string_list_elem *a, const struct string_list_elem *b)
+{
+   const char *a_str = a->data;
+   const char *b_str = b->data;
+
+   if (a->attr.b != b->attr.b)
+      return b->attr.b - a->attr.b;
+
+   while (*a_str && ascii_tolower(*a_str) == ascii_tolower(*b_str))
+   {
+      a_str++;
+      b_str++;
+   }
+
+   return (uint8_t)ascii_tolower(*a_str) - (uint8_t)ascii_tolower(*b_str);
+}
+
+bool dir_list_merge(struct string_list *list, const struct string_list *batch)
+{
+   size_t i, j, k, lo, hi, mid = list->size;
+   struct string_list_elem *left = NULL;
+
+   for (i = 0; i < batch->size; i++)
+   {
+      if (!string_list_append_arena(list, batch->elems[i].data, strlen(batch->elems[i].data),
+               batch->elems[i].attr))
+         return false;
+   }
+
+   if (!mid || !batch->size)
+      return true;
+
+   // Entries before the first new one stay where they are.
+   lo = 0;
+   hi = mid;
+   while (lo < hi)
+   {
+      size_t pivot = lo + (hi - lo) / 2;
+      if (dir_list_elem_cmp(&list->elems[pivot], &list->elems[mid]) <= 0)
+         lo = pivot + 1;
+      else
+         hi = pivot;
+   }
+
+   if (lo == mid)
+      return true;
+
+   left = (struct string_list_elem*)malloc((mid - lo) * sizeof(*left));
+   if (!left)
+   {
+      dir_list_sort(list, true);
+      return true;
+   }
+   memcpy(left, list->elems + lo, (mid - lo) * sizeof(*left));
+
+   for (i = 0, j = mid, k = lo; i < mid - lo; k++)
+   {
+      if (j < list->size && dir_list_elem_cmp(&list->elems[j], &left[i]) < 0)
+         list->elems[k] = list->elems[j++];
+      else
+         list->elems[k] = left[i++];
+   }
+
+   free(left);
+   return true;
+}
+
 void dir_list_free(struct string_list *list)
 {
    string_list_free(list);
 }
 
+// Copies a list, sharing a single allocation for the arena backed elements again.
+static struct string_list *dir_list_copy(const struct string_list *list)
+{
+   struct string_list *copy = (struct string_list*)calloc(1, sizeof(*copy));
+   if (!copy)
+      return NULL;
+
+   copy->elems = (struct string_list_elem*)malloc(list->cap * sizeof(*copy->elems));
+   copy->arena = list->arena_size ? (char*)malloc(list->arena_size) : NULL;
+   if (!copy->elems || (list->arena_size && !copy->arena))
+      goto error;
+
+   copy->cap          = list->cap;
+   copy->arena_size   = list->arena_size;
+   copy->arena_cap    = list->arena_size;
+   copy->arena_backed = list->arena_backed;
+   copy->allocs       = 2 + (list->arena_size ? 1 : 0);
+   if (list->arena_size)
+      memcpy(copy->arena, list->arena, list->arena_size);
+
+   for (copy->size = 0; copy->size < list->size; copy->size++)
+   {
+      const struct string_list_elem *elem = &list->elems[copy->size];
+      char *data;
+      if (string_list_in_arena(list, elem->data))
+         data = copy->arena + (elem->data - list->arena);
+      else if ((data = strdup(elem->data)))
+         copy->allocs++;
+      else
+         goto error;
+
+      copy->elems[copy->size].data = data;
+      copy->elems[copy->size].attr = elem->attr;
+   }
+
+   return copy;
+
+error:
+   string_list_free(copy);
+   return NULL;
+}
+
+#define DIR_LIST_CACHE_SIZE 4
+
+struct dir_list_cache_entry
+{
+   char *dir;
+   char *ext;
+   bool include_dirs;
+   time_t mtime;
+   unsigned last_use;
+   struct string_list *list;
+};
+
+struct dir_list_cache
+{
+   struct dir_list_cache_entry entries[DIR_LIST_CACHE_SIZE];
+   unsigned use_count;
+};
+
+static void dir_list_cache_entry_free(struct dir_list_cache_entry *entry)
+{
+   free(entry->dir);
+   free(entry->ext);
+   string_list_free(entry->list);
+   memset(entry, 0, sizeof(*entry));
+}
+
+dir_list_cache_t *dir_list_cache_new(void)
+{
+   return (dir_list_cache_t*)calloc(1, sizeof(dir_list_cache_t));
+}
+
+void dir_list_cache_free(dir_list_cache_t *cache)
+{
+   unsigned i;
+   if (!cache)
+      return;
+
+   for (i = 0; i < DIR_LIST_CACHE_SIZE; i++)
+      dir_list_cache_entry_free(&cache->entries[i]);
+   free(cache);
+}
+
+static struct dir_list_cache_entry *dir_list_cache_find(dir_list_cache_t *cache,
+      const char *dir, const char *ext, bool include_dirs)
+{
+   unsigned i;
+   for (i = 0; i < DIR_LIST_CACHE_SIZE; i++)
+   {
+      struct dir_list_cache_entry *entry = &cache->entries[i];
+      if (entry->list && entry->include_dirs == include_dirs && strcmp(entry->dir, dir) == 0 &&
+            ((!entry->ext && !ext) || (entry->ext && ext && strcmp(entry->ext, ext) == 0)))
+         return entry;
+   }
+
+   return NULL;
+}
+
+struct string_list *dir_list_cache_lookup(dir_list_cache_t *cache, const char *dir, const char *ext, bool include_dirs)
+{
+   struct stat buf;
+   struct dir_list_cache_entry *entry;
+
+   if (!cache)
+      return NULL;
+
+   entry = dir_list_cache_find(cache, dir, ext, include_dirs);
+   if (!entry)
+      return NULL;
+
+   if (stat(dir, &buf) < 0 || entry->mtime != buf.st_mtime)
+   {
+      dir_list_cache_entry_free(entry);
+      return NULL;
+   }
+
+   entry->last_use = ++cache->use_count;
+   return dir_list_copy(entry->list);
+}
+
+void dir_list_cache_store(dir_list_cache_t *cache, const char *dir, const char *ext, bool include_dirs,
+      const struct string_list *list, time_t start)
+{
+   unsigned i;
+   struct stat buf;
+   struct dir_list_cache_entry *entry;
+
+   if (!cache)
+      return;
+
+   entry = dir_list_cache_find(cache, dir, ext, include_dirs);
+
+   // A directory modified since, or within the second before, listing started might not be fully in the list.
+   if (stat(dir, &buf) < 0 || buf.st_mtime >= start)
+   {
+      if (entry)
+         dir_list_cache_entry_free(entry);
+      return;
+   }
+
+   if (!entry)
+   {
+      entry = &cache->entries[0];
+      for (i = 1; i < DIR_LIST_CACHE_SIZE; i++)
+      {
+         if (cache->entries[i].last_use < entry->last_use)
+            entry = &cache->entries[i];
+      }
+   }
+
+   dir_list_cache_entry_free(entry);
+   entry->dir          = strdup(dir);
+   entry->ext          = ext ? strdup(ext) : NULL;
+   entry->include_dirs = include_dirs;
+   entry->mtime        = buf.st_mtime;
+   entry->last_use     = ++cache->use_count;
+   entry->list         = dir_list_copy(list);
+   if (!entry->dir || (ext && !entry->ext) || !entry->list)
+      dir_list_cache_entry_free(entry);
+}
+
+struct string_list *dir_list_cache_get(dir_list_cache_t *cache, const char *dir, const char *ext, bool include_dirs)
+{
+   time_t start;
+   struct string_list *list = dir_list_cache_lookup(cache, dir, ext, include_dirs);
+   if (list)
+      return list;
+
+   start = time(NULL);
+   list  = dir_list_new(dir, ext, include_dirs);
+   if (!list)
+      return NULL;
+
+   dir_list_sort(list, true);
+   dir_list_cache_store(cache, dir, ext, include_dirs, list, start);
+   return list;
+}
+
 static bool path_char_is_slash(char c)
 {
    return c == '/';
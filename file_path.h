@@ -21,6 +21,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <sys/types.h>
+#include <time.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -49,15 +50,59 @@ struct string_list
    struct string_list_elem *elems;
    size_t size;
    size_t cap;
+
+   // Elements pointing into the arena share its allocation and are not freed individually.
+   // Arena backed lists append every element to it. Their strings move when the arena grows,
+   // so pointers to them are only valid until the next append.
+   char *arena;
+   size_t arena_size;
+   size_t arena_cap;
+   bool arena_backed;
+
+   unsigned allocs; // Heap allocations made for this list so far.
 };
 
+// Lists full paths of the entries in dir. attr.b is set for directories.
+// ext is a '|' separated list of extensions to keep. Directories are not filtered by extension.
 struct string_list *dir_list_new(const char *dir, const char *ext, bool include_dirs);
+// Case insensitive sort on ASCII, independent of locale.
 void dir_list_sort(struct string_list *list, bool dir_first);
 void dir_list_free(struct string_list *list);
+// Copies the entries of batch into list. Both must be sorted with dir_list_sort(list, true) and list stays sorted.
+bool dir_list_merge(struct string_list *list, const struct string_list *batch);
+
+// Reads a directory a few entries at a time, with the same filtering as dir_list_new().
+typedef struct dir_list_stream dir_list_stream_t;
+
+dir_list_stream_t *dir_list_stream_new(const char *dir, const char *ext, bool include_dirs);
+// Appends up to max entries to list, in directory order.
+// Returns 1 if there may be more entries, 0 once the directory is exhausted and -1 on error.
+int dir_list_stream_read(dir_list_stream_t *stream, struct string_list *list, size_t max);
+void dir_list_stream_free(dir_list_stream_t *stream);
+
+// Keeps the last few directory listings around, so going back to a directory does not read it again.
+// Entries are validated by the modification time of the directory.
+// File systems which do not update it when entries are added or removed (some FAT drivers) may show
+// stale listings until another directory pushes the entry out.
+typedef struct dir_list_cache dir_list_cache_t;
+
+dir_list_cache_t *dir_list_cache_new(void);
+// Equivalent to dir_list_new() followed by dir_list_sort(list, true).
+// The returned list is owned by the caller and freed with dir_list_free().
+struct string_list *dir_list_cache_get(dir_list_cache_t *cache, const char *dir, const char *ext, bool include_dirs);
+// The two halves of dir_list_cache_get(), for callers listing directories incrementally.
+// Returns NULL on a miss.
+struct string_list *dir_list_cache_lookup(dir_list_cache_t *cache, const char *dir, const char *ext, bool include_dirs);
+// Stores a copy of a sorted listing. start is time() from before listing began.
+void dir_list_cache_store(dir_list_cache_t *cache, const char *dir, const char *ext, bool include_dirs,
+      const struct string_list *list, time_t start);
+void dir_list_cache_free(dir_list_cache_t *cache);
 bool string_list_find_elem(const struct string_list *list, const char *elem);
 bool string_list_find_elem_prefix(const struct string_list *list, const char *prefix, const char *elem);
 struct string_list *string_split(const char *str, const char *delim);
 struct string_list *string_list_new(void);
+// A list storing its strings in a single arena, freed in one go.
+struct string_list *string_list_new_arena(void);
 bool string_list_append(struct string_list *list, const char *elem, union string_list_elem_attr attr);
 void string_list_free(struct string_list *list);
 void string_list_join_concat(char *buffer, size_t size, const struct string_list *list, const char *sep);
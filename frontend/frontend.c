@@ -19,6 +19,7 @@
 #include "../general.h"
 #include "../conf/config_file.h"
 #include "../file.h"
+#include "../input/input_common.h"
 
 #include "frontend_context.h"
 frontend_ctx_driver_t *frontend_ctx;
@@ -29,6 +30,28 @@ frontend_ctx_driver_t *frontend_ctx;
 
 default_paths_t default_paths;
 
+// Startup timing breakdown, logged once the menu is up.
+static struct
+{
+   retro_time_t start;
+   retro_time_t environment;
+   retro_time_t config;
+   retro_time_t core;
+   retro_time_t drivers;
+   retro_time_t menu;
+} startup_time;
+
+static void init_config_cache(void)
+{
+   char path[PATH_MAX];
+   if (*g_extern.config_path)
+      fill_pathname_resolve_relative(path, g_extern.config_path, "retroarch.cache", sizeof(path));
+   else
+      fill_pathname_join(path, default_paths.port_dir, "retroarch.cache", sizeof(path));
+
+   g_extern.config_cache = config_cache_new(path);
+}
+
 static void rarch_get_environment_console(char *path)
 {
    path_mkdir(default_paths.port_dir);
@@ -40,12 +63,31 @@ static void rarch_get_environment_console(char *path)
     * the correct configuration. */
    strlcpy(g_settings.libretro, path, sizeof(g_settings.libretro));
 
+   retro_time_t time = rarch_get_time_usec();
+   init_config_cache();
    config_load();
+   startup_time.config = rarch_get_time_usec() - time;
 
+   time = rarch_get_time_usec();
    init_libretro_sym(false);
    rarch_init_system_info();
+   startup_time.core = rarch_get_time_usec() - time;
 
+   time = rarch_get_time_usec();
    global_init_drivers();
+   startup_time.drivers = rarch_get_time_usec() - time;
+}
+
+static void log_startup_time(void)
+{
+   unsigned hits, misses;
+   retro_time_t total = rarch_get_time_usec() - startup_time.start;
+
+   config_cache_get_stats(g_extern.config_cache, &hits, &misses);
+   RARCH_LOG("Startup took %.1f ms: environment %.1f ms, config %.1f ms, core %.1f ms, drivers %.1f ms, menu %.1f ms.\n",
+         total / 1000.0, startup_time.environment / 1000.0, startup_time.config / 1000.0,
+         startup_time.core / 1000.0, startup_time.drivers / 1000.0, startup_time.menu / 1000.0);
+   RARCH_LOG("Config cache: %u hits, %u misses.\n", hits, misses);
 }
 
 int main_entry_iterate(int argc, char *argv[], void* args)
@@ -116,6 +158,8 @@ int main_entry_iterate(int argc, char *argv[], void* args)
       {
          g_extern.lifecycle_state &= ~(1ULL << MODE_MENU);
          driver_set_nonblock_state(driver.nonblock_state);
+         // Binds and analog D-pad modes may have been changed in the menu.
+         input_snapshot_invalidate();
 
          if (driver.audio_data && !g_settings.audio.mute && !audio_start_func())
          {
@@ -150,11 +194,16 @@ void main_exit(void)
    if (g_extern.main_is_init)
       rarch_main_deinit();
    rarch_deinit_msg_queue();
-   global_uninit_drivers();
 
 #ifdef PERF_TEST
+   // Before the video driver goes away, so its frame pacing stats are included.
    rarch_perf_log();
 #endif
+   global_uninit_drivers();
+
+#ifdef HAVE_TRACE
+   rarch_dump_trace();
+#endif
 
    if (g_extern.lifecycle_state & (1ULL << MODE_EXITSPAWN) && frontend_ctx
          && frontend_ctx->exitspawn)
@@ -163,9 +212,92 @@ void main_exit(void)
    rarch_main_clear_state();
 }
 
+#define BENCHMARK_BUCKETS 32
+
+// Headless run of --benchmark N frames. Bypasses the menu loop and platform frontend.
+// Drivers are not brought up globally beforehand, so rarch_main_init() is the first
+// to pick them and gets the null drivers from init_benchmark_settings().
+static int main_benchmark(int argc, char *argv[])
+{
+   unsigned i, frames = 0;
+   unsigned histogram[BENCHMARK_BUCKETS] = {0};
+   retro_time_t min_time = 0, max_time = 0;
+
+   if (rarch_main_init(argc, argv) != 0)
+   {
+      RARCH_ERR("Failed to initialize benchmark.\n");
+      return 1;
+   }
+
+   // rarch_main_iterate() still polls the menu toggle.
+   menu_init(driver.video_data);
+   RARCH_LOG("Benchmark drivers: video \"%s\", audio \"%s\", input \"%s\".\n",
+         driver.video ? driver.video->ident : "none", driver.audio ? driver.audio->ident : "none",
+         driver.input ? driver.input->ident : "none");
+
+   retro_time_t start = rarch_get_time_usec();
+   while (frames < g_extern.benchmark_frames)
+   {
+      retro_time_t frame_start = rarch_get_time_usec();
+      if (!rarch_main_iterate())
+         break;
+      retro_time_t delta = rarch_get_time_usec() - frame_start;
+
+      // Bucket i holds frames which took [2^(i-1), 2^i) usec.
+      unsigned bucket = 0;
+      while (bucket < BENCHMARK_BUCKETS - 1 && (delta >> bucket))
+         bucket++;
+      histogram[bucket]++;
+
+      if (!frames || delta < min_time)
+         min_time = delta;
+      if (delta > max_time)
+         max_time = delta;
+      frames++;
+   }
+   retro_time_t total = rarch_get_time_usec() - start;
+
+   // Report goes to stdout directly, RARCH_LOG is compiled out without a file logger.
+   printf("[BENCH]: %u frames in %.3f s, %.2f frames/s.\n", frames,
+         total / 1000000.0, total ? frames * 1000000.0 / total : 0.0);
+   printf("[BENCH]: Frame time min/avg/max: %lld / %lld / %lld usec.\n",
+         (long long)min_time, frames ? (long long)(total / frames) : 0LL, (long long)max_time);
+   printf("[BENCH]: Frame time histogram:\n");
+   for (i = 0; i < BENCHMARK_BUCKETS; i++)
+   {
+      if (!histogram[i])
+         continue;
+      printf("[BENCH]:    < %10llu usec: %8u (%5.1f%%)\n",
+            1ULL << i, histogram[i], 100.0 * histogram[i] / frames);
+   }
+   fflush(stdout);
+
+   if (g_extern.bsv.movie)
+      printf("[BENCH]: Movie at frame %u, %u state checksum mismatches.\n",
+            bsv_movie_get_frame(g_extern.bsv.movie), bsv_movie_get_mismatches(g_extern.bsv.movie));
+
+   rarch_perf_log();
+   retro_perf_log();
+#ifdef HAVE_TRACE
+   rarch_dump_trace();
+#endif
+
+   menu_free(driver.video_data);
+   rarch_main_deinit();
+   return 0;
+}
+
 int main(int argc, char *argv[])
 {
+   int i;
    void* args = NULL;
+   bool benchmark = false;
+
+   for (i = 1; i < argc; i++)
+      if (!strncmp(argv[i], "--benchmark", strlen("--benchmark")))
+         benchmark = true;
+
+   startup_time.start = rarch_get_time_usec();
 
    frontend_ctx = (frontend_ctx_driver_t*)frontend_ctx_init_first();
    if (frontend_ctx && frontend_ctx->init)
@@ -176,11 +308,28 @@ int main(int argc, char *argv[])
 
    if (frontend_ctx && frontend_ctx->environment_get)
    {
+      retro_time_t time = rarch_get_time_usec();
       frontend_ctx->environment_get(argc, argv, args);
-      rarch_get_environment_console(argv[0]);
+      startup_time.environment = rarch_get_time_usec() - time;
+      if (!benchmark)
+         rarch_get_environment_console(argv[0]);
    }
 
+   if (benchmark)
+   {
+      // Core path picks the core-specific config, same as a regular boot.
+      strlcpy(g_settings.libretro, argv[0], sizeof(g_settings.libretro));
+      int ret = main_benchmark(argc, argv);
+      rarch_deinit_msg_queue();
+      return ret;
+   }
+
+   retro_time_t time = rarch_get_time_usec();
    menu_init(driver.video_data);
+   startup_time.menu = rarch_get_time_usec() - time;
+
+   log_startup_time();
+   config_cache_flush(g_extern.config_cache);
 
    if (frontend_ctx && frontend_ctx->process_args)
       frontend_ctx->process_args(argc, argv, args);
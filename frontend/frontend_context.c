@@ -17,7 +17,11 @@
 #include <string.h>
 
 static const frontend_ctx_driver_t *frontend_ctx_drivers[] = {
+#if defined(HW_RVL) || defined(HW_DOL)
    &frontend_ctx_gx,
+#else
+   &frontend_ctx_null,
+#endif
    NULL // zero length array is not valid
 };
 
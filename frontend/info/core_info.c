@@ -19,6 +19,152 @@
 #include "../../file_ext.h"
 #include "../../file_extract.h"
 #include "../../config.def.h"
+#include <ctype.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_THREADS
+#include "../../thread.h"
+#endif
+
+struct core_info_ext
+{
+   char *ext; // Lowercase, without leading dot. NULL if the slot is free.
+   uint32_t hash;
+   size_t *cores; // Indices into core_info_list_t::list, ascending.
+   size_t count;
+};
+
+// FNV-1a over the lowercase string, so lookups are case insensitive like string_list_find_elem().
+static uint32_t core_info_ext_hash(const char *ext)
+{
+   uint32_t hash = 2166136261u;
+   while (*ext)
+   {
+      hash ^= (uint8_t)tolower((unsigned char)*ext++);
+      hash *= 16777619u;
+   }
+   return hash;
+}
+
+// Returns the slot holding ext, or the free slot where it would be inserted.
+static struct core_info_ext *core_info_ext_slot(const core_info_list_t *core_info_list, const char *ext, uint32_t hash)
+{
+   size_t mask = core_info_list->ext_index_size - 1;
+   size_t i = hash & mask;
+
+   while (core_info_list->ext_index[i].ext &&
+         (core_info_list->ext_index[i].hash != hash || strcasecmp(core_info_list->ext_index[i].ext, ext) != 0))
+      i = (i + 1) & mask;
+
+   return &core_info_list->ext_index[i];
+}
+
+static const struct core_info_ext *core_info_ext_find(const core_info_list_t *core_info_list, const char *ext)
+{
+   if (!core_info_list->ext_index || !*ext)
+      return NULL;
+
+   const struct core_info_ext *slot = core_info_ext_slot(core_info_list, ext, core_info_ext_hash(ext));
+   return slot->ext ? slot : NULL;
+}
+
+static bool core_info_ext_add(core_info_list_t *core_info_list, const char *ext, size_t core)
+{
+   // Lists in .info files may or may not have leading dots.
+   if (*ext == '.')
+      ext++;
+   if (!*ext)
+      return true;
+
+   uint32_t hash = core_info_ext_hash(ext);
+   struct core_info_ext *slot = core_info_ext_slot(core_info_list, ext, hash);
+
+   if (!slot->ext)
+   {
+      char *lower = strdup(ext);
+      if (!lower)
+         return false;
+
+      char *c;
+      for (c = lower; *c; c++)
+         *c = tolower((unsigned char)*c);
+
+      slot->ext = lower;
+      slot->hash = hash;
+   }
+
+   // Cores are added in order, a duplicate extension within one core is the last element.
+   if (slot->count && slot->cores[slot->count - 1] == core)
+      return true;
+
+   // Grow on powers of two.
+   if (!(slot->count & (slot->count - 1)))
+   {
+      size_t *cores = (size_t*)realloc(slot->cores, (slot->count ? slot->count * 2 : 1) * sizeof(*cores));
+      if (!cores)
+         return false;
+      slot->cores = cores;
+   }
+
+   slot->cores[slot->count++] = core;
+   return true;
+}
+
+static void core_info_list_build_ext_index(core_info_list_t *core_info_list)
+{
+   size_t i, j, num_ext = 0;
+
+   for (i = 0; i < core_info_list->count; i++)
+   {
+      if (core_info_list->list[i].supported_extensions_list)
+         num_ext += core_info_list->list[i].supported_extensions_list->size;
+   }
+
+   // Keep load at or below 1/2.
+   size_t size = 16;
+   while (size < num_ext * 2)
+      size *= 2;
+
+   core_info_list->ext_index = (struct core_info_ext*)calloc(size, sizeof(*core_info_list->ext_index));
+   core_info_list->supported = (const core_info_t**)calloc(core_info_list->count, sizeof(*core_info_list->supported));
+   core_info_list->supported_mask = (bool*)calloc(core_info_list->count, sizeof(*core_info_list->supported_mask));
+   if (!core_info_list->ext_index)
+      return;
+   core_info_list->ext_index_size = size;
+
+   for (i = 0; i < core_info_list->count; i++)
+   {
+      const struct string_list *exts = core_info_list->list[i].supported_extensions_list;
+      if (!exts)
+         continue;
+
+      for (j = 0; j < exts->size; j++)
+      {
+         if (!core_info_ext_add(core_info_list, exts->elems[j].data, i))
+            RARCH_ERR("Failed to index extension \"%s\".\n", exts->elems[j].data);
+      }
+   }
+}
+
+static void core_info_list_free_ext_index(core_info_list_t *core_info_list)
+{
+   size_t i;
+   for (i = 0; i < core_info_list->ext_index_size; i++)
+   {
+      free(core_info_list->ext_index[i].ext);
+      free(core_info_list->ext_index[i].cores);
+   }
+   free(core_info_list->ext_index);
+   free(core_info_list->supported);
+   free(core_info_list->supported_mask);
+   free(core_info_list->zip_path);
+   string_list_free(core_info_list->zip_exts);
+   free(core_info_list->firmware_dir);
+   string_list_free(core_info_list->firmware_exists);
+   string_list_free(core_info_list->firmware_dirs);
+}
 
 static void core_info_list_resolve_all_extensions(core_info_list_t *core_info_list)
 {
@@ -49,48 +195,175 @@ static void core_info_list_resolve_all_extensions(core_info_list_t *core_info_li
    }
 }
 
-static void core_info_list_resolve_all_firmware(core_info_list_t *core_info_list)
+// Only what listing and extension matching need. The rest is loaded by core_info_load_details().
+static void core_info_load_summary(core_info_t *info)
 {
-   size_t i;
-   unsigned c;
+   if (info->data)
+   {
+      config_get_string(info->data, "display_name", &info->display_name);
+      if (config_get_string(info->data, "supported_extensions", &info->supported_extensions) &&
+            info->supported_extensions)
+         info->supported_extensions_list = string_split(info->supported_extensions, "|");
+   }
 
-   for (i = 0; i < core_info_list->count; i++)
+   if (!info->display_name && info->path)
+      info->display_name = strdup(path_basename(info->path));
+}
+
+static void core_info_load_firmware(core_info_t *info)
+{
+   unsigned c, count = 0;
+   if (!config_get_uint(info->data, "firmware_count", &count) || !count)
+      return;
+
+   info->firmware = (core_info_firmware_t*)calloc(count, sizeof(*info->firmware));
+   if (!info->firmware)
+      return;
+   info->firmware_count = count;
+
+   for (c = 0; c < count; c++)
    {
-      core_info_t *info = &core_info_list->list[i];
+      char path_key[64], desc_key[64], opt_key[64];
 
-      if (!info->data)
-         continue;
+      snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
+      snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
+      snprintf(opt_key, sizeof(opt_key), "firmware%u_opt", c);
 
-      unsigned count = 0;
-      if (!config_get_uint(info->data, "firmware_count", &count))
-         continue;
+      config_get_string(info->data, path_key, &info->firmware[c].path);
+      config_get_string(info->data, desc_key, &info->firmware[c].desc);
+      config_get_bool(info->data, opt_key , &info->firmware[c].optional);
+   }
+}
 
-      info->firmware = (core_info_firmware_t*)calloc(count, sizeof(*info->firmware));
-      if (!info->firmware)
-         continue;
+// Authors, permissions, notes and firmware. Only needed once a core's info is looked at.
+static void core_info_load_details(core_info_t *info)
+{
+   if (info->details_loaded)
+      return;
+   info->details_loaded = true;
 
-      for (c = 0; c < count; c++)
-      {
-         char path_key[64], desc_key[64], opt_key[64];
+   if (!info->data)
+      return;
+
+   if (config_get_string(info->data, "authors", &info->authors) && info->authors)
+      info->authors_list = string_split(info->authors, "|");
+   if (config_get_string(info->data, "permissions", &info->permissions) && info->permissions)
+      info->permissions_list = string_split(info->permissions, "|");
+   if (config_get_string(info->data, "notes", &info->notes) && info->notes)
+      info->note_list = string_split(info->notes, "|");
+
+   core_info_load_firmware(info);
+}
+
+static void core_info_get_info_path(char *info_path, size_t size, const char *core_path, const char *modules_path)
+{
+   char info_path_base[PATH_MAX];
+   fill_pathname_base(info_path_base, core_path, sizeof(info_path_base));
+   path_remove_extension(info_path_base);
+
+   char *substr = strrchr(info_path_base, '_');
+   if (substr)
+      *substr = '\0';
+
+   strlcat(info_path_base, ".info", sizeof(info_path_base));
+
+   fill_pathname_join(info_path, (*g_settings.libretro_info_directory) ? g_settings.libretro_info_directory : modules_path,
+         info_path_base, size);
+}
+
+// Parsing of .info files missing from the config cache, shared by the worker threads.
+struct core_info_parse_job
+{
+   core_info_list_t *list;
+   const char *modules_path;
+   const bool *pending;
+   size_t next;
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+};
+
+// Few enough files are quicker parsed than waiting for threads to start.
+#define CORE_INFO_MIN_THREADED 16
+#define CORE_INFO_MAX_THREADS 4
+
+static void core_info_parse_worker(void *data)
+{
+   struct core_info_parse_job *job = (struct core_info_parse_job*)data;
+
+   for (;;)
+   {
+#ifdef HAVE_THREADS
+      if (job->lock)
+         slock_lock(job->lock);
+#endif
+      size_t i = job->next;
+      while (i < job->list->count && !job->pending[i])
+         i++;
+      job->next = i + 1;
+#ifdef HAVE_THREADS
+      if (job->lock)
+         slock_unlock(job->lock);
+#endif
 
-         snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
-         snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
-         snprintf(opt_key, sizeof(opt_key), "firmware%u_opt", c);
+      if (i >= job->list->count)
+         break;
 
-         config_get_string(info->data, path_key, &info->firmware[c].path);
-         config_get_string(info->data, desc_key, &info->firmware[c].desc);
-         config_get_bool(info->data, opt_key , &info->firmware[c].optional);
+      // Each worker only touches its own element, and config_file_new() is reentrant.
+      char info_path[PATH_MAX];
+      core_info_t *info = &job->list->list[i];
+      core_info_get_info_path(info_path, sizeof(info_path), info->path, job->modules_path);
+      info->data = config_file_new(info_path);
+   }
+}
+
+static void core_info_list_parse(core_info_list_t *core_info_list, const char *modules_path,
+      const bool *pending, size_t num_pending)
+{
+   struct core_info_parse_job job = {0};
+   job.list = core_info_list;
+   job.modules_path = modules_path;
+   job.pending = pending;
+
+#ifdef HAVE_THREADS
+   unsigned i, num_threads = rarch_get_cpu_cores();
+   if (num_threads > CORE_INFO_MAX_THREADS)
+      num_threads = CORE_INFO_MAX_THREADS;
+
+   if (num_threads > 1 && num_pending >= CORE_INFO_MIN_THREADED)
+      job.lock = slock_new();
+
+   if (job.lock)
+   {
+      // The calling thread is one of the workers.
+      sthread_t *threads[CORE_INFO_MAX_THREADS] = {NULL};
+      for (i = 1; i < num_threads; i++)
+         threads[i] = sthread_create(core_info_parse_worker, &job);
+
+      core_info_parse_worker(&job);
+
+      for (i = 1; i < num_threads; i++)
+      {
+         if (threads[i])
+            sthread_join(threads[i]);
       }
+
+      slock_free(job.lock);
+      return;
    }
+#endif
+
+   core_info_parse_worker(&job);
 }
 
 core_info_list_t *core_info_list_new(const char *modules_path)
 {
    struct string_list *contents = dir_list_new(modules_path, EXT_EXECUTABLES, false);
-   size_t i;
+   size_t i, num_pending = 0;
 
    core_info_t *core_info = NULL;
    core_info_list_t *core_info_list = NULL;
+   bool *pending = NULL;
 
    if (!contents)
       return NULL;
@@ -100,67 +373,50 @@ core_info_list_t *core_info_list_new(const char *modules_path)
       goto error;
 
    core_info = (core_info_t*)calloc(contents->size, sizeof(*core_info));
-   if (!core_info)
+   pending = (bool*)calloc(contents->size, sizeof(*pending));
+   if (!core_info || !pending)
       goto error;
 
    core_info_list->list = core_info;
    core_info_list->count = contents->size;
 
+   // Cache hits first. The cache is not thread safe, so misses are collected and parsed afterwards.
    for (i = 0; i < contents->size; i++)
    {
-      char info_path_base[PATH_MAX], info_path[PATH_MAX];
+      char info_path[PATH_MAX];
       core_info[i].path = strdup(contents->elems[i].data);
 
       if (!core_info[i].path)
          break;
 
-      fill_pathname_base(info_path_base, contents->elems[i].data, sizeof(info_path_base));
-      path_remove_extension(info_path_base);
-
-      char *substr = strrchr(info_path_base, '_');
-      if (substr)
-         *substr = '\0';
-
-      strlcat(info_path_base, ".info", sizeof(info_path_base));
-
-      fill_pathname_join(info_path, (*g_settings.libretro_info_directory) ? g_settings.libretro_info_directory : modules_path,
-            info_path_base, sizeof(info_path));
-
-      core_info[i].data = config_file_new(info_path);
-
-      if (core_info[i].data)
+      core_info_get_info_path(info_path, sizeof(info_path), core_info[i].path, modules_path);
+      core_info[i].data = config_cache_lookup(g_extern.config_cache, info_path);
+      if (!core_info[i].data)
       {
-         unsigned count = 0;
-         config_get_string(core_info[i].data, "display_name", &core_info[i].display_name);
-         config_get_uint(core_info[i].data, "firmware_count", &count);
-         core_info[i].firmware_count = count;
-         if (config_get_string(core_info[i].data, "supported_extensions", &core_info[i].supported_extensions) &&
-               core_info[i].supported_extensions)
-            core_info[i].supported_extensions_list = string_split(core_info[i].supported_extensions, "|");
-
-         if (config_get_string(core_info[i].data, "authors", &core_info[i].authors) &&
-               core_info[i].authors)
-            core_info[i].authors_list = string_split(core_info[i].authors, "|");
-
-         if (config_get_string(core_info[i].data, "permissions", &core_info[i].permissions) &&
-               core_info[i].permissions)
-            core_info[i].permissions_list = string_split(core_info[i].permissions, "|");
-         if (config_get_string(core_info[i].data, "notes", &core_info[i].notes) &&
-               core_info[i].notes)
-            core_info[i].note_list = string_split(core_info[i].notes, "|");
+         pending[i] = true;
+         num_pending++;
       }
+   }
+
+   if (num_pending)
+      core_info_list_parse(core_info_list, modules_path, pending, num_pending);
 
-      if (!core_info[i].display_name)
-         core_info[i].display_name = strdup(path_basename(core_info[i].path));
+   for (i = 0; i < core_info_list->count; i++)
+   {
+      if (pending[i])
+         config_cache_store(g_extern.config_cache, core_info[i].data);
+      core_info_load_summary(&core_info[i]);
    }
 
    core_info_list_resolve_all_extensions(core_info_list);
-   core_info_list_resolve_all_firmware(core_info_list);
+   core_info_list_build_ext_index(core_info_list);
 
+   free(pending);
    dir_list_free(contents);
    return core_info_list;
 
 error:
+   free(pending);
    if (contents)
       dir_list_free(contents);
    core_info_list_free(core_info_list);
@@ -189,7 +445,7 @@ void core_info_list_free(core_info_list_t *core_info_list)
       string_list_free(info->permissions_list);
       config_file_free(info->data);
 
-      for (j = 0; j < info->firmware_count; j++)
+      for (j = 0; info->firmware && j < info->firmware_count; j++)
       {
          free(info->firmware[j].path);
          free(info->firmware[j].desc);
@@ -197,6 +453,7 @@ void core_info_list_free(core_info_list_t *core_info_list)
       free(info->firmware);
    }
 
+   core_info_list_free_ext_index(core_info_list);
    free(core_info_list->all_ext);
    free(core_info_list->list);
    free(core_info_list);
@@ -234,9 +491,10 @@ bool core_info_list_get_info(core_info_list_t *core_info_list, core_info_t *out_
 
    for (i = 0; i < core_info_list->count; i++)
    {
-      const core_info_t *info = &core_info_list->list[i];
+      core_info_t *info = &core_info_list->list[i];
       if (!strcmp(path_basename(info->path), path_basename(path)))
       {
+         core_info_load_details(info);
          *out_info = *info;
          return true;
       }
@@ -270,60 +528,101 @@ const char *core_info_list_get_all_extensions(core_info_list_t *core_info_list)
    return core_info_list->all_ext;
 }
 
-// qsort_r() is not in standard C, sadly.
-static const char *core_info_tmp_path;
-static const struct string_list *core_info_tmp_list;
+static void core_info_list_mark_ext(core_info_list_t *core_info_list, const char *ext)
+{
+   size_t i;
+   const struct core_info_ext *slot = core_info_ext_find(core_info_list, ext);
+   if (!slot)
+      return;
 
-static int core_info_qsort_cmp(const void *a_, const void *b_)
+   for (i = 0; i < slot->count; i++)
+      core_info_list->supported_mask[slot->cores[i]] = true;
+}
+
+#ifdef HAVE_ZLIB
+// Unique extensions of the files in a ZIP. The last archive is kept, since the menu
+// asks for the same one when a file is selected and when the core list is shown.
+static const struct string_list *core_info_list_get_zip_exts(core_info_list_t *core_info_list, const char *path)
 {
-   const core_info_t *a = (const core_info_t*)a_;
-   const core_info_t *b = (const core_info_t*)b_;
+   size_t i;
+   if (core_info_list->zip_path && !strcmp(core_info_list->zip_path, path))
+      return core_info_list->zip_exts;
 
-   int support_a = core_info_does_support_any_file(a, core_info_tmp_list) ||
-      core_info_does_support_file(a, core_info_tmp_path);
-   int support_b = core_info_does_support_any_file(b, core_info_tmp_list) ||
-      core_info_does_support_file(b, core_info_tmp_path);
+   free(core_info_list->zip_path);
+   string_list_free(core_info_list->zip_exts);
+   core_info_list->zip_path = NULL;
+   core_info_list->zip_exts = NULL;
 
-   if (support_a != support_b)
-      return support_b - support_a;
-   else
-      return strcasecmp(a->display_name, b->display_name);
+   struct string_list *files = zlib_get_file_list(path);
+   if (!files)
+      return NULL;
+
+   struct string_list *exts = string_list_new();
+   if (exts)
+   {
+      union string_list_elem_attr attr;
+      memset(&attr, 0, sizeof(attr));
+
+      for (i = 0; i < files->size; i++)
+      {
+         const char *ext = path_get_extension(files->elems[i].data);
+         if (*ext && !string_list_find_elem(exts, ext))
+            string_list_append(exts, ext, attr);
+      }
+
+      core_info_list->zip_path = strdup(path);
+      core_info_list->zip_exts = exts;
+   }
+
+   string_list_free(files);
+   return exts;
+}
+#endif
+
+// Ties keep list order, so the view is stable.
+static int core_info_display_name_cmp(const void *a_, const void *b_)
+{
+   const core_info_t *a = *(const core_info_t**)a_;
+   const core_info_t *b = *(const core_info_t**)b_;
+
+   int order = strcasecmp(a->display_name, b->display_name);
+   if (order)
+      return order;
+   return (a > b) - (a < b);
 }
 
 void core_info_list_get_supported_cores(core_info_list_t *core_info_list, const char *path,
-      const core_info_t **infos, size_t *num_infos)
+      const core_info_t ***infos, size_t *num_infos)
 {
-   core_info_tmp_path = path;
+   size_t i, supported = 0;
 
-#ifdef HAVE_ZLIB
-   struct string_list *list = NULL;
-   if (!strcasecmp(path_get_extension(path), "zip"))
-      list = zlib_get_file_list(path);
-   core_info_tmp_list = list;
-#endif
+   *infos = core_info_list->supported;
+   *num_infos = 0;
 
-   // Let supported core come first in list so we can return a pointer to them.
-   qsort(core_info_list->list, core_info_list->count, sizeof(core_info_t), core_info_qsort_cmp);
+   if (!core_info_list->supported || !core_info_list->supported_mask)
+      return;
 
-   size_t supported, i;
-   supported = 0;
-   for (i = 0; i < core_info_list->count; i++, supported++)
-   {
-      const core_info_t *core = &core_info_list->list[i];
-      if (!core_info_does_support_file(core, path)
-#ifdef HAVE_ZLIB
-            && !core_info_does_support_any_file(core, list)
-#endif
-         )
-         break;
-   }
+   memset(core_info_list->supported_mask, 0, core_info_list->count * sizeof(*core_info_list->supported_mask));
+
+   const char *ext = path_get_extension(path);
+   core_info_list_mark_ext(core_info_list, ext);
 
 #ifdef HAVE_ZLIB
-   if (list)
-      string_list_free(list);
+   if (!strcasecmp(ext, "zip"))
+   {
+      const struct string_list *exts = core_info_list_get_zip_exts(core_info_list, path);
+      for (i = 0; exts && i < exts->size; i++)
+         core_info_list_mark_ext(core_info_list, exts->elems[i].data);
+   }
 #endif
 
-   *infos = core_info_list->list;
+   for (i = 0; i < core_info_list->count; i++)
+   {
+      if (core_info_list->supported_mask[i])
+         core_info_list->supported[supported++] = &core_info_list->list[i];
+   }
+
+   qsort(core_info_list->supported, supported, sizeof(*core_info_list->supported), core_info_display_name_cmp);
    *num_infos = supported;
 }
 
@@ -334,12 +633,87 @@ static core_info_t *find_core_info(core_info_list_t *list, const char *core)
    {
       core_info_t *info = &list->list[i];
       if (info->path && !strcmp(info->path, core))
+      {
+         core_info_load_details(info);
          return info;
+      }
    }
 
    return NULL;
 }
 
+// mtime of a directory firmware is looked for in, 0 if it does not exist.
+// -1 if it was modified within the last second, it might change again without the mtime moving.
+static int core_info_firmware_dir_mtime(const char *dir)
+{
+   struct stat buf;
+   if (stat(dir, &buf) < 0)
+      return 0;
+   return buf.st_mtime >= time(NULL) ? -1 : (int)buf.st_mtime;
+}
+
+// Firmware is shared between cores, e.g. BIOSes for several systems of the same family,
+// so lookups are cached. Like dir_list_cache, the cache only holds while the directories
+// looked in keep their mtime, so firmware added or removed at runtime is picked up.
+static void core_info_firmware_validate(core_info_list_t *core_info_list, const char *systemdir)
+{
+   size_t i;
+   struct string_list *dirs = core_info_list->firmware_dirs;
+   bool valid = core_info_list->firmware_dir && !strcmp(core_info_list->firmware_dir, systemdir) && dirs;
+
+   for (i = 0; valid && i < dirs->size; i++)
+   {
+      int mtime = core_info_firmware_dir_mtime(dirs->elems[i].data);
+      valid = mtime != -1 && mtime == dirs->elems[i].attr.i;
+   }
+
+   if (valid)
+      return;
+
+   free(core_info_list->firmware_dir);
+   string_list_free(core_info_list->firmware_exists);
+   string_list_free(core_info_list->firmware_dirs);
+   core_info_list->firmware_dir = strdup(systemdir);
+   core_info_list->firmware_exists = string_list_new();
+   core_info_list->firmware_dirs = string_list_new();
+}
+
+// Call core_info_firmware_validate() first.
+static bool core_info_firmware_exists(core_info_list_t *core_info_list, const char *systemdir, const char *firmware)
+{
+   size_t i;
+   char path[PATH_MAX], dir[PATH_MAX];
+   union string_list_elem_attr attr;
+
+   struct string_list *list = core_info_list->firmware_exists;
+   for (i = 0; list && i < list->size; i++)
+   {
+      if (!strcmp(list->elems[i].data, firmware))
+         return list->elems[i].attr.b;
+   }
+
+   fill_pathname_join(path, systemdir, firmware, sizeof(path));
+
+   // Firmware paths can have subdirectories, each needs checking on its own.
+   struct string_list *dirs = core_info_list->firmware_dirs;
+   fill_pathname_basedir(dir, path, sizeof(dir));
+   for (i = 0; dirs && i < dirs->size; i++)
+   {
+      if (!strcmp(dirs->elems[i].data, dir))
+         break;
+   }
+   if (dirs && i == dirs->size)
+   {
+      attr.i = core_info_firmware_dir_mtime(dir);
+      string_list_append(dirs, dir, attr);
+   }
+
+   attr.b = path_file_exists(path);
+   if (list)
+      string_list_append(list, firmware, attr);
+   return attr.b;
+}
+
 static int core_info_firmware_cmp(const void *a_, const void *b_)
 {
    const core_info_firmware_t *a = (const core_info_firmware_t*)a_;
@@ -355,19 +729,16 @@ void core_info_list_update_missing_firmware(core_info_list_t *core_info_list,
       const char *core, const char *systemdir)
 {
    size_t i;
-   char path[PATH_MAX];
 
    core_info_t *info = find_core_info(core_info_list, core);
    if (!info)
       return;
 
+   core_info_firmware_validate(core_info_list, systemdir);
    for (i = 0; i < info->firmware_count; i++)
    {
       if (info->firmware[i].path)
-      {
-         fill_pathname_join(path, systemdir, info->firmware[i].path, sizeof(path));
-         info->firmware[i].missing = !path_file_exists(path);
-      }
+         info->firmware[i].missing = !core_info_firmware_exists(core_info_list, systemdir, info->firmware[i].path);
    }
 }
 
@@ -376,7 +747,6 @@ void core_info_list_get_missing_firmware(core_info_list_t *core_info_list,
       const core_info_firmware_t **firmware, size_t *num_firmware)
 {
    size_t i;
-   char path[PATH_MAX];
 
    *firmware = NULL;
    *num_firmware = 0;
@@ -387,10 +757,10 @@ void core_info_list_get_missing_firmware(core_info_list_t *core_info_list,
 
    *firmware = info->firmware;
 
+   core_info_firmware_validate(core_info_list, systemdir);
    for (i = 1; i < info->firmware_count; i++)
    {
-      fill_pathname_join(path, systemdir, info->firmware[i].path, sizeof(path));
-      info->firmware[i].missing = !path_file_exists(path);
+      info->firmware[i].missing = !core_info_firmware_exists(core_info_list, systemdir, info->firmware[i].path);
       *num_firmware += info->firmware[i].missing;
    }
 
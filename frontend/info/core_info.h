@@ -46,15 +46,39 @@ typedef struct
    struct string_list *authors_list;
    struct string_list *permissions_list;
 
+   // Authors, permissions, notes and firmware are only filled in once the core is looked up,
+   // see core_info_list_get_info().
+   bool details_loaded;
+
    core_info_firmware_t *firmware;
    size_t firmware_count;
 } core_info_t;
 
+struct core_info_ext;
+
 typedef struct
 {
    core_info_t *list;
    size_t count;
    char *all_ext;
+
+   // Lowercase extension -> cores supporting it. Open addressing, power of two size.
+   struct core_info_ext *ext_index;
+   size_t ext_index_size;
+
+   // Sorted view returned by core_info_list_get_supported_cores().
+   const core_info_t **supported;
+   bool *supported_mask;
+
+   // Extensions found in the last ZIP queried, so it isn't reread for every query.
+   char *zip_path;
+   struct string_list *zip_exts;
+
+   // Firmware found or missing in firmware_dir, attr.b is true if it exists.
+   // firmware_dirs holds the directories looked in, attr.i is their mtime at the time.
+   char *firmware_dir;
+   struct string_list *firmware_exists;
+   struct string_list *firmware_dirs;
 } core_info_list_t;
 
 core_info_list_t *core_info_list_new(const char *modules_path);
@@ -65,9 +89,10 @@ size_t core_info_list_num_info_files(core_info_list_t *core_info_list);
 bool core_info_does_support_file(const core_info_t *core, const char *path);
 bool core_info_does_support_any_file(const core_info_t *core, const struct string_list *list);
 
-// Non-reentrant, does not allocate. Returns pointer to internal state.
+// Cores which support path (or files within it, for a ZIP), sorted by display name.
+// Non-reentrant, does not allocate. Returns pointer to internal state, valid until the next call.
 void core_info_list_get_supported_cores(core_info_list_t *core_info_list, const char *path,
-      const core_info_t **infos, size_t *num_infos);
+      const core_info_t ***infos, size_t *num_infos);
 
 // Non-reentrant, does not allocate. Returns pointer to internal state.
 void core_info_list_get_missing_firmware(core_info_list_t *core_info_list,
@@ -77,7 +102,8 @@ void core_info_list_get_missing_firmware(core_info_list_t *core_info_list,
 void core_info_list_update_missing_firmware(core_info_list_t *core_info_list,
       const char *core, const char *systemdir);	  
 	  
-// Shallow-copies internal state. Data in *info is invalidated when the core_info_list is freed.
+// Shallow-copies internal state, loading the details of the core first.
+// Data in *info is invalidated when the core_info_list is freed.
 bool core_info_list_get_info(core_info_list_t *core_info_list, core_info_t *info, const char *path);
 
 const char *core_info_list_get_all_extensions(core_info_list_t *core_info_list);
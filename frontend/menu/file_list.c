@@ -16,8 +16,8 @@
 
 #define _GNU_SOURCE
 #include <stdlib.h>
+#include <string.h>
 #include "file_list.h"
-#include "../../compat/strcasestr.h"
 
 struct item_file
 {
@@ -27,6 +27,53 @@ struct item_file
    size_t directory_ptr;
 };
 
+static void file_list_index_free(struct file_list_index *index);
+
+#define FILE_LIST_BLOCK_SIZE 8192
+
+// Strings never move once allocated, so pointers handed out stay valid until the list is cleared.
+struct file_list_block
+{
+   struct file_list_block *next;
+   size_t size;
+   size_t used;
+   char data[];
+};
+
+static char *file_list_strdup(file_list_t *list, const char *str)
+{
+   size_t len = strlen(str) + 1;
+   struct file_list_block *block = list->blocks;
+
+   if (!block || block->used + len > block->size)
+   {
+      size_t size = len > FILE_LIST_BLOCK_SIZE ? len : FILE_LIST_BLOCK_SIZE;
+      block = (struct file_list_block*)malloc(sizeof(*block) + size);
+      if (!block)
+         return NULL;
+
+      block->next  = list->blocks;
+      block->size  = size;
+      block->used  = 0;
+      list->blocks = block;
+      list->allocs++;
+   }
+
+   char *ret = block->data + block->used;
+   memcpy(ret, str, len);
+   block->used += len;
+   return ret;
+}
+
+// Only the most recent string can be given back. Others stay until the list is cleared.
+static void file_list_release(file_list_t *list, const char *str)
+{
+   struct file_list_block *block = list->blocks;
+   if (str && block && str >= block->data && str < block->data + block->used &&
+         str + strlen(str) + 1 == block->data + block->used)
+      block->used = str - block->data;
+}
+
 void file_list_push(file_list_t *list,
       const char *path, unsigned type, size_t directory_ptr)
 {
@@ -38,13 +85,15 @@ void file_list_push(file_list_t *list,
       list->capacity++;
       list->capacity *= 2;
       list->list = (struct item_file*)realloc(list->list, list->capacity * sizeof(struct item_file));
+      list->allocs++;
    }
 
-   list->list[list->size].path = strdup(path);
+   list->list[list->size].path = file_list_strdup(list, path);
    list->list[list->size].alt = NULL;
    list->list[list->size].type = type;
    list->list[list->size].directory_ptr = directory_ptr;
    list->size++;
+   list->generation++;
 
 }
 
@@ -52,7 +101,8 @@ void file_list_pop(file_list_t *list, size_t *directory_ptr)
 {
    if (!(list->size == 0))
    {
-      free(list->list[--list->size].path);
+      file_list_release(list, list->list[--list->size].path);
+      list->generation++;
    }
 
    if (directory_ptr)
@@ -63,29 +113,47 @@ void file_list_pop(file_list_t *list, size_t *directory_ptr)
 
 void file_list_free(file_list_t *list)
 {
-   size_t i;
-   for (i = 0; i < list->size; i++)
-      free(list->list[i].path);
+   struct file_list_block *block = list->blocks;
+   while (block)
+   {
+      struct file_list_block *next = block->next;
+      free(block);
+      block = next;
+   }
+
+   file_list_index_free(list->index);
    free(list->list);
    free(list);
 }
 
 void file_list_clear(file_list_t *list)
 {
-   size_t i;
-   for (i = 0; i < list->size; i++)
+   // Keeps the most recent block around for the next fill.
+   struct file_list_block *block = list->blocks;
+   if (block)
    {
-      free(list->list[i].path);
-      free(list->list[i].alt);
+      struct file_list_block *next = block->next;
+      while (next)
+      {
+         struct file_list_block *tmp = next->next;
+         free(next);
+         next = tmp;
+      }
+
+      block->next = NULL;
+      block->used = 0;
    }
+
    list->size = 0;
+   list->generation++;
 }
 
 void file_list_set_alt_at_offset(file_list_t *list, size_t index,
       const char *alt)
 {
-   free(list->list[index].alt);
-   list->list[index].alt = strdup(alt);
+   file_list_release(list, list->list[index].alt);
+   list->list[index].alt = file_list_strdup(list, alt);
+   list->generation++;
 }
 
 void file_list_get_alt_at_offset(const file_list_t *list, size_t index,
@@ -95,18 +163,206 @@ void file_list_get_alt_at_offset(const file_list_t *list, size_t index,
       *alt = list->list[index].alt ? list->list[index].alt : list->list[index].path;
 }
 
-static int file_list_alt_cmp(const void *a_, const void *b_)
+struct file_list_index
+{
+   unsigned generation; // Of the list when this was built.
+   bool valid;
+
+   // Labels folded to lower case ASCII, '\0' separated, in list order.
+   char *folded;
+   size_t *offsets;
+   size_t size;
+
+   // Entry indices sorted by folded label, built on first use.
+   size_t *by_name;
+};
+
+struct file_list_sort_key
+{
+   const char *key;
+   size_t index;
+};
+
+static inline char file_list_tolower(char c)
+{
+   return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+static void file_list_index_free(struct file_list_index *index)
+{
+   if (!index)
+      return;
+
+   free(index->by_name);
+   free(index->folded);
+   free(index->offsets);
+   free(index);
+}
+
+static bool file_list_index_is_current(const file_list_t *list)
+{
+   return list->index && list->index->valid && list->index->generation == list->generation;
+}
+
+// The index is a cache, so it gets filled in through const lists as well.
+static struct file_list_index *file_list_get_index(const file_list_t *list_)
+{
+   size_t i, total = 0;
+   file_list_t *list = (file_list_t*)list_;
+   struct file_list_index *index = list->index;
+
+   if (file_list_index_is_current(list))
+      return index;
+
+   file_list_index_free(index);
+   index = list->index = (struct file_list_index*)calloc(1, sizeof(*index));
+   if (!index)
+      return NULL;
+
+   for (i = 0; i < list->size; i++)
+   {
+      const char *alt = list->list[i].alt ? list->list[i].alt : list->list[i].path;
+      total += (alt ? strlen(alt) : 0) + 1;
+   }
+
+   index->folded  = (char*)malloc(total ? total : 1);
+   index->offsets = (size_t*)malloc((list->size + 1) * sizeof(*index->offsets));
+   if (!index->folded || !index->offsets)
+      return NULL;
+
+   total = 0;
+   for (i = 0; i < list->size; i++)
+   {
+      const char *alt = list->list[i].alt ? list->list[i].alt : list->list[i].path;
+      index->offsets[i] = total;
+      for (; alt && *alt; alt++)
+         index->folded[total++] = file_list_tolower(*alt);
+      index->folded[total++] = '\0';
+   }
+   index->offsets[list->size] = total;
+
+   index->size       = total;
+   index->generation = list->generation;
+   index->valid      = true;
+   return index;
+}
+
+static int file_list_key_cmp(const void *a_, const void *b_)
+{
+   const struct file_list_sort_key *a = (const struct file_list_sort_key*)a_;
+   const struct file_list_sort_key *b = (const struct file_list_sort_key*)b_;
+   int ret = strcmp(a->key, b->key);
+   if (ret)
+      return ret;
+   return a->index < b->index ? -1 : (a->index > b->index);
+}
+
+// Entry indices sorted by label, ties in list order. NULL on allocation failure.
+static const size_t *file_list_get_name_order(const file_list_t *list)
 {
-   const struct item_file *a = (const struct item_file*)a_;
-   const struct item_file *b = (const struct item_file*)b_;
-   const char *cmp_a = a->alt ? a->alt : a->path;
-   const char *cmp_b = b->alt ? b->alt : b->path;
-   return strcasecmp(cmp_a, cmp_b);
+   size_t i;
+   struct file_list_sort_key *keys;
+   struct file_list_index *index = file_list_get_index(list);
+
+   if (!index)
+      return NULL;
+   if (index->by_name)
+      return index->by_name;
+
+   keys = (struct file_list_sort_key*)malloc((list->size + 1) * sizeof(*keys));
+   index->by_name = (size_t*)malloc((list->size + 1) * sizeof(size_t));
+   if (!keys || !index->by_name)
+   {
+      free(keys);
+      free(index->by_name);
+      index->by_name = NULL;
+      return NULL;
+   }
+
+   for (i = 0; i < list->size; i++)
+   {
+      keys[i].key   = index->folded + index->offsets[i];
+      keys[i].index = i;
+   }
+
+   qsort(keys, list->size, sizeof(*keys), file_list_key_cmp);
+
+   for (i = 0; i < list->size; i++)
+      index->by_name[i] = keys[i].index;
+
+   free(keys);
+   return index->by_name;
 }
 
 void file_list_sort_on_alt(file_list_t *list)
 {
-   qsort(list->list, list->size, sizeof(list->list[0]), file_list_alt_cmp);
+   size_t i;
+   const size_t *view = file_list_get_name_order(list);
+   struct item_file *sorted = (struct item_file*)malloc(list->size * sizeof(*sorted));
+
+   if (!view || !sorted)
+   {
+      free(sorted);
+      return;
+   }
+
+   for (i = 0; i < list->size; i++)
+      sorted[i] = list->list[view[i]];
+   memcpy(list->list, sorted, list->size * sizeof(*sorted));
+   free(sorted);
+   list->generation++;
+}
+
+void file_list_merge(file_list_t *list, size_t start, size_t mid, file_list_cmp_t cmp, size_t *track)
+{
+   size_t i, j, k, lo, hi, count;
+   struct item_file *left;
+   struct item_file *items = list->list;
+
+   if (mid <= start || mid >= list->size)
+      return;
+
+   list->generation++;
+
+   // Entries before the first new one stay where they are.
+   lo = start;
+   hi = mid;
+   while (lo < hi)
+   {
+      size_t pivot = lo + (hi - lo) / 2;
+      if (cmp(items[pivot].path, items[pivot].type, items[mid].path, items[mid].type) <= 0)
+         lo = pivot + 1;
+      else
+         hi = pivot;
+   }
+
+   if (lo == mid)
+      return;
+
+   count = mid - lo;
+   left = (struct item_file*)malloc(count * sizeof(*left));
+   if (!left)
+      return;
+   memcpy(left, items + lo, count * sizeof(*left));
+
+   size_t tracked = track ? *track : (size_t)-1;
+   for (i = 0, j = mid, k = lo; i < count; k++)
+   {
+      if (j < list->size && cmp(items[j].path, items[j].type, left[i].path, left[i].type) < 0)
+      {
+         if (j == tracked)
+            *track = k;
+         items[k] = items[j++];
+      }
+      else
+      {
+         if (lo + i == tracked)
+            *track = k;
+         items[k] = left[i++];
+      }
+   }
+
+   free(left);
 }
 
 void file_list_get_at_offset(const file_list_t *list, size_t index,
@@ -125,25 +381,37 @@ void file_list_get_last(const file_list_t *list,
       file_list_get_at_offset(list, list->size - 1, path, file_type);
 }
 
-bool file_list_search(const file_list_t *list, const char *needle, size_t *index)
+// Case insensitive (on ASCII) strstr() against an already folded needle.
+static const char *file_list_find_folded(const char *label, const char *folded, size_t len)
+{
+   size_t i;
+   for (; *label; label++)
+   {
+      for (i = 0; i < len && file_list_tolower(label[i]) == folded[i]; i++);
+      if (i == len)
+         return label;
+   }
+   return NULL;
+}
+
+// Same as the indexed search, one pass over the labels.
+static bool file_list_scan(const file_list_t *list, const char *folded, size_t len, size_t *index)
 {
    size_t i;
-   const char *alt;
    bool ret = false;
    for (i = 0; i < list->size; i++)
    {
-      file_list_get_alt_at_offset(list, i, &alt);
+      const char *alt = list->list[i].alt ? list->list[i].alt : list->list[i].path;
       if (!alt)
          continue;
 
-      const char *str = strcasestr(alt, needle);
-      if (str == alt) // Found match with first chars, best possible match.
+      const char *str = file_list_find_folded(alt, folded, len);
+      if (str == alt)
       {
          *index = i;
-         ret = true;
-         break;
+         return true;
       }
-      else if (str && !ret) // Found mid-string match, but try to find a match with first chars before we settle.
+      else if (str && !ret)
       {
          *index = i;
          ret = true;
@@ -153,3 +421,86 @@ bool file_list_search(const file_list_t *list, const char *needle, size_t *index
    return ret;
 }
 
+bool file_list_search(const file_list_t *list_, const char *needle, size_t *index)
+{
+   size_t i, lo, hi, len, best;
+   char folded[256];
+   const char *ptr, *end;
+   const size_t *view;
+   const struct file_list_index *search;
+   file_list_t *list = (file_list_t*)list_;
+
+   if (!*needle)
+      return false;
+
+   for (len = 0; needle[len] && len < sizeof(folded) - 1; len++)
+      folded[len] = file_list_tolower(needle[len]);
+   folded[len] = '\0';
+
+   // Building the index costs about ten scans, so only do it once a list is searched twice.
+   if (!file_list_index_is_current(list) &&
+         (!list->scanned || list->scanned_generation != list->generation))
+   {
+      list->scanned = true;
+      list->scanned_generation = list->generation;
+      return file_list_scan(list, folded, len, index);
+   }
+
+   view = file_list_get_name_order(list);
+   search = list->index;
+   if (!view)
+      return file_list_scan(list, folded, len, index);
+
+   // The first key not sorting before the needle is the first one it can be a prefix of,
+   // and all labels starting with it follow. Take the first of those in list order.
+   lo = 0;
+   hi = list->size;
+   while (lo < hi)
+   {
+      size_t pivot = lo + (hi - lo) / 2;
+      if (strcmp(search->folded + search->offsets[view[pivot]], folded) < 0)
+         lo = pivot + 1;
+      else
+         hi = pivot;
+   }
+
+   best = list->size;
+   for (i = lo; i < list->size && strncmp(search->folded + search->offsets[view[i]], folded, len) == 0; i++)
+      if (view[i] < best)
+         best = view[i];
+
+   if (best < list->size)
+   {
+      *index = best;
+      return true;
+   }
+
+   // Matches can't span labels, as the needle has no '\0' in it.
+   ptr = search->folded;
+   end = search->folded + search->size;
+   while (end - ptr >= (ptrdiff_t)len && (ptr = (const char*)memchr(ptr, folded[0], end - ptr - len + 1)))
+   {
+      if (memcmp(ptr, folded, len) == 0)
+      {
+         size_t offset = ptr - search->folded;
+
+         // Last label starting at or before the match.
+         lo = 0;
+         hi = list->size;
+         while (hi - lo > 1)
+         {
+            size_t pivot = lo + (hi - lo) / 2;
+            if (search->offsets[pivot] <= offset)
+               lo = pivot;
+            else
+               hi = pivot;
+         }
+
+         *index = lo;
+         return true;
+      }
+      ptr++;
+   }
+
+   return false;
+}
@@ -22,14 +22,28 @@ extern "C" {
 #endif
 
 #include <stdbool.h>
+#include <stddef.h>
 
 struct item_file;
+struct file_list_block;
+struct file_list_index;
 typedef struct file_list
 {
    struct item_file *list;
 
    size_t capacity;
    size_t size;
+
+   // Paths and alt labels are bump allocated from blocks, all released by file_list_clear() and file_list_free().
+   struct file_list_block *blocks;
+   unsigned allocs; // Heap allocations made for this list so far.
+
+   // Search keys and name order, rebuilt on demand after the list changed.
+   struct file_list_index *index;
+   unsigned generation;
+   // Generation of the list when it was last searched without the index.
+   unsigned scanned_generation;
+   bool scanned;
 } file_list_t;
 
 void file_list_free(file_list_t *list);
@@ -50,8 +64,17 @@ void file_list_set_alt_at_offset(file_list_t *list, size_t index,
 void file_list_get_alt_at_offset(const file_list_t *list, size_t index,
       const char **alt);
 
+// Sorts the entries on their alt labels, case insensitive on ASCII.
 void file_list_sort_on_alt(file_list_t *list);
 
+typedef int (*file_list_cmp_t)(const char *a, unsigned a_type, const char *b, unsigned b_type);
+// Merges the entries from mid onwards, sorted with cmp, into the entries in [start, mid) sorted the same way.
+// If track is non-NULL, the index it holds is updated to follow its entry.
+void file_list_merge(file_list_t *list, size_t start, size_t mid, file_list_cmp_t cmp, size_t *track);
+
+// Case insensitive search on alt labels. Finds the first label starting with needle in list order,
+// or failing that the first label containing it. The first search after a change scans the labels,
+// a second one builds an index which later searches use until the list changes again.
 bool file_list_search(const file_list_t *list, const char *needle, size_t *index);
 
 #ifdef __cplusplus
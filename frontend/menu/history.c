@@ -18,34 +18,135 @@
 #include "../../general.h"
 #include "../../file.h"
 
+#ifdef HAVE_THREADS
+#include "../../thread.h"
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+// Every push is appended to a journal next to the history file, replayed on top of it when loading.
+// The history file itself is only rewritten once the journal holds as many records as the history,
+// or when it is cleared. Freeing leaves the journal in place, the next init replays it.
+
 struct rom_history_entry
 {
    char *path;
    char *core_path;
    char *core_name;
+   uint32_t hash;
+};
+
+// Pending file writes, handled in order.
+struct rom_history_job
+{
+   char *data;
+   size_t size;
+   bool snapshot; // Replaces the history file and empties the journal. Appended to the journal otherwise.
+   struct rom_history_job *next;
 };
 
 struct rom_history
 {
-   struct rom_history_entry *entries;
+   struct rom_history_entry *entries; // cap slots.
+   size_t *order; // Slots of the entries, most recent first.
    size_t size;
    size_t cap;
 
+   // Open addressing on (path, core_path). Holds slot + 1, 0 is empty.
+   size_t *index;
+   size_t index_mask;
+
    char *conf_path;
+   char *journal_path;
+   unsigned journal_records;
+   bool loading;
+
+   struct rom_history_job *jobs;
+   struct rom_history_job **jobs_tail;
+#ifdef HAVE_THREADS
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   bool quit;
+#endif
 };
 
+static uint32_t rom_history_hash(const char *path, const char *core_path)
+{
+   uint32_t hash = 2166136261u;
+   if (path)
+   {
+      while (*path)
+         hash = (hash ^ (uint8_t)*path++) * 16777619u;
+   }
+
+   hash = (hash ^ 0xff) * 16777619u;
+   while (*core_path)
+      hash = (hash ^ (uint8_t)*core_path++) * 16777619u;
+   return hash;
+}
+
+static bool rom_history_entry_equal(const struct rom_history_entry *entry,
+      const char *path, const char *core_path)
+{
+   bool equal_path = (!path && !entry->path) ||
+      (path && entry->path && !strcmp(path, entry->path));
+
+   // Core name can have changed while still being the same core.
+   // Differentiate based on the core path only.
+   return equal_path && !strcmp(entry->core_path, core_path);
+}
+
+// Returns the position in the index holding the entry, or the empty one where it would go.
+static size_t rom_history_index_find(rom_history_t *hist, uint32_t hash,
+      const char *path, const char *core_path)
+{
+   size_t pos = hash & hist->index_mask;
+   while (hist->index[pos])
+   {
+      const struct rom_history_entry *entry = &hist->entries[hist->index[pos] - 1];
+      if (entry->hash == hash && rom_history_entry_equal(entry, path, core_path))
+         break;
+      pos = (pos + 1) & hist->index_mask;
+   }
+
+   return pos;
+}
+
+// Backward shift deletion, so lookups never need tombstones.
+static void rom_history_index_remove(rom_history_t *hist, size_t pos)
+{
+   size_t next = (pos + 1) & hist->index_mask;
+   hist->index[pos] = 0;
+
+   while (hist->index[next])
+   {
+      size_t home = hist->entries[hist->index[next] - 1].hash & hist->index_mask;
+
+      // Entries whose home is cyclically in (pos, next] are fine where they are.
+      bool stays = pos <= next ? (home > pos && home <= next) : (home > pos || home <= next);
+      if (!stays)
+      {
+         hist->index[pos]  = hist->index[next];
+         hist->index[next] = 0;
+         pos = next;
+      }
+
+      next = (next + 1) & hist->index_mask;
+   }
+}
+
 void rom_history_get_index(rom_history_t *hist,
       size_t index,
       const char **path, const char **core_path,
       const char **core_name)
 {
-   *path      = hist->entries[index].path;
-   *core_path = hist->entries[index].core_path;
-   *core_name = hist->entries[index].core_name;
+   const struct rom_history_entry *entry = &hist->entries[hist->order[index]];
+   *path      = entry->path;
+   *core_path = entry->core_path;
+   *core_name = entry->core_name;
 }
 
 static void rom_history_free_entry(struct rom_history_entry *entry)
@@ -56,63 +157,194 @@ static void rom_history_free_entry(struct rom_history_entry *entry)
    memset(entry, 0, sizeof(*entry));
 }
 
-void rom_history_push(rom_history_t *hist,
-      const char *path, const char *core_path,
-      const char *core_name)
+static void rom_history_run_job(rom_history_t *hist, const struct rom_history_job *job)
 {
-   size_t i;
-   for (i = 0; i < hist->size; i++)
+   if (job->snapshot)
    {
-      bool equal_path = (!path && !hist->entries[i].path) ||
-         (path && hist->entries[i].path && !strcmp(path, hist->entries[i].path));
-
-      // Core name can have changed while still being the same core.
-      // Differentiate based on the core path only.
-      if (equal_path && !strcmp(hist->entries[i].core_path, core_path))
-      {
-         if (i == 0)
-            return;
-
-         // Seen it before, bump to top.
-         struct rom_history_entry tmp = hist->entries[i];
-         memmove(hist->entries + 1, hist->entries,
-               i * sizeof(struct rom_history_entry));
-         hist->entries[0] = tmp;
+      if (write_file(hist->conf_path, job->data, job->size))
+         remove(hist->journal_path);
+      else
+         RARCH_ERR("Failed to write history: \"%s\".\n", hist->conf_path);
+   }
+   else
+   {
+      FILE *file = fopen(hist->journal_path, "a");
+      if (!file)
          return;
-      }
+
+      fwrite(job->data, 1, job->size, file);
+      fclose(file);
    }
+}
 
-   if (hist->size == hist->cap)
+static void rom_history_free_jobs(struct rom_history_job *job)
+{
+   while (job)
    {
-      rom_history_free_entry(&hist->entries[hist->cap - 1]);
-      hist->size--;
+      struct rom_history_job *next = job->next;
+      free(job->data);
+      free(job);
+      job = next;
    }
+}
 
-   memmove(hist->entries + 1, hist->entries,
-         (hist->cap - 1) * sizeof(struct rom_history_entry));
+#ifdef HAVE_THREADS
+static void rom_history_thread(void *data)
+{
+   rom_history_t *hist = (rom_history_t*)data;
 
-   hist->entries[0].path      = path ? strdup(path) : NULL;
-   hist->entries[0].core_path = strdup(core_path);
-   hist->entries[0].core_name = strdup(core_name);
-   hist->size++;
+   slock_lock(hist->lock);
+   for (;;)
+   {
+      while (!hist->jobs && !hist->quit)
+         scond_wait(hist->cond, hist->lock);
+
+      struct rom_history_job *job = hist->jobs;
+      if (!job)
+         break;
+
+      hist->jobs = job->next;
+      if (!hist->jobs)
+         hist->jobs_tail = &hist->jobs;
+
+      slock_unlock(hist->lock);
+      rom_history_run_job(hist, job);
+      job->next = NULL;
+      rom_history_free_jobs(job);
+      slock_lock(hist->lock);
+   }
+   slock_unlock(hist->lock);
 }
+#endif
 
-static void rom_history_write_file(rom_history_t *hist)
+// Hands a write to the writer thread, or does it right away without threads.
+static void rom_history_queue(rom_history_t *hist, char *data, size_t size, bool snapshot)
 {
-   size_t i;
-   FILE *file = fopen(hist->conf_path, "w");
-   if (!file)
+   struct rom_history_job *job = (struct rom_history_job*)calloc(1, sizeof(*job));
+   if (!job)
+   {
+      free(data);
       return;
+   }
+
+   job->data     = data;
+   job->size     = size;
+   job->snapshot = snapshot;
+
+#ifdef HAVE_THREADS
+   if (hist->thread)
+   {
+      slock_lock(hist->lock);
+      *hist->jobs_tail = job;
+      hist->jobs_tail  = &job->next;
+      scond_signal(hist->cond);
+      slock_unlock(hist->lock);
+      return;
+   }
+#endif
+
+   rom_history_run_job(hist, job);
+   rom_history_free_jobs(job);
+}
+
+static char *rom_history_format(const struct rom_history_entry *entry, size_t *size)
+{
+   const char *path = entry->path ? entry->path : "";
+   size_t len = strlen(path) + strlen(entry->core_path) + strlen(entry->core_name) + 4;
+   char *data = (char*)malloc(len);
+   if (!data)
+      return NULL;
+
+   *size = snprintf(data, len, "%s\n%s\n%s\n", path, entry->core_path, entry->core_name);
+   return data;
+}
+
+static void rom_history_compact(rom_history_t *hist)
+{
+   size_t i, size = 0, cap = 1;
+   char *data = NULL;
 
    for (i = 0; i < hist->size; i++)
    {
-      fprintf(file, "%s\n%s\n%s\n",
-            hist->entries[i].path ? hist->entries[i].path : "",
-            hist->entries[i].core_path,
-            hist->entries[i].core_name);
+      const struct rom_history_entry *entry = &hist->entries[hist->order[i]];
+      cap += (entry->path ? strlen(entry->path) : 0) + strlen(entry->core_path) + strlen(entry->core_name) + 3;
    }
 
-   fclose(file);
+   data = (char*)malloc(cap);
+   if (!data)
+      return;
+
+   for (i = 0; i < hist->size; i++)
+   {
+      const struct rom_history_entry *entry = &hist->entries[hist->order[i]];
+      size += snprintf(data + size, cap - size, "%s\n%s\n%s\n",
+            entry->path ? entry->path : "", entry->core_path, entry->core_name);
+   }
+
+   hist->journal_records = 0;
+   rom_history_queue(hist, data, size, true);
+}
+
+void rom_history_push(rom_history_t *hist,
+      const char *path, const char *core_path,
+      const char *core_name)
+{
+   size_t i, slot, pos;
+   if (!hist->cap)
+      return;
+
+   uint32_t hash = rom_history_hash(path, core_path);
+   pos = rom_history_index_find(hist, hash, path, core_path);
+
+   if (hist->index[pos])
+   {
+      // Seen it before, bump to top.
+      slot = hist->index[pos] - 1;
+      for (i = 0; hist->order[i] != slot; i++);
+      if (i == 0)
+         return;
+
+      memmove(hist->order + 1, hist->order, i * sizeof(*hist->order));
+      hist->order[0] = slot;
+   }
+   else
+   {
+      if (hist->size == hist->cap)
+      {
+         // Evict the oldest entry and reuse its slot.
+         slot = hist->order[--hist->size];
+         struct rom_history_entry *old = &hist->entries[slot];
+         rom_history_index_remove(hist, rom_history_index_find(hist, old->hash, old->path, old->core_path));
+         rom_history_free_entry(old);
+         pos = rom_history_index_find(hist, hash, path, core_path);
+      }
+      else
+         slot = hist->size;
+
+      struct rom_history_entry *entry = &hist->entries[slot];
+      entry->path      = path ? strdup(path) : NULL;
+      entry->core_path = strdup(core_path);
+      entry->core_name = strdup(core_name);
+      entry->hash      = hash;
+      hist->index[pos] = slot + 1;
+
+      memmove(hist->order + 1, hist->order, hist->size * sizeof(*hist->order));
+      hist->order[0] = slot;
+      hist->size++;
+   }
+
+   if (hist->loading || !hist->journal_path)
+      return;
+
+   if (++hist->journal_records >= hist->cap)
+      rom_history_compact(hist);
+   else
+   {
+      size_t size;
+      char *data = rom_history_format(&hist->entries[hist->order[0]], &size);
+      if (data)
+         rom_history_queue(hist, data, size, false);
+   }
 }
 
 void rom_history_free(rom_history_t *hist)
@@ -121,13 +353,34 @@ void rom_history_free(rom_history_t *hist)
    if (!hist)
       return;
 
-   if (hist->conf_path)
-      rom_history_write_file(hist);
+#ifdef HAVE_THREADS
+   // The writer drains pending jobs before it quits.
+   if (hist->thread)
+   {
+      slock_lock(hist->lock);
+      hist->quit = true;
+      scond_signal(hist->cond);
+      slock_unlock(hist->lock);
+      sthread_join(hist->thread);
+   }
+   if (hist->lock)
+      slock_free(hist->lock);
+   if (hist->cond)
+      scond_free(hist->cond);
+#endif
+   rom_history_free_jobs(hist->jobs);
+
    free(hist->conf_path);
+   free(hist->journal_path);
 
-   for (i = 0; i < hist->cap; i++)
-      rom_history_free_entry(&hist->entries[i]);
+   if (hist->entries)
+   {
+      for (i = 0; i < hist->cap; i++)
+         rom_history_free_entry(&hist->entries[i]);
+   }
    free(hist->entries);
+   free(hist->order);
+   free(hist->index);
 
    free(hist);
 }
@@ -137,7 +390,11 @@ void rom_history_clear(rom_history_t *hist)
    size_t i;
    for (i = 0; i < hist->cap; i++)
       rom_history_free_entry(&hist->entries[i]);
+   memset(hist->index, 0, (hist->index_mask + 1) * sizeof(*hist->index));
    hist->size = 0;
+
+   if (hist->journal_path)
+      rom_history_compact(hist);
 }
 
 size_t rom_history_size(rom_history_t *hist)
@@ -145,18 +402,28 @@ size_t rom_history_size(rom_history_t *hist)
    return hist->size;
 }
 
-static bool rom_history_read_file(rom_history_t *hist, const char *path)
+size_t rom_history_capacity(rom_history_t *hist)
+{
+   return hist->cap;
+}
+
+const char *rom_history_get_path(rom_history_t *hist)
+{
+   return hist->conf_path;
+}
+
+// Reads records in file order. With append set, each one is pushed on top, like the pushes which wrote them.
+static unsigned rom_history_read_file(rom_history_t *hist, const char *path, bool append)
 {
    FILE *file = fopen(path, "r");
    if (!file)
-      return true;
-   
+      return 0;
+
    char buf[3][PATH_MAX];
-   struct rom_history_entry *entry = NULL;
    char *last = NULL;
-   unsigned i;
+   unsigned i, records = 0;
 
-   for (hist->size = 0; hist->size < hist->cap; )
+   while (append || hist->size < hist->cap)
    {
       for (i = 0; i < 3; i++)
       {
@@ -169,43 +436,81 @@ static bool rom_history_read_file(rom_history_t *hist, const char *path)
             *last = '\0';
       }
 
-      entry = &hist->entries[hist->size];
-
       if (!*buf[1] || !*buf[2])
          continue;
 
-      if (*buf[0])
-         entry->path = strdup(buf[0]);
-      entry->core_path = strdup(buf[1]);
-      entry->core_name = strdup(buf[2]);
-      hist->size++;
+      if (append)
+         rom_history_push(hist, *buf[0] ? buf[0] : NULL, buf[1], buf[2]);
+      else
+      {
+         // The file is most recent first, so entries go to the bottom.
+         const char *entry_path = *buf[0] ? buf[0] : NULL;
+         uint32_t hash = rom_history_hash(entry_path, buf[1]);
+         size_t pos = rom_history_index_find(hist, hash, entry_path, buf[1]);
+         if (hist->index[pos])
+            continue;
+
+         struct rom_history_entry *entry = &hist->entries[hist->size];
+         entry->path      = entry_path ? strdup(entry_path) : NULL;
+         entry->core_path = strdup(buf[1]);
+         entry->core_name = strdup(buf[2]);
+         entry->hash      = hash;
+         hist->index[pos] = hist->size + 1;
+         hist->order[hist->size] = hist->size;
+         hist->size++;
+      }
+      records++;
    }
 
 end:
    fclose(file);
-   return true;
+   return records;
 }
 
 rom_history_t *rom_history_init(const char *path, size_t size)
 {
+   size_t index_size = 4;
    rom_history_t *hist = (rom_history_t*)calloc(1, sizeof(*hist));
    if (!hist)
       return NULL;
 
-   hist->entries = (struct rom_history_entry*)calloc(size, sizeof(*hist->entries));
-   if (!hist->entries)
+   while (index_size < 2 * size)
+      index_size <<= 1;
+
+   hist->entries = (struct rom_history_entry*)calloc(size ? size : 1, sizeof(*hist->entries));
+   hist->order   = (size_t*)calloc(size ? size : 1, sizeof(*hist->order));
+   hist->index   = (size_t*)calloc(index_size, sizeof(*hist->index));
+   if (!hist->entries || !hist->order || !hist->index)
       goto error;
 
-   hist->cap = size;
+   hist->cap        = size;
+   hist->index_mask = index_size - 1;
+   hist->jobs_tail  = &hist->jobs;
 
-   if (!rom_history_read_file(hist, path))
+   hist->conf_path    = strdup(path);
+   hist->journal_path = (char*)malloc(strlen(path) + sizeof(".journal"));
+   if (!hist->conf_path || !hist->journal_path)
       goto error;
+   strcpy(hist->journal_path, path);
+   strcat(hist->journal_path, ".journal");
+
+   hist->loading = true;
+   rom_history_read_file(hist, path, false);
+   hist->journal_records = rom_history_read_file(hist, hist->journal_path, true);
+   hist->loading = false;
+
+#ifdef HAVE_THREADS
+   hist->lock = slock_new();
+   hist->cond = scond_new();
+   if (hist->lock && hist->cond)
+      hist->thread = sthread_create_priority(rom_history_thread, hist, STHREAD_PRIORITY_BACKGROUND);
+#endif
 
-   hist->conf_path = strdup(path);
    return hist;
 
 error:
+   free(hist->journal_path);
+   hist->journal_path = NULL;
    rom_history_free(hist);
    return NULL;
 }
-
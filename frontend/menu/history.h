@@ -30,6 +30,8 @@ void rom_history_free(rom_history_t *hist);
 void rom_history_clear(rom_history_t *hist);
 
 size_t rom_history_size(rom_history_t *hist);
+size_t rom_history_capacity(rom_history_t *hist);
+const char *rom_history_get_path(rom_history_t *hist);
 
 void rom_history_get_index(rom_history_t *hist,
       size_t index,
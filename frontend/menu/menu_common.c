@@ -34,6 +34,8 @@ rgui_handle_t *rgui;
 const menu_driver_t *menugui_driver;
 
 static void menu_parse_and_resolve(void *data, unsigned menu_type);
+static void menu_dir_job_step(rgui_handle_t *rgui);
+static void menu_dir_job_free(rgui_handle_t *rgui);
 
 static void menu_update_system_info(void *data, bool *load_no_rom)
 {
@@ -140,18 +142,27 @@ void load_menu_game_history(unsigned game_index)
 
 static void menu_init_history(void)
 {
+   char history_path[PATH_MAX] = {0};
+
+   if (*g_extern.config_path)
+      fill_pathname_resolve_relative(history_path, g_extern.config_path,
+            "retroarch-game-history.txt", sizeof(history_path));
+
+   // Loading a game reloads the config. Keep the open history unless that moved or resized it,
+   // so the push just journaled for the game is not followed by a rewrite and re-read.
+   if (rgui->history && *history_path &&
+         rom_history_capacity(rgui->history) == g_settings.game_history_size &&
+         !strcmp(rom_history_get_path(rgui->history), history_path))
+      return;
+
    if (rgui->history)
    {
       rom_history_free(rgui->history);
       rgui->history = NULL;
    }
 
-   if (*g_extern.config_path)
+   if (*history_path)
    {
-      char history_path[PATH_MAX];
-      fill_pathname_resolve_relative(history_path, g_extern.config_path,
-               "retroarch-game-history.txt", sizeof(history_path));
-
       RARCH_LOG("[RGUI]: Opening history: %s.\n", history_path);
       rgui->history = rom_history_init(history_path, g_settings.game_history_size);
    }
@@ -159,7 +170,7 @@ static void menu_init_history(void)
 
 static void menu_update_libretro_info(void)
 {
-   retro_get_system_info(&rgui->info);
+   pretro_get_system_info(&rgui->info);
    menu_init_core_info(rgui);
 }
 
@@ -184,6 +195,7 @@ bool load_menu_game(void)
       // Update menu state which depends on config.
       menu_update_libretro_info();
       menu_init_history();
+      config_cache_flush(g_extern.config_cache);
 
       return true;
    }
@@ -214,6 +226,7 @@ void menu_init(void *video_data)
 
    rgui->menu_stack = (file_list_t*)calloc(1, sizeof(file_list_t));
    rgui->selection_buf = (file_list_t*)calloc(1, sizeof(file_list_t));
+   rgui->dir_cache = dir_list_cache_new();
    file_list_push(rgui->menu_stack, "", RGUI_SETTINGS, 0);
    menu_clear_navigation(rgui);
    menu_populate_entries(rgui, RGUI_SETTINGS);
@@ -234,6 +247,8 @@ void menu_free(void *video_data)
 {
    file_list_free(rgui->menu_stack);
    file_list_free(rgui->selection_buf);
+   menu_dir_job_free(rgui);
+   dir_list_cache_free(rgui->dir_cache);
 
    rom_history_free(rgui->history);
    core_info_list_free(rgui->core_info);
@@ -704,14 +719,14 @@ static int menu_iterate_func(void *data, void *video_data, unsigned action)
                {
                   fill_pathname_join(rgui->deferred_path, dir, path, sizeof(rgui->deferred_path));
 
-                  const core_info_t *info = NULL;
+                  const core_info_t **info = NULL;
                   size_t supported = 0;
                   if (rgui->core_info)
                      core_info_list_get_supported_cores(rgui->core_info, rgui->deferred_path, &info, &supported);
 
                   if (supported == 1) /* Can make a decision right now. */
                   {
-                     if (!load_menu_game_new_core(rgui->deferred_path, info->path))
+                     if (!load_menu_game_new_core(rgui->deferred_path, info[0]->path))
                         menu_flush_stack_type(rgui, RGUI_SETTINGS);
                      rgui->msg_force = true;
                      ret = -1;
@@ -765,6 +780,8 @@ static int menu_iterate_func(void *data, void *video_data, unsigned action)
       rgui->need_refresh = false;
       menu_parse_and_resolve(rgui, menu_type);
    }
+   else if (rgui->dir_job.stream)
+      menu_dir_job_step(rgui);
 
    if (video_data && menugui_driver && menugui_driver->render)
       menugui_driver->render(rgui, video_data);
@@ -1042,6 +1059,9 @@ void menu_populate_entries(void *data, unsigned menu_type)
    rgui_handle_t *rgui = (rgui_handle_t*)data;
    unsigned i;
    char tmp[256];
+
+   menu_dir_job_free(rgui);
+
    switch (menu_type)
    {
       case RGUI_SETTINGS_CONFIG_OPTIONS:
@@ -1123,6 +1143,7 @@ void menu_populate_entries(void *data, unsigned menu_type)
          snprintf(tmp, sizeof(tmp), "Compiler: GCC (%d.%d.%d) %u-bit", __GNUC__, __GNUC_MINOR__, __GNUC_PATCHLEVEL__, (unsigned)(CHAR_BIT * sizeof(size_t)));         
          file_list_push(rgui->selection_buf, tmp, RGUI_SETTINGS_SYSTEM_INFO_NONE, 0);
 
+#if defined(HW_RVL) || defined(HW_DOL)
          snprintf(tmp, sizeof(tmp), "MEM1 (Used/Total): %2dMB / %2dMB (%8d bytes/%8d bytes)", (SYSMEM1_SIZE - SYS_GetArena1Size())/MB_SIZE, SYSMEM1_SIZE/MB_SIZE,
                   SYSMEM1_SIZE - SYS_GetArena1Size(), SYSMEM1_SIZE);
          file_list_push(rgui->selection_buf, tmp, RGUI_SETTINGS_SYSTEM_INFO_NONE, 0);
@@ -1130,6 +1151,7 @@ void menu_populate_entries(void *data, unsigned menu_type)
          snprintf(tmp, sizeof(tmp), "MEM2 (Used/Total): %2dMB / %2dMB (%8d bytes/%8d bytes)", gx_mem2_used()/MB_SIZE, gx_mem2_total()/MB_SIZE,
                   gx_mem2_used(), gx_mem2_total());
          file_list_push(rgui->selection_buf, tmp, RGUI_SETTINGS_SYSTEM_INFO_NONE, 0);
+#endif
 
          snprintf(tmp, sizeof(tmp), "Current core: %s", rgui->core_info_current.data ? rgui->core_info_current.display_name : rgui->info.library_name);
          file_list_push(rgui->selection_buf, tmp, RGUI_SETTINGS_SYSTEM_INFO_NONE, 0);
@@ -1315,9 +1337,144 @@ void menu_populate_entries(void *data, unsigned menu_type)
    }
 }
 
+// Pushes a listing from dir_list into selection_buf.
+static void menu_push_dir_list(rgui_handle_t *rgui, const struct string_list *list,
+      const char *dir, unsigned menu_type)
+{
+   size_t i;
+   for (i = 0; i < list->size; i++)
+   {
+      bool is_dir = list->elems[i].attr.b;
+
+      if ((menu_type_is(menu_type) == RGUI_FILE_DIRECTORY) && !is_dir)
+         continue;
+
+      // Need to preserve slash first time.
+      const char *path = list->elems[i].data;
+      if (*dir)
+         path = path_basename(path);
+
+#ifdef HAVE_LIBRETRO_MANAGEMENT
+      if (menu_type == RGUI_SETTINGS_CORE && (is_dir || strcasecmp(path, SALAMANDER_FILE) == 0))
+         continue;
+#endif
+
+      // Push menu_type further down in the chain.
+      // Needed for shader manager currently.
+      file_list_push(rgui->selection_buf, path,
+            is_dir ? menu_type : RGUI_FILE_PLAIN, 0);
+   }
+}
+
+// Large directories are listed a batch at a time, giving each frame a bounded slice of work.
+// The Wii has a single core and neither file_list nor libfat are thread safe, so this runs on the menu loop.
+#define MENU_DIR_JOB_BATCH 32
+#define MENU_DIR_JOB_BUDGET_USEC 4000
+
+static inline char menu_ascii_tolower(char c)
+{
+   return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+// Same order as dir_list_sort(list, true).
+static int menu_dir_entry_cmp(const char *a, unsigned a_type, const char *b, unsigned b_type)
+{
+   int a_dir = a_type != RGUI_FILE_PLAIN;
+   int b_dir = b_type != RGUI_FILE_PLAIN;
+   if (a_dir != b_dir)
+      return b_dir - a_dir;
+
+   while (*a && menu_ascii_tolower(*a) == menu_ascii_tolower(*b))
+   {
+      a++;
+      b++;
+   }
+
+   return (uint8_t)menu_ascii_tolower(*a) - (uint8_t)menu_ascii_tolower(*b);
+}
+
+static void menu_dir_job_free(rgui_handle_t *rgui)
+{
+   struct rgui_dir_job *job = &rgui->dir_job;
+   dir_list_stream_free(job->stream);
+   dir_list_free(job->listing);
+   free(job->dir);
+   free(job->exts);
+   memset(job, 0, sizeof(*job));
+}
+
+static void menu_dir_job_step(rgui_handle_t *rgui)
+{
+   struct rgui_dir_job *job = &rgui->dir_job;
+   retro_time_t start = rarch_get_time_usec();
+   size_t mid = rgui->selection_buf->size;
+   int ret = -1;
+
+   struct string_list *batch = string_list_new_arena();
+   if (batch)
+   {
+      do
+      {
+         ret = dir_list_stream_read(job->stream, batch, MENU_DIR_JOB_BATCH);
+      } while (ret > 0 && rarch_get_time_usec() - start < MENU_DIR_JOB_BUDGET_USEC);
+
+      dir_list_sort(batch, true);
+      menu_push_dir_list(rgui, batch, job->dir, job->menu_type);
+
+      if (job->restoring && rgui->selection_ptr != job->restore_last)
+         job->restoring = false; // Moved by the user.
+
+      file_list_merge(rgui->selection_buf, job->start, mid, menu_dir_entry_cmp,
+            job->restoring ? NULL : &rgui->selection_ptr);
+
+      if (ret >= 0 && !dir_list_merge(job->listing, batch))
+         ret = -1;
+      dir_list_free(batch);
+   }
+
+   if (job->restoring)
+   {
+      size_t size = rgui->selection_buf->size;
+      job->restore_last = size ? min(job->restore_ptr, size - 1) : 0;
+      menu_set_navigation(rgui, job->restore_last);
+   }
+
+   menu_build_scroll_indices(rgui, rgui->selection_buf);
+
+   if (ret == 0)
+      dir_list_cache_store(rgui->dir_cache, job->dir, job->exts, true, job->listing, job->start_time);
+   if (ret <= 0)
+      menu_dir_job_free(rgui);
+}
+
+static void menu_dir_job_start(rgui_handle_t *rgui, dir_list_stream_t *stream,
+      const char *dir, const char *exts, unsigned menu_type, time_t start_time)
+{
+   struct rgui_dir_job *job = &rgui->dir_job;
+
+   job->stream      = stream;
+   job->listing     = string_list_new_arena();
+   job->dir         = strdup(dir);
+   job->exts        = exts ? strdup(exts) : NULL;
+   job->menu_type   = menu_type;
+   job->start_time  = start_time;
+   job->start       = rgui->selection_buf->size;
+   job->restore_ptr = rgui->selection_ptr;
+   job->restoring   = true;
+   job->restore_last = rgui->selection_ptr;
+
+   if (!job->listing || !job->dir || (exts && !job->exts))
+   {
+      menu_dir_job_free(rgui);
+      return;
+   }
+
+   menu_dir_job_step(rgui);
+}
+
 static void menu_parse_and_resolve(void *data, unsigned menu_type)
 {
-   const core_info_t *info = NULL;
+   const core_info_t **info = NULL;
    const char *dir;
    size_t i, list_size;
    file_list_t *list;
@@ -1326,6 +1483,7 @@ static void menu_parse_and_resolve(void *data, unsigned menu_type)
    rgui = (rgui_handle_t*)data;
    dir = NULL;
 
+   menu_dir_job_free(rgui);
    file_list_clear(rgui->selection_buf);
 
    // parsing switch
@@ -1409,39 +1567,33 @@ static void menu_parse_and_resolve(void *data, unsigned menu_type)
             else
                exts = g_extern.system.valid_extensions;
 
-            struct string_list *list = dir_list_new(dir, exts, true);
+            // The core list is small and gets sorted on display names below, so it is read in one go.
+            time_t start_time = time(NULL);
+            dir_list_stream_t *stream = NULL;
+            struct string_list *list = menu_type == RGUI_SETTINGS_CORE ?
+               dir_list_cache_get(rgui->dir_cache, dir, exts, true) :
+               dir_list_cache_lookup(rgui->dir_cache, dir, exts, true);
+
             if (!list)
-               return;
+            {
+               if (menu_type == RGUI_SETTINGS_CORE)
+                  return;
 
-            dir_list_sort(list, true);
+               stream = dir_list_stream_new(dir, exts, true);
+               if (!stream)
+                  return;
+            }
 
             if (menu_type_is(menu_type) == RGUI_FILE_DIRECTORY)
                file_list_push(rgui->selection_buf, "<Use this directory>", RGUI_FILE_USE_DIRECTORY, 0);
 
-            for (i = 0; i < list->size; i++)
+            if (list)
             {
-               bool is_dir = list->elems[i].attr.b;
-
-               if ((menu_type_is(menu_type) == RGUI_FILE_DIRECTORY) && !is_dir)
-                  continue;
-
-               // Need to preserve slash first time.
-               const char *path = list->elems[i].data;
-               if (*dir)
-                  path = path_basename(path);
-
-#ifdef HAVE_LIBRETRO_MANAGEMENT
-               if (menu_type == RGUI_SETTINGS_CORE && (is_dir || strcasecmp(path, SALAMANDER_FILE) == 0))
-                  continue;
-#endif
-
-               // Push menu_type further down in the chain.
-               // Needed for shader manager currently.
-               file_list_push(rgui->selection_buf, path,
-                     is_dir ? menu_type : RGUI_FILE_PLAIN, 0);
+               menu_push_dir_list(rgui, list, dir, menu_type);
+               dir_list_free(list);
             }
-
-            string_list_free(list);
+            else
+               menu_dir_job_start(rgui, stream, dir, exts, menu_type, start_time);
          }
    }
 
@@ -1476,8 +1628,8 @@ static void menu_parse_and_resolve(void *data, unsigned menu_type)
          core_info_list_get_supported_cores(rgui->core_info, rgui->deferred_path, &info, &list_size);
          for (i = 0; i < list_size; i++)
          {
-            file_list_push(rgui->selection_buf, info[i].path, RGUI_FILE_PLAIN, 0);
-            file_list_set_alt_at_offset(rgui->selection_buf, i, info[i].display_name);
+            file_list_push(rgui->selection_buf, info[i]->path, RGUI_FILE_PLAIN, 0);
+            file_list_set_alt_at_offset(rgui->selection_buf, i, info[i]->display_name);
          }
          file_list_sort_on_alt(rgui->selection_buf);
          break;
@@ -236,6 +236,23 @@ void menu_poll_bind_get_rested_axes(struct rgui_bind_state *state);
 void menu_poll_bind_state(struct rgui_bind_state *state);
 bool menu_poll_find_trigger(struct rgui_bind_state *state, struct rgui_bind_state *new_state);
 
+// Directory being listed into selection_buf a few entries per frame.
+struct rgui_dir_job
+{
+   dir_list_stream_t *stream;
+   struct string_list *listing; // Everything read so far, sorted. Goes to dir_cache when done.
+   char *dir;
+   char *exts;
+   unsigned menu_type;
+   time_t start_time;
+   size_t start; // First entry of selection_buf belonging to the listing.
+
+   // Selection to return to when coming back to the directory, applied as the listing fills in.
+   size_t restore_ptr;
+   size_t restore_last;
+   bool restoring;
+};
+
 typedef struct
 {
    uint64_t old_input_state;
@@ -256,6 +273,8 @@ typedef struct
    file_list_t *selection_buf;
    size_t selection_ptr;
    bool need_refresh;
+   dir_list_cache_t *dir_cache; // Listings of recently visited directories.
+   struct rgui_dir_job dir_job;
    bool msg_force;
 
    core_info_list_t *core_info;
@@ -0,0 +1,342 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host-side microbenchmark for string_list and file_list storage and file_list_search().
+// Compares a strdup() per element against the arena backed lists, counting heap allocations,
+// and the old linear strcasestr() search against the search index.
+// Also checks that the search finds the same entries as the old one and that sorting orders by name.
+// Build with the Makefile in this directory. Prints a markdown table to stdout and
+// exits non-zero if a check fails.
+
+#define _GNU_SOURCE
+#include "../../../file_path.h"
+#include "../file_list.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MIN_SECONDS 0.5
+
+static unsigned failures;
+
+#define CHECK(cond, ...) do { \
+      if (!(cond)) \
+      { \
+         fprintf(stderr, "FAIL: " __VA_ARGS__); \
+         fprintf(stderr, "\n"); \
+         failures++; \
+      } \
+   } while (0)
+
+static const unsigned sizes[] = { 64, 512, 5000 };
+
+static double get_time(void)
+{
+   struct timespec tv;
+   clock_gettime(CLOCK_MONOTONIC, &tv);
+   return tv.tv_sec + tv.tv_nsec / 1000000000.0;
+}
+
+static void make_name(char *buf, size_t size, unsigned i)
+{
+   snprintf(buf, size, "Some Game Title %u (USA) (Rev %u).smc", i * 7919u % 100000, i % 3);
+}
+
+// The old file_list: one strdup() per path, freed one by one on clear.
+struct legacy_item
+{
+   char *path;
+   unsigned type;
+};
+
+struct legacy_list
+{
+   struct legacy_item *list;
+   size_t size;
+   size_t capacity;
+   unsigned allocs;
+};
+
+static void legacy_push(struct legacy_list *list, const char *path, unsigned type)
+{
+   if (list->size >= list->capacity)
+   {
+      list->capacity++;
+      list->capacity *= 2;
+      list->list = (struct legacy_item*)realloc(list->list, list->capacity * sizeof(*list->list));
+      list->allocs++;
+   }
+
+   list->list[list->size].path = strdup(path);
+   list->list[list->size].type = type;
+   list->size++;
+   list->allocs++;
+}
+
+static void legacy_clear(struct legacy_list *list)
+{
+   size_t i;
+   for (i = 0; i < list->size; i++)
+      free(list->list[i].path);
+   list->size = 0;
+}
+
+static void bench_file_list(unsigned entries, char (*names)[64])
+{
+   unsigned runs, i;
+   double start, legacy_time, pool_time;
+   unsigned legacy_allocs, pool_allocs;
+
+   // Refilling the same list, like selection_buf on every menu refresh.
+   struct legacy_list legacy = {0};
+   start = get_time();
+   for (runs = 0; get_time() - start < MIN_SECONDS; runs++)
+   {
+      legacy_clear(&legacy);
+      for (i = 0; i < entries; i++)
+         legacy_push(&legacy, names[i], 0);
+   }
+   legacy_time   = (get_time() - start) / runs;
+   legacy_allocs = legacy.allocs / runs;
+   legacy_clear(&legacy);
+   free(legacy.list);
+
+   file_list_t *list = (file_list_t*)calloc(1, sizeof(*list));
+   start = get_time();
+   for (runs = 0; get_time() - start < MIN_SECONDS; runs++)
+   {
+      file_list_clear(list);
+      for (i = 0; i < entries; i++)
+         file_list_push(list, names[i], 0, 0);
+   }
+   pool_time   = (get_time() - start) / runs;
+   pool_allocs = list->allocs / runs;
+   file_list_free(list);
+
+   printf("| file_list refill | %u | %u | %u | %.1f | %.1f |\n", entries,
+         legacy_allocs, pool_allocs, legacy_time * 1000000.0, pool_time * 1000000.0);
+}
+
+static void bench_string_list(unsigned entries, char (*names)[64])
+{
+   unsigned runs, i;
+   double start, times[2];
+   unsigned allocs[2];
+   int arena;
+
+   // Building and freeing a list, like string_split() and dir_list_new().
+   for (arena = 0; arena < 2; arena++)
+   {
+      allocs[arena] = 0;
+      start = get_time();
+      for (runs = 0; get_time() - start < MIN_SECONDS; runs++)
+      {
+         struct string_list *list = arena ? string_list_new_arena() : string_list_new();
+         union string_list_elem_attr attr;
+         attr.i = 0;
+         for (i = 0; i < entries; i++)
+            string_list_append(list, names[i], attr);
+         allocs[arena] += list->allocs;
+         string_list_free(list);
+      }
+      times[arena]  = (get_time() - start) / runs;
+      allocs[arena] /= runs;
+   }
+
+   printf("| string_list build and free | %u | %u | %u | %.1f | %.1f |\n", entries,
+         allocs[0], allocs[1], times[0] * 1000000.0, times[1] * 1000000.0);
+}
+
+// The old file_list_search(), a strcasestr() over every label.
+static bool legacy_search(const file_list_t *list, const char *needle, size_t *index)
+{
+   size_t i;
+   const char *alt;
+   bool ret = false;
+   for (i = 0; i < list->size; i++)
+   {
+      file_list_get_alt_at_offset(list, i, &alt);
+
+      const char *str = strcasestr(alt, needle);
+      if (str == alt)
+      {
+         *index = i;
+         return true;
+      }
+      else if (str && !ret)
+      {
+         *index = i;
+         ret = true;
+      }
+   }
+
+   return ret;
+}
+
+// Every needle is searched twice, once by the scan and once through the index.
+static void check_search(file_list_t *list, const char *desc, const char **needles, unsigned num_needles)
+{
+   unsigned n, pass;
+   for (n = 0; n < num_needles; n++)
+   {
+      size_t want = 0;
+      bool want_found = legacy_search(list, needles[n], &want);
+
+      list->generation++;
+      for (pass = 0; pass < 2; pass++)
+      {
+         size_t got = 0;
+         bool got_found = file_list_search(list, needles[n], &got);
+         CHECK(got_found == want_found && (!want_found || got == want),
+               "%s list, %s search for \"%s\": got %s %u, expected %s %u", desc,
+               pass ? "indexed" : "first", needles[n], got_found ? "entry" : "nothing", (unsigned)got,
+               want_found ? "entry" : "nothing", (unsigned)want);
+      }
+   }
+}
+
+static void check_list(unsigned entries, char (*names)[64])
+{
+   unsigned i;
+   static const char *needles[] = {
+      "some game title 4", "SOME GAME TITLE 99", "(rev 2)", "title 1", "rev", "usa) (REV 1",
+      ".smc", "s", "e", "no such game", "some game title 1000000",
+   };
+   unsigned num_needles = sizeof(needles) / sizeof(needles[0]);
+
+   file_list_t *list = (file_list_t*)calloc(1, sizeof(*list));
+   for (i = 0; i < entries; i++)
+   {
+      file_list_push(list, names[i], 0, 0);
+      // Mixed case labels, some only matching needles mid-string.
+      if (i % 5 == 0)
+      {
+         char alt[80];
+         snprintf(alt, sizeof(alt), "%s %s", i % 2 ? "A" : "the", names[i]);
+         file_list_set_alt_at_offset(list, i, alt);
+      }
+   }
+
+   check_search(list, "unsorted", needles, num_needles);
+
+   file_list_sort_on_alt(list);
+   CHECK(list->size == entries, "sorting changed the list size to %u", (unsigned)list->size);
+   for (i = 1; i < list->size; i++)
+   {
+      const char *a, *b;
+      file_list_get_alt_at_offset(list, i - 1, &a);
+      file_list_get_alt_at_offset(list, i, &b);
+      CHECK(strcasecmp(a, b) <= 0, "sorted list has \"%s\" before \"%s\"", a, b);
+   }
+
+   check_search(list, "sorted", needles, num_needles);
+   file_list_free(list);
+}
+
+static void bench_search(unsigned entries, char (*names)[64])
+{
+   unsigned runs, i;
+   size_t index;
+   double start, legacy_time, index_time, scan_time, build_time;
+   unsigned found = 0;
+   static const char *needles[] = { "some game title 4", "(rev 2)", "SOME GAME TITLE 99" };
+   unsigned num_needles = sizeof(needles) / sizeof(needles[0]);
+
+   file_list_t *list = (file_list_t*)calloc(1, sizeof(*list));
+   for (i = 0; i < entries; i++)
+      file_list_push(list, names[i], 0, 0);
+
+   start = get_time();
+   for (runs = 0; get_time() - start < MIN_SECONDS; runs++)
+      found += legacy_search(list, needles[runs % num_needles], &index);
+   legacy_time = (get_time() - start) / runs;
+
+   // Any change to the list invalidates the index. The first search after one scans,
+   // the second builds the index.
+   start = get_time();
+   for (runs = 0; get_time() - start < MIN_SECONDS; runs++)
+   {
+      list->generation++;
+      found += file_list_search(list, needles[runs % num_needles], &index);
+   }
+   scan_time = (get_time() - start) / runs;
+
+   start = get_time();
+   for (runs = 0; get_time() - start < MIN_SECONDS; runs++)
+   {
+      list->generation++;
+      found += file_list_search(list, needles[runs % num_needles], &index);
+      found += file_list_search(list, needles[runs % num_needles], &index);
+   }
+   build_time = (get_time() - start) / runs - scan_time;
+
+   start = get_time();
+   for (runs = 0; get_time() - start < MIN_SECONDS; runs++)
+      found += file_list_search(list, needles[runs % num_needles], &index);
+   index_time = (get_time() - start) / runs;
+
+   file_list_free(list);
+   CHECK(found, "nothing found in %u entries", entries);
+
+   printf("| %u | %.2f | %.2f | %.2f | %.2f |\n", entries,
+         legacy_time * 1000000.0, scan_time * 1000000.0, build_time * 1000000.0, index_time * 1000000.0);
+}
+
+int main(void)
+{
+   unsigned s, i;
+
+   printf("List storage benchmark. Heap allocations and time per operation.\n\n");
+   printf("| Operation | Entries | strdup allocs | Arena allocs | strdup us | Arena us |\n");
+   printf("|-----------|---------|---------------|--------------|-----------|----------|\n");
+
+   for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+   {
+      unsigned entries = sizes[s];
+      char (*names)[64] = calloc(entries, sizeof(*names));
+      if (!names)
+         return 1;
+
+      for (i = 0; i < entries; i++)
+         make_name(names[i], sizeof(names[i]), i);
+
+      bench_string_list(entries, names);
+      bench_file_list(entries, names);
+      free(names);
+   }
+
+   printf("\nfile_list_search(), us per search. Mix of prefix and mid-string needles.\n\n");
+   printf("| Entries | strcasestr scan | First search after a change | Second search (builds index) | Indexed |\n");
+   printf("|---------|-----------------|-----------------------------|------------------------------|---------|\n");
+
+   for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+   {
+      unsigned entries = sizes[s];
+      char (*names)[64] = calloc(entries, sizeof(*names));
+      if (!names)
+         return 1;
+
+      for (i = 0; i < entries; i++)
+         make_name(names[i], sizeof(names[i]), i);
+
+      check_list(entries, names);
+      bench_search(entries, names);
+      free(names);
+   }
+
+   printf("\n%s\n", failures ? "FAILED" : "All checks passed.");
+   return failures ? 1 : 0;
+}
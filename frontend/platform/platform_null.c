@@ -0,0 +1,64 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2014 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host platform for headless builds (see --benchmark). Everything lives under
+// ./retroarch in the working directory, there is no device mounting or exec.
+
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include "../../driver.h"
+#include "../../general.h"
+#include "../../console/rarch_console.h"
+#include "../../file.h"
+
+static void get_environment_settings(int argc, char *argv[], void *args)
+{
+   (void)argc;
+   (void)argv;
+   (void)args;
+
+   if (!getcwd(default_paths.core_dir, sizeof(default_paths.core_dir)))
+      strlcpy(default_paths.core_dir, ".", sizeof(default_paths.core_dir));
+
+   fill_pathname_join(default_paths.port_dir, default_paths.core_dir, "retroarch", sizeof(default_paths.port_dir));
+   fill_pathname_join(g_extern.config_path, default_paths.port_dir, "retroarch.cfg", sizeof(g_extern.config_path));
+   fill_pathname_join(default_paths.system_dir, default_paths.port_dir, "system", sizeof(default_paths.system_dir));
+   fill_pathname_join(default_paths.sram_dir, default_paths.port_dir, "savefiles", sizeof(default_paths.sram_dir));
+   fill_pathname_join(default_paths.savestate_dir, default_paths.port_dir, "savefiles", sizeof(default_paths.savestate_dir));
+}
+
+static int system_process_args(int argc, char *argv[], void *args)
+{
+   (void)args;
+
+   if (argc > 1 && argv[1] != NULL && argv[1][0] != '-')
+   {
+      strlcpy(g_extern.fullpath, argv[1], sizeof(g_extern.fullpath));
+      return 1;
+   }
+
+   return 0;
+}
+
+const frontend_ctx_driver_t frontend_ctx_null = {
+   get_environment_settings,        /* get_environment_settings */
+   NULL,                            /* init */
+   NULL,                            /* exitspawn */
+   system_process_args,             /* process_args */
+   NULL,                            /* exec */
+   "null",
+};
@@ -24,6 +24,7 @@
 #include "driver.h"
 #include "message_queue.h"
 #include "rewind.h"
+#include "movie.h"
 #include "dynamic.h"
 #include "compat/strl.h"
 #include "performance.h"
@@ -64,6 +65,14 @@ enum config_type_enums
    CONFIG_PER_GAME,
 };
 
+enum audio_resampler_mode
+{
+   AUDIO_RESAMPLER_QUALITY = 0,
+   AUDIO_RESAMPLER_FAST,
+   AUDIO_RESAMPLER_SLOW,
+   AUDIO_RESAMPLER_DROP,
+};
+
 typedef struct rarch_viewport
 {
    int x;
@@ -91,6 +100,9 @@ struct settings
       int pos_x;
       int pos_y;
       bool vsync;
+      bool threaded;
+      // Present every Nth frame while fast-forwarding, 0 presents at most once per refresh.
+      unsigned fastforward_frameskip;
       bool bilinear_filter;
       bool force_aspect;
       bool crop_overscan;
@@ -111,6 +123,8 @@ struct settings
       bool mute;
       bool sync;
       bool rate_control;
+      bool fast_resampler;
+      bool fastforward_mute;
       char resampler[32];
       char driver[32];
    } audio;
@@ -128,6 +142,7 @@ struct settings
       unsigned device[MAX_PLAYERS];
       char device_names[MAX_PLAYERS][64];
       bool autoconf_buttons;
+      bool lazy_poll;
       bool menu_all_players_enable;
       unsigned quick_swap_players;
       
@@ -164,8 +179,10 @@ struct settings
    int state_slot;
    size_t rewind_buffer_size;
    unsigned rewind_granularity;
+   unsigned movie_checksum_interval;
 
    bool rewind_enable;
+   bool rewind_fastforward;
    bool block_sram_overwrite;
    bool savestate_auto_save;
    bool savestate_auto_load;
@@ -196,6 +213,7 @@ struct global
 
    // Config associated with global and specific config.
    char config_path[PATH_MAX];
+   struct config_cache *config_cache; // Parsed configs and core info, see config_cache_new().
    char specific_config_path[PATH_MAX];   
    char basename[PATH_MAX];
    char fullpath[PATH_MAX];
@@ -239,6 +257,16 @@ struct global
       void *resampler_data;
       const rarch_resampler_t *resampler;
 
+      // Cheap resamplers used while fast-forwarding and in slowmotion.
+      void *fast_resampler_data;
+      const rarch_resampler_t *fast_resampler;
+      void *slow_resampler_data;
+      const rarch_resampler_t *slow_resampler;
+      unsigned resampler_mode;
+      unsigned fade_mode;
+      unsigned fade_frames;
+      float *fade_outsamples;
+
       float *data;
 
       size_t data_ptr;
@@ -283,6 +311,19 @@ struct global
    size_t state_size;
    bool frame_is_reverse;
 
+   // Input movie recording and playback.
+   struct
+   {
+      bsv_movie_t *movie;
+      char movie_path[PATH_MAX];
+      bool movie_playback;
+      // Stop playback on the first state checksum mismatch.
+      bool movie_verify;
+   } bsv;
+
+   // CRC32 of the loaded content, read back from its path if the core loads from path. 0 if unreadable.
+   uint32_t content_crc;
+
    bool sram_load_disable;
    bool sram_save_disable;
    bool use_sram;
@@ -292,6 +333,24 @@ struct global
    bool is_oneshot;
    bool is_slowmotion;
 
+   // Input of all ports, resolved once per poll by input_snapshot_poll().
+   struct
+   {
+      // Copy of the binds with analog D-pad modes applied.
+      struct retro_keybind binds[MAX_PLAYERS][RARCH_BIND_LIST_END];
+      uint64_t bound[MAX_PLAYERS]; // Bind IDs mapped to a button or axis.
+      uint64_t buttons[MAX_PLAYERS]; // Bit per bind ID. Hotkeys only on port 0.
+      int16_t analog[MAX_PLAYERS][2][2];
+      uint64_t keys_last; // Hotkeys held during the previous frame.
+      bool compiled;
+
+      // Lazy polling, see input_lazy_poll.
+      retro_perf_tick_t frame_start;
+      bool in_core_run;
+      bool poll_pending;
+      bool polled;
+   } input;
+
    // Turbo support
    bool turbo_frame_enable[MAX_PLAYERS];
    uint16_t turbo_enable[MAX_PLAYERS];
@@ -300,6 +359,18 @@ struct global
    frame_t frame_cache;
    frame_t frame;
    
+   // Fast-forward presentation and speed reporting.
+   struct
+   {
+      retro_time_t start;
+      retro_time_t last_frame;
+      retro_time_t last_present;
+      retro_time_t report_start;
+      unsigned frames;
+      unsigned presented;
+      unsigned report_frames;
+   } fastforward;
+
    unsigned frame_count;
    uint32_t start_frame_time;
    uint64_t lifecycle_state;
@@ -314,6 +385,11 @@ struct global
    jmp_buf error_sjlj_context;
    bool libretro_no_rom;
    bool libretro_dummy;
+   // Use the built-in synthetic core instead of the linked one (--stress).
+   bool libretro_stress;
+
+   // Number of frames to run headless with --benchmark. 0 if disabled.
+   unsigned benchmark_frames;
 };
 
 struct rarch_main_wrap
@@ -351,6 +427,9 @@ void rarch_main_deinit(void);
 void rarch_render_cached_frame(void);
 void rarch_init_msg_queue(void);
 void rarch_deinit_msg_queue(void);
+#ifdef HAVE_TRACE
+void rarch_dump_trace(void);
+#endif
 void rarch_input_poll(void);
 void rarch_check_block_hotkey(void);
 void rarch_init_rewind(void);
@@ -0,0 +1,480 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frame_pacing.h"
+#include "../general.h"
+#include "../performance.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_THREADS
+#include "../thread.h"
+#endif
+
+struct frame_pacer
+{
+   const frame_pacer_backend_t *backend;
+   void *data;
+
+   uint32_t armed;
+   retro_time_t last_vblank;
+   struct frame_pacer_stats stats;
+
+   frame_pacer_t *next;
+};
+
+// Live pacers, reported by rarch_perf_log(). Only touched when a video driver is created or freed.
+static frame_pacer_t *pacer_list;
+
+static void frame_pacer_record_vblank(frame_pacer_t *pacer);
+
+#if defined(HW_RVL) || defined(HW_DOL)
+#include <ogc/lwp.h>
+#include <ogc/machine/processor.h>
+
+// Same scheme as VIDEO_WaitVSync(): sleep on a thread queue with interrupts off,
+// the retrace interrupt bumps the count and wakes the queue.
+typedef struct gx_pacer
+{
+   lwpq_t queue;
+   volatile uint32_t count;
+} gx_pacer_t;
+
+static void *gx_pacer_init(frame_pacer_t *pacer, float refresh_rate)
+{
+   (void)pacer;
+   (void)refresh_rate;
+
+   gx_pacer_t *gx = (gx_pacer_t*)calloc(1, sizeof(*gx));
+   if (!gx)
+      return NULL;
+
+   LWP_InitQueue(&gx->queue);
+   return gx;
+}
+
+static void gx_pacer_free(void *data)
+{
+   gx_pacer_t *gx = (gx_pacer_t*)data;
+   LWP_CloseQueue(gx->queue);
+   free(gx);
+}
+
+static uint32_t gx_pacer_count(void *data)
+{
+   return ((gx_pacer_t*)data)->count;
+}
+
+static void gx_pacer_wait(void *data, uint32_t last)
+{
+   gx_pacer_t *gx = (gx_pacer_t*)data;
+   uint32_t level;
+
+   _CPU_ISR_Disable(level);
+   while (gx->count == last)
+      LWP_ThreadSleep(gx->queue);
+   _CPU_ISR_Restore(level);
+}
+
+static void gx_pacer_signal(void *data)
+{
+   gx_pacer_t *gx = (gx_pacer_t*)data;
+   gx->count++;
+   LWP_ThreadBroadcast(gx->queue);
+}
+
+static const frame_pacer_backend_t frame_pacer_gx = {
+   gx_pacer_init,
+   gx_pacer_free,
+   gx_pacer_count,
+   gx_pacer_wait,
+   gx_pacer_signal,
+   "gx",
+};
+#endif
+
+#ifdef HAVE_THREADS
+typedef struct cond_pacer
+{
+   slock_t *lock;
+   scond_t *cond;
+   uint32_t count;
+} cond_pacer_t;
+
+static bool cond_pacer_setup(cond_pacer_t *cp)
+{
+   cp->lock = slock_new();
+   cp->cond = scond_new();
+   return cp->lock && cp->cond;
+}
+
+static void cond_pacer_teardown(cond_pacer_t *cp)
+{
+   scond_free(cp->cond);
+   slock_free(cp->lock);
+}
+
+static void *cond_pacer_init(frame_pacer_t *pacer, float refresh_rate)
+{
+   (void)pacer;
+   (void)refresh_rate;
+
+   cond_pacer_t *cp = (cond_pacer_t*)calloc(1, sizeof(*cp));
+   if (!cp)
+      return NULL;
+
+   if (!cond_pacer_setup(cp))
+   {
+      cond_pacer_teardown(cp);
+      free(cp);
+      return NULL;
+   }
+
+   return cp;
+}
+
+static void cond_pacer_free(void *data)
+{
+   cond_pacer_teardown((cond_pacer_t*)data);
+   free(data);
+}
+
+static uint32_t cond_pacer_count(void *data)
+{
+   cond_pacer_t *cp = (cond_pacer_t*)data;
+   slock_lock(cp->lock);
+   uint32_t count = cp->count;
+   slock_unlock(cp->lock);
+   return count;
+}
+
+static void cond_pacer_wait(void *data, uint32_t last)
+{
+   cond_pacer_t *cp = (cond_pacer_t*)data;
+   slock_lock(cp->lock);
+   while (cp->count == last)
+      scond_wait(cp->cond, cp->lock);
+   slock_unlock(cp->lock);
+}
+
+static void cond_pacer_signal(void *data)
+{
+   cond_pacer_t *cp = (cond_pacer_t*)data;
+   slock_lock(cp->lock);
+   cp->count++;
+   scond_broadcast(cp->cond);
+   slock_unlock(cp->lock);
+}
+
+static const frame_pacer_backend_t frame_pacer_cond = {
+   cond_pacer_init,
+   cond_pacer_free,
+   cond_pacer_count,
+   cond_pacer_wait,
+   cond_pacer_signal,
+   "cond",
+};
+
+// cond pacer driven by a thread ticking at the refresh rate, for drivers without a vblank source.
+typedef struct sim_pacer
+{
+   cond_pacer_t cp; // Must be first, the cond functions are reused.
+   frame_pacer_t *pacer;
+   retro_time_t period;
+
+   sthread_t *thread;
+   slock_t *stop_lock;
+   scond_t *stop_cond;
+   bool stop;
+} sim_pacer_t;
+
+static void sim_pacer_tick(void *data)
+{
+   sim_pacer_t *sim = (sim_pacer_t*)data;
+   retro_time_t next = rarch_get_time_usec() + sim->period;
+
+   slock_lock(sim->stop_lock);
+   while (!sim->stop)
+   {
+      retro_time_t now = rarch_get_time_usec();
+      if (now < next)
+      {
+         scond_wait_timeout(sim->stop_cond, sim->stop_lock, next - now);
+         continue;
+      }
+
+      // Not frame_pacer_vblank(), pacer->data is not set yet when the first tick can fire.
+      slock_unlock(sim->stop_lock);
+      frame_pacer_record_vblank(sim->pacer);
+      cond_pacer_signal(&sim->cp);
+      slock_lock(sim->stop_lock);
+
+      // Keep phase, unless we fell behind by more than a frame (e.g. stopped in a debugger).
+      next += sim->period;
+      if (now > next)
+         next = now + sim->period;
+   }
+   slock_unlock(sim->stop_lock);
+}
+
+static void sim_pacer_free(void *data)
+{
+   sim_pacer_t *sim = (sim_pacer_t*)data;
+
+   if (sim->thread)
+   {
+      slock_lock(sim->stop_lock);
+      sim->stop = true;
+      scond_signal(sim->stop_cond);
+      slock_unlock(sim->stop_lock);
+      sthread_join(sim->thread);
+   }
+
+   scond_free(sim->stop_cond);
+   slock_free(sim->stop_lock);
+   cond_pacer_teardown(&sim->cp);
+   free(sim);
+}
+
+static void *sim_pacer_init(frame_pacer_t *pacer, float refresh_rate)
+{
+   sim_pacer_t *sim = (sim_pacer_t*)calloc(1, sizeof(*sim));
+   if (!sim)
+      return NULL;
+
+   sim->pacer = pacer;
+   sim->period = (retro_time_t)(1000000.0f / (refresh_rate > 0.0f ? refresh_rate : 60.0f));
+   sim->stop_lock = slock_new();
+   sim->stop_cond = scond_new();
+
+   if (!cond_pacer_setup(&sim->cp) || !sim->stop_lock || !sim->stop_cond)
+      goto error;
+
+   sim->thread = sthread_create_priority(sim_pacer_tick, sim, STHREAD_PRIORITY_REALTIME);
+   if (!sim->thread)
+      goto error;
+
+   return sim;
+
+error:
+   sim_pacer_free(sim);
+   return NULL;
+}
+
+static const frame_pacer_backend_t frame_pacer_sim = {
+   sim_pacer_init,
+   sim_pacer_free,
+   cond_pacer_count,
+   cond_pacer_wait,
+   cond_pacer_signal,
+   "sim",
+};
+#endif
+
+// Fallback without any way to sleep, what gx_frame() used to do.
+typedef struct spin_pacer
+{
+   volatile uint32_t count;
+} spin_pacer_t;
+
+static void *spin_pacer_init(frame_pacer_t *pacer, float refresh_rate)
+{
+   (void)pacer;
+   (void)refresh_rate;
+   return calloc(1, sizeof(spin_pacer_t));
+}
+
+static void spin_pacer_free(void *data)
+{
+   free(data);
+}
+
+static uint32_t spin_pacer_count(void *data)
+{
+   return ((spin_pacer_t*)data)->count;
+}
+
+static void spin_pacer_wait(void *data, uint32_t last)
+{
+   spin_pacer_t *spin = (spin_pacer_t*)data;
+   while (spin->count == last);
+}
+
+static void spin_pacer_signal(void *data)
+{
+   ((spin_pacer_t*)data)->count++;
+}
+
+static const frame_pacer_backend_t frame_pacer_spin = {
+   spin_pacer_init,
+   spin_pacer_free,
+   spin_pacer_count,
+   spin_pacer_wait,
+   spin_pacer_signal,
+   "spin",
+};
+
+static const frame_pacer_backend_t *pacer_backends[] = {
+#if defined(HW_RVL) || defined(HW_DOL)
+   &frame_pacer_gx,
+#endif
+#ifdef HAVE_THREADS
+   &frame_pacer_cond,
+   &frame_pacer_sim,
+#endif
+   &frame_pacer_spin,
+   NULL,
+};
+
+#if defined(PERF_TEST) || !defined(RARCH_INTERNAL)
+// Waits happen on the video thread when threaded video is on. Registering touches
+// shared lists, so the counter is registered up front from frame_pacer_new() instead.
+static struct rarch_perf_counter vblank_wait = {{"vblank_wait"}};
+#endif
+
+frame_pacer_t *frame_pacer_new(const char *ident, float refresh_rate)
+{
+   unsigned i;
+   const frame_pacer_backend_t *backend = NULL;
+
+   for (i = 0; pacer_backends[i]; i++)
+   {
+      if (!ident || !strcmp(pacer_backends[i]->ident, ident))
+      {
+         backend = pacer_backends[i];
+         break;
+      }
+   }
+
+   if (!backend)
+   {
+      RARCH_ERR("Frame pacing backend \"%s\" is not available.\n", ident);
+      return NULL;
+   }
+
+   frame_pacer_t *pacer = (frame_pacer_t*)calloc(1, sizeof(*pacer));
+   if (!pacer)
+      return NULL;
+
+   pacer->backend = backend;
+   pacer->data = backend->init(pacer, refresh_rate);
+   if (!pacer->data)
+   {
+      RARCH_ERR("Failed to initialize frame pacing backend \"%s\".\n", backend->ident);
+      free(pacer);
+      return NULL;
+   }
+
+#if defined(PERF_TEST) || !defined(RARCH_INTERNAL)
+   rarch_perf_register(&vblank_wait);
+#endif
+
+   pacer->next = pacer_list;
+   pacer_list = pacer;
+
+   RARCH_LOG("Frame pacing: %s.\n", backend->ident);
+   return pacer;
+}
+
+void frame_pacer_free(frame_pacer_t *pacer)
+{
+   frame_pacer_t **link;
+   if (!pacer)
+      return;
+
+   for (link = &pacer_list; *link; link = &(*link)->next)
+   {
+      if (*link == pacer)
+      {
+         *link = pacer->next;
+         break;
+      }
+   }
+
+   pacer->backend->free(pacer->data);
+   free(pacer);
+}
+
+static void frame_pacer_record_vblank(frame_pacer_t *pacer)
+{
+   retro_time_t now = rarch_get_time_usec();
+   struct frame_pacer_stats *stats = &pacer->stats;
+
+   if (stats->vblanks)
+   {
+      uint64_t interval = now - pacer->last_vblank;
+      if (!stats->interval_min || interval < stats->interval_min)
+         stats->interval_min = interval;
+      if (interval > stats->interval_max)
+         stats->interval_max = interval;
+      stats->interval_total += interval;
+   }
+
+   pacer->last_vblank = now;
+   stats->vblanks++;
+}
+
+void frame_pacer_vblank(frame_pacer_t *pacer)
+{
+   frame_pacer_record_vblank(pacer);
+   pacer->backend->signal(pacer->data);
+}
+
+void frame_pacer_arm(frame_pacer_t *pacer)
+{
+   pacer->armed = pacer->backend->count(pacer->data);
+}
+
+void frame_pacer_wait(frame_pacer_t *pacer)
+{
+   uint32_t count = pacer->backend->count(pacer->data);
+
+   // A vblank went by since the last flip, so the previous frame was shown more than once.
+   if (count != pacer->armed)
+   {
+      pacer->stats.missed += count - pacer->armed;
+      return;
+   }
+
+   RARCH_PERFORMANCE_START(vblank_wait);
+   pacer->backend->wait(pacer->data, count);
+   RARCH_PERFORMANCE_STOP(vblank_wait);
+   pacer->stats.waits++;
+}
+
+const struct frame_pacer_stats *frame_pacer_get_stats(frame_pacer_t *pacer)
+{
+   return &pacer->stats;
+}
+
+void frame_pacer_log(frame_pacer_t *pacer)
+{
+   const struct frame_pacer_stats *stats = &pacer->stats;
+
+   RARCH_LOG("[PERF]: Frame pacing (%s): %u vblanks, interval min/avg/max %.3f / %.3f / %.3f ms.\n",
+         pacer->backend->ident, (unsigned)stats->vblanks,
+         stats->interval_min / 1000.0,
+         stats->vblanks > 1 ? stats->interval_total / (1000.0 * (stats->vblanks - 1)) : 0.0,
+         stats->interval_max / 1000.0);
+   RARCH_LOG("[PERF]: Frame pacing (%s): %u waits, %u missed vblanks.\n",
+         pacer->backend->ident, (unsigned)stats->waits, (unsigned)stats->missed);
+}
+
+void frame_pacer_log_active(void)
+{
+   frame_pacer_t *pacer;
+   for (pacer = pacer_list; pacer; pacer = pacer->next)
+      frame_pacer_log(pacer);
+}
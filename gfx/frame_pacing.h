@@ -0,0 +1,67 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RARCH_FRAME_PACING_H__
+#define RARCH_FRAME_PACING_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Blocks a video driver until the next vblank instead of spinning on a flag.
+// The display interrupt (or a simulated one) calls frame_pacer_vblank(),
+// the driver calls frame_pacer_wait() before flipping and frame_pacer_arm() after.
+
+typedef struct frame_pacer frame_pacer_t;
+
+typedef struct frame_pacer_backend
+{
+   void *(*init)(frame_pacer_t *pacer, float refresh_rate);
+   void (*free)(void *data);
+   uint32_t (*count)(void *data);
+   // Sleeps until the vblank count differs from last.
+   void (*wait)(void *data, uint32_t last);
+   // Bumps the vblank count and wakes waiters. Called from the vblank interrupt on GX.
+   void (*signal)(void *data);
+   const char *ident;
+} frame_pacer_backend_t;
+
+struct frame_pacer_stats
+{
+   uint32_t vblanks;
+   uint32_t waits;
+   uint32_t missed;
+
+   uint64_t interval_min;
+   uint64_t interval_max;
+   uint64_t interval_total;
+};
+
+// ident selects the backend, NULL picks the platform default. 
+// refresh_rate is only used by the simulated vblank.
+frame_pacer_t *frame_pacer_new(const char *ident, float refresh_rate);
+void frame_pacer_free(frame_pacer_t *pacer);
+
+void frame_pacer_vblank(frame_pacer_t *pacer);
+// Next wait blocks until a vblank newer than now. Call right after flipping.
+void frame_pacer_arm(frame_pacer_t *pacer);
+void frame_pacer_wait(frame_pacer_t *pacer);
+
+const struct frame_pacer_stats *frame_pacer_get_stats(frame_pacer_t *pacer);
+void frame_pacer_log(frame_pacer_t *pacer);
+// Logs every live pacer, part of rarch_perf_log().
+void frame_pacer_log_active(void);
+
+#endif
+
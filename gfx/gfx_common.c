@@ -20,8 +20,13 @@
 
 bool gfx_get_fps(char *buf_fps, size_t size_fps)
 {
+#if defined(HW_RVL) || defined(HW_DOL)
    uint32_t now = gettime();
    uint32_t delta = diff_usec(g_extern.start_frame_time, now);
+#else
+   uint32_t now = (uint32_t)rarch_get_time_usec();
+   uint32_t delta = now - g_extern.start_frame_time;
+#endif
    
    if (delta > 1000000)
    {
@@ -26,6 +26,16 @@ extern "C" {
 
 #define SWAPU(a,b) {unsigned t=a;a=b;b=t;}
 
+#if !defined(HW_RVL) && !defined(HW_DOL)
+// The resolution table lives in gx_video.c. Host builds only have the AUTO entry.
+#include <limits.h>
+#define GX_RESOLUTIONS_FIRST      0
+#define GX_RESOLUTIONS_LAST       0
+#define GX_RESOLUTIONS_AUTO       GX_RESOLUTIONS_LAST
+#define GX_RESOLUTIONS_RGUI       UINT_MAX
+#define GX_RESOLUTIONS_LAST_HIRES GX_RESOLUTIONS_LAST
+#endif
+
 enum aspect_ratio
 {
    ASPECT_RATIO_4_3 = 0,
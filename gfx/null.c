@@ -0,0 +1,213 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Null video driver. Accepts frames and throws them away.
+// Useful for headless benchmarking (see --benchmark).
+// With vsync on and HAVE_THREADS it paces to a simulated vblank at video_refresh_rate.
+
+#include "../driver.h"
+#include "../general.h"
+#include "frame_pacing.h"
+#include <stdlib.h>
+
+typedef struct null_video
+{
+   unsigned frame_w;
+   unsigned frame_h;
+   unsigned frames;
+
+   bool vsync;
+   frame_pacer_t *pacer;
+} null_video_t;
+
+static bool null_gfx_init(void **data, unsigned scale, bool rgb32)
+{
+   null_video_t *vid = (null_video_t*)*data;
+   (void)scale;
+   (void)rgb32;
+
+   if (!vid)
+   {
+      vid = (null_video_t*)calloc(1, sizeof(*vid));
+      if (!vid)
+      {
+         *data = NULL;
+         return false;
+      }
+
+#ifdef HAVE_THREADS
+      vid->pacer = frame_pacer_new("sim", g_settings.video.refresh_rate);
+#endif
+      vid->vsync = g_settings.video.vsync;
+
+      *data = vid;
+   }
+
+   vid->frame_w = g_extern.system.av_info.geometry.base_width;
+   vid->frame_h = g_extern.system.av_info.geometry.base_height;
+   return true;
+}
+
+static bool null_gfx_frame(void *data, const void *frame,
+      unsigned width, unsigned height, unsigned pitch, const char *msg)
+{
+   null_video_t *vid = (null_video_t*)data;
+   (void)pitch;
+   (void)msg;
+
+   if (frame)
+   {
+      vid->frame_w = width;
+      vid->frame_h = height;
+   }
+
+   if (vid->pacer)
+   {
+      if (vid->vsync)
+         frame_pacer_wait(vid->pacer);
+      frame_pacer_arm(vid->pacer);
+   }
+
+   vid->frames++;
+   g_extern.frame_count++;
+   return true;
+}
+
+static void null_gfx_set_nonblock_state(void *data, bool toggle)
+{
+   null_video_t *vid = (null_video_t*)data;
+   vid->vsync = !toggle && g_settings.video.vsync;
+}
+
+static void null_gfx_free(void *data)
+{
+   null_video_t *vid = (null_video_t*)data;
+   if (vid)
+      frame_pacer_free(vid->pacer);
+   free(vid);
+}
+
+static void null_gfx_set_rotation(void *data, unsigned rotation)
+{
+   (void)data;
+   (void)rotation;
+}
+
+static void null_gfx_viewport_info(void *data, struct rarch_viewport *vp)
+{
+   null_video_t *vid = (null_video_t*)data;
+   vp->x = vp->y = 0;
+   vp->width  = vp->full_width  = vid->frame_w;
+   vp->height = vp->full_height = vid->frame_h;
+}
+
+static void null_gfx_force_viewport_refresh(void *data)
+{
+   (void)data;
+}
+
+static void null_gfx_set_aspect_ratio(void *data, unsigned aspectratio_index)
+{
+   (void)data;
+   (void)aspectratio_index;
+}
+
+static void null_gfx_apply_state_changes(void *data)
+{
+   (void)data;
+}
+
+static void null_gfx_set_texture_frame(void *data, const void *frame, bool rgb32,
+      unsigned width, unsigned height, float alpha)
+{
+   (void)data;
+   (void)frame;
+   (void)rgb32;
+   (void)width;
+   (void)height;
+   (void)alpha;
+}
+
+static void null_gfx_set_texture_enable(void *data, bool enable, bool full_screen)
+{
+   (void)data;
+   (void)enable;
+   (void)full_screen;
+}
+
+static void null_gfx_update_screen_config(void *data, unsigned res_idx, unsigned aspect_idx,
+      bool scale_integer, unsigned orientation)
+{
+   (void)data;
+   (void)res_idx;
+   (void)aspect_idx;
+   (void)scale_integer;
+   (void)orientation;
+}
+
+static void null_gfx_get_resolution_info(void *data, unsigned res_index,
+      unsigned *width, unsigned *height, unsigned *type)
+{
+   null_video_t *vid = (null_video_t*)data;
+   (void)res_index;
+
+   *width  = vid ? vid->frame_w : 640;
+   *height = vid ? vid->frame_h : 480;
+   *type   = 0;
+}
+
+static void null_gfx_set_refresh_rate(void *data, unsigned res_index)
+{
+   (void)data;
+   (void)res_index;
+}
+
+static void null_gfx_match_resolution_auto(unsigned fbWidth, unsigned fbLines)
+{
+   (void)fbWidth;
+   (void)fbLines;
+}
+
+static const video_poke_interface_t null_gfx_poke_interface = {
+   null_gfx_force_viewport_refresh,
+   null_gfx_set_aspect_ratio,
+   null_gfx_apply_state_changes,
+   null_gfx_set_texture_frame,
+   null_gfx_set_texture_enable,
+   null_gfx_update_screen_config,
+   null_gfx_get_resolution_info,
+   null_gfx_set_refresh_rate,
+   null_gfx_match_resolution_auto
+};
+
+static void null_gfx_get_poke_interface(void *data, const video_poke_interface_t **iface)
+{
+   (void)data;
+   *iface = &null_gfx_poke_interface;
+}
+
+const video_driver_t video_null = {
+   .init = null_gfx_init,
+   .frame = null_gfx_frame,
+   .set_nonblock_state = null_gfx_set_nonblock_state,
+   .free = null_gfx_free,
+   .ident = "null",
+   .set_rotation = null_gfx_set_rotation,
+   .viewport_info = null_gfx_viewport_info,
+#ifdef HAVE_OVERLAY
+   .overlay_interface = NULL,
+#endif
+   .poke_interface = null_gfx_get_poke_interface,
+};
@@ -14,6 +14,7 @@
  */
 
 #include "rpng.h"
+#include "../../hash.h"
 #include <zlib.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -0,0 +1,153 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host-side test for frame pacing with the simulated vblank backend.
+// Runs a wait/arm loop like a video driver, once with frames that fit in a vblank
+// and once with frames that take longer, and checks the vblank interval and the
+// missed vblank counts.
+// Build with the Makefile in this directory. Prints a markdown table to stdout and
+// exits non-zero if a check fails.
+
+#include "../../general.h"
+#include "../frame_pacing.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define REFRESH_RATE 100.0f
+#define PERIOD_USEC (1000000.0 / REFRESH_RATE)
+
+struct settings g_settings;
+struct global g_extern;
+
+static unsigned failures;
+
+#define CHECK(cond, ...) do { \
+      if (!(cond)) \
+      { \
+         fprintf(stderr, "FAIL: " __VA_ARGS__); \
+         fprintf(stderr, "\n"); \
+         failures++; \
+      } \
+   } while (0)
+
+static double get_time_usec(void)
+{
+   struct timespec tv;
+   clock_gettime(CLOCK_MONOTONIC, &tv);
+   return tv.tv_sec * 1000000.0 + tv.tv_nsec / 1000.0;
+}
+
+struct run_result
+{
+   unsigned frames;
+   struct frame_pacer_stats stats;
+   double elapsed_usec;
+};
+
+// Stats are cumulative, report the difference over one run.
+static void run(frame_pacer_t *pacer, unsigned frames, unsigned work_usec, struct run_result *res)
+{
+   unsigned i;
+   struct frame_pacer_stats before = *frame_pacer_get_stats(pacer);
+
+   // Line up with a vblank first, like a driver which has been running for a while.
+   frame_pacer_arm(pacer);
+   frame_pacer_wait(pacer);
+   frame_pacer_arm(pacer);
+   before = *frame_pacer_get_stats(pacer);
+
+   double start = get_time_usec();
+   for (i = 0; i < frames; i++)
+   {
+      if (work_usec)
+         usleep(work_usec);
+      frame_pacer_wait(pacer);
+      frame_pacer_arm(pacer);
+   }
+   res->elapsed_usec = get_time_usec() - start;
+   res->frames = frames;
+   res->stats = *frame_pacer_get_stats(pacer);
+
+   res->stats.vblanks -= before.vblanks;
+   res->stats.waits   -= before.waits;
+   res->stats.missed  -= before.missed;
+   res->stats.interval_total -= before.interval_total;
+}
+
+static void print_result(const char *mode, const struct run_result *res)
+{
+   printf("| %-10s | %6u | %7u | %5u | %6u | %13.3f | %13.3f |\n",
+         mode, res->frames, (unsigned)res->stats.vblanks, (unsigned)res->stats.waits,
+         (unsigned)res->stats.missed,
+         res->stats.vblanks ? res->stats.interval_total / (1000.0 * res->stats.vblanks) : 0.0,
+         res->elapsed_usec / res->frames / 1000.0);
+}
+
+int main(void)
+{
+   struct run_result res;
+
+   frame_pacer_t *pacer = frame_pacer_new("sim", REFRESH_RATE);
+   if (!pacer)
+   {
+      fprintf(stderr, "Failed to create sim frame pacer.\n");
+      return 1;
+   }
+
+   printf("Simulated vblank at %.0f Hz (%.3f ms).\n\n", REFRESH_RATE, PERIOD_USEC / 1000.0);
+   printf("| Frame time | Frames | Vblanks | Waits | Missed | Avg vblank ms | Avg frame ms |\n");
+   printf("|------------|--------|---------|-------|--------|---------------|--------------|\n");
+
+   // Frames that fit: one wait per frame, nothing missed, one frame per vblank.
+   run(pacer, 100, 0, &res);
+   print_result("0", &res);
+   CHECK(res.stats.missed == 0, "fast frames missed %u vblanks", (unsigned)res.stats.missed);
+   CHECK(res.stats.waits == res.frames, "fast frames waited %u times for %u frames",
+         (unsigned)res.stats.waits, res.frames);
+   CHECK(res.stats.vblanks >= res.frames - 1 && res.stats.vblanks <= res.frames + 1,
+         "fast frames saw %u vblanks for %u frames", (unsigned)res.stats.vblanks, res.frames);
+
+   // The simulated vblank keeps phase, so the average interval is the period.
+   double avg = res.stats.interval_total / (double)res.stats.vblanks;
+   CHECK(avg > PERIOD_USEC * 0.98 && avg < PERIOD_USEC * 1.02, "vblank interval %.3f ms", avg / 1000.0);
+   CHECK(res.elapsed_usec / res.frames > PERIOD_USEC * 0.95 && res.elapsed_usec / res.frames < PERIOD_USEC * 1.05,
+         "fast frames took %.3f ms each", res.elapsed_usec / res.frames / 1000.0);
+
+   // Frames taking 1.5 vblanks: every vblank is either waited for or counted as missed.
+   run(pacer, 50, (unsigned)(PERIOD_USEC * 1.5), &res);
+   print_result("1.5 vblank", &res);
+   CHECK(res.stats.missed > 0, "slow frames missed no vblanks");
+   int unaccounted = (int)res.stats.vblanks - (int)(res.stats.waits + res.stats.missed);
+   CHECK(unaccounted >= -1 && unaccounted <= 1, "slow frames: %u vblanks, %u waits + %u missed",
+         (unsigned)res.stats.vblanks, (unsigned)res.stats.waits, (unsigned)res.stats.missed);
+   CHECK(res.elapsed_usec / res.frames >= PERIOD_USEC * 1.5 && res.elapsed_usec / res.frames < PERIOD_USEC * 2.2,
+         "slow frames took %.3f ms each", res.elapsed_usec / res.frames / 1000.0);
+
+   // Frames taking 2.5 vblanks: two vblanks per frame go by, at least one is missed each time.
+   run(pacer, 30, (unsigned)(PERIOD_USEC * 2.5), &res);
+   print_result("2.5 vblank", &res);
+   CHECK(res.stats.missed >= res.frames, "slower frames missed %u vblanks in %u frames",
+         (unsigned)res.stats.missed, res.frames);
+   unaccounted = (int)res.stats.vblanks - (int)(res.stats.waits + res.stats.missed);
+   CHECK(unaccounted >= -1 && unaccounted <= 1, "slower frames: %u vblanks, %u waits + %u missed",
+         (unsigned)res.stats.vblanks, (unsigned)res.stats.waits, (unsigned)res.stats.missed);
+
+   frame_pacer_free(pacer);
+
+   printf("\n%s\n", failures ? "FAILED" : "All checks passed.");
+   return failures ? 1 : 0;
+}
@@ -0,0 +1,180 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host-side test for the threaded video wrapper.
+// Drives rarch_threaded_video_frame() with the null video driver, which paces to the
+// simulated vblank when vsync is on. Checks presented and dropped frame counts with
+// vsync and in nonblock (fast-forward) mode.
+// Build with the Makefile in this directory. Prints a markdown table to stdout and
+// exits non-zero if a check fails.
+
+#include "../../general.h"
+#include "../../driver.h"
+#include "../thread_wrapper.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define REFRESH_RATE 100.0f
+#define PERIOD_USEC (1000000.0 / REFRESH_RATE)
+#define FRAME_W 320
+#define FRAME_H 240
+
+struct settings g_settings;
+struct global g_extern;
+driver_t driver;
+
+extern const video_driver_t video_null;
+
+static unsigned failures;
+
+#define CHECK(cond, ...) do { \
+      if (!(cond)) \
+      { \
+         fprintf(stderr, "FAIL: " __VA_ARGS__); \
+         fprintf(stderr, "\n"); \
+         failures++; \
+      } \
+   } while (0)
+
+static double get_time_usec(void)
+{
+   struct timespec tv;
+   clock_gettime(CLOCK_MONOTONIC, &tv);
+   return tv.tv_sec * 1000000.0 + tv.tv_nsec / 1000.0;
+}
+
+static uint16_t frame[FRAME_W * FRAME_H];
+
+struct run_result
+{
+   unsigned submitted;
+   unsigned handed;
+   unsigned dropped;
+   unsigned presented;
+   double elapsed_usec;
+   double max_submit_usec;
+};
+
+// Submits frames for duration_usec, sleeping submit_usec between them to stand in for retro_run().
+static void run(thread_video_t *thr, bool nonblock, double duration_usec, unsigned submit_usec,
+      struct run_result *res)
+{
+   unsigned handed_before, dropped_before;
+   rarch_threaded_video_get_stats(thr, &handed_before, &dropped_before);
+   unsigned presented_before = g_extern.frame_count;
+
+   memset(res, 0, sizeof(*res));
+   driver.nonblock_state = nonblock;
+
+   double start = get_time_usec();
+   while (get_time_usec() - start < duration_usec)
+   {
+      double t = get_time_usec();
+      if (!rarch_threaded_video_frame(thr, frame, FRAME_W, FRAME_H, FRAME_W * sizeof(uint16_t), NULL))
+         failures++;
+      t = get_time_usec() - t;
+      if (t > res->max_submit_usec)
+         res->max_submit_usec = t;
+
+      res->submitted++;
+      if (submit_usec)
+         usleep(submit_usec);
+   }
+   rarch_threaded_video_sync(thr);
+   res->elapsed_usec = get_time_usec() - start;
+
+   rarch_threaded_video_get_stats(thr, &res->handed, &res->dropped);
+   res->handed  -= handed_before;
+   res->dropped -= dropped_before;
+   res->presented = g_extern.frame_count - presented_before;
+}
+
+static void print_result(const char *mode, const struct run_result *res)
+{
+   printf("| %-8s | %9u | %9u | %7u | %8.1f | %10.1f | %11.2f |\n",
+         mode, res->submitted, res->presented, res->dropped, res->elapsed_usec / 1000.0,
+         res->presented ? res->elapsed_usec / res->presented / 1000.0 : 0.0,
+         res->max_submit_usec / 1000.0);
+}
+
+int main(void)
+{
+   struct run_result res;
+
+   g_settings.video.vsync = true;
+   g_settings.video.refresh_rate = REFRESH_RATE;
+   g_extern.system.pix_fmt = RETRO_PIXEL_FORMAT_RGB565;
+   g_extern.system.av_info.geometry.base_width  = FRAME_W;
+   g_extern.system.av_info.geometry.base_height = FRAME_H;
+
+   driver.video = &video_null;
+   if (!driver.video->init(&driver.video_data, 1, false))
+   {
+      fprintf(stderr, "Failed to init null video driver.\n");
+      return 1;
+   }
+   driver.video->poke_interface(driver.video_data, &driver.video_poke);
+
+   thread_video_t *thr = rarch_threaded_video_new();
+   if (!thr)
+   {
+      fprintf(stderr, "Failed to start video thread.\n");
+      return 1;
+   }
+   driver.video_thread = thr;
+
+   printf("Threaded null video, simulated vblank at %.0f Hz.\n\n", REFRESH_RATE);
+   printf("| Mode     | Submitted | Presented | Dropped | Time ms | ms / frame | Max call ms |\n");
+   printf("|----------|-----------|-----------|---------|---------|------------|-------------|\n");
+
+   // Vsync: the main thread is throttled to the vblank, every frame is shown and none dropped.
+   run(thr, false, 500000.0, 0, &res);
+   print_result("vsync", &res);
+   CHECK(res.dropped == 0, "vsync dropped %u frames", res.dropped);
+   CHECK(res.presented == res.submitted, "vsync presented %u of %u frames", res.presented, res.submitted);
+   CHECK(res.handed == res.submitted, "vsync handed %u of %u frames", res.handed, res.submitted);
+   CHECK(res.elapsed_usec / res.presented > PERIOD_USEC * 0.8,
+         "vsync ran faster than the vblank, %.3f ms per frame", res.elapsed_usec / res.presented / 1000.0);
+
+   // Nonblock with the driver still waiting on vblank: the main thread must not block,
+   // frames it cannot hand over are dropped.
+   run(thr, true, 500000.0, 1000, &res);
+   print_result("nonblock", &res);
+   CHECK(res.dropped > 0, "nonblock dropped no frames");
+   CHECK(res.handed + res.dropped == res.submitted, "nonblock handed %u + dropped %u != submitted %u",
+         res.handed, res.dropped, res.submitted);
+   CHECK(res.presented == res.handed, "nonblock presented %u of %u handed frames", res.presented, res.handed);
+   CHECK(res.presented <= res.elapsed_usec / PERIOD_USEC + 2, "nonblock presented %u frames in %.1f ms",
+         res.presented, res.elapsed_usec / 1000.0);
+   CHECK(res.max_submit_usec < PERIOD_USEC / 2, "nonblock submit blocked for %.3f ms",
+         res.max_submit_usec / 1000.0);
+
+   // Back to vsync: nothing is dropped anymore.
+   run(thr, false, 200000.0, 0, &res);
+   print_result("vsync", &res);
+   CHECK(res.dropped == 0, "vsync after nonblock dropped %u frames", res.dropped);
+   CHECK(res.presented == res.submitted, "vsync after nonblock presented %u of %u frames",
+         res.presented, res.submitted);
+
+   rarch_threaded_video_free(thr);
+   driver.video_thread = NULL;
+   driver.video->free(driver.video_data);
+
+   printf("\n%s\n", failures ? "FAILED" : "All checks passed.");
+   return failures ? 1 : 0;
+}
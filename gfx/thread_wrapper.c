@@ -0,0 +1,403 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "thread_wrapper.h"
+#include "../thread.h"
+#include "../general.h"
+#include "../driver.h"
+#include "../trace.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct thread_video
+{
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond_cmd;
+   scond_t *cond_done;
+
+   bool alive;
+   bool busy; // Frame handed to the worker and not presented yet.
+   bool frame_ok;
+
+   // The menu draws into its texture from the main thread, present it synchronously.
+   bool sync_frames;
+
+   uint8_t *buffer;
+   size_t buffer_size;
+   bool has_frame;
+   unsigned width;
+   unsigned height;
+   size_t pitch;
+   char msg[256];
+   bool has_msg;
+
+   unsigned frames;
+   unsigned dropped;
+
+   const video_poke_interface_t *poke;
+#ifdef HAVE_OVERLAY
+   const video_overlay_interface_t *overlay;
+#endif
+};
+
+static bool thread_present(thread_video_t *thr)
+{
+   const void *frame = thr->has_frame ? thr->buffer : NULL;
+   unsigned width    = thr->width;
+   unsigned height   = thr->height;
+   size_t pitch      = thr->pitch;
+
+#ifdef HAVE_SCALERS_BUILTIN
+   if (frame && g_extern.filter.filter && *g_extern.basename)
+   {
+      rarch_softfilter_get_output_size(g_extern.filter.filter,
+            &width, &height, thr->width, thr->height);
+      pitch = width * g_extern.filter.out_bpp;
+
+      RARCH_TRACE_BEGIN(RARCH_TRACE_SOFTFILTER);
+      rarch_softfilter_process(g_extern.filter.filter,
+            g_extern.filter.buffer, pitch,
+            frame, thr->width, thr->height, thr->pitch);
+      RARCH_TRACE_END(RARCH_TRACE_SOFTFILTER);
+
+      frame = g_extern.filter.buffer;
+   }
+#endif
+
+   return driver.video->frame(driver.video_data, frame, width, height, pitch,
+         thr->has_msg ? thr->msg : NULL);
+}
+
+static void thread_loop(void *data)
+{
+   thread_video_t *thr = (thread_video_t*)data;
+
+   rarch_trace_set_thread(RARCH_TRACE_THREAD_VIDEO);
+
+   slock_lock(thr->lock);
+   for (;;)
+   {
+      while (thr->alive && !thr->busy)
+         scond_wait(thr->cond_cmd, thr->lock);
+
+      if (!thr->alive)
+         break;
+
+      // Main thread does not touch the frame while busy is set.
+      slock_unlock(thr->lock);
+      bool ret = thread_present(thr);
+      slock_lock(thr->lock);
+
+      thr->frame_ok = ret;
+      thr->busy = false;
+      scond_signal(thr->cond_done);
+   }
+   slock_unlock(thr->lock);
+}
+
+thread_video_t *rarch_threaded_video_new(void)
+{
+   thread_video_t *thr = (thread_video_t*)calloc(1, sizeof(*thr));
+   if (!thr)
+      return NULL;
+
+   thr->alive = true;
+   thr->frame_ok = true;
+   thr->poke = driver.video_poke;
+#ifdef HAVE_OVERLAY
+   if (driver.video->overlay_interface)
+      driver.video->overlay_interface(driver.video_data, &thr->overlay);
+#endif
+
+   thr->lock      = slock_new();
+   thr->cond_cmd  = scond_new();
+   thr->cond_done = scond_new();
+   if (!thr->lock || !thr->cond_cmd || !thr->cond_done)
+      goto error;
+
+   // Ahead of emulation so conversion starts as soon as a frame is handed over.
+   // The vblank wait sleeps, so this does not starve the main thread.
+   thr->thread = sthread_create_priority(thread_loop, thr, STHREAD_PRIORITY_REALTIME);
+   if (!thr->thread)
+      goto error;
+
+   RARCH_LOG("Started video thread.\n");
+   return thr;
+
+error:
+   RARCH_ERR("Failed to start video thread.\n");
+   rarch_threaded_video_free(thr);
+   return NULL;
+}
+
+void rarch_threaded_video_free(thread_video_t *thr)
+{
+   if (!thr)
+      return;
+
+   if (thr->thread)
+   {
+      slock_lock(thr->lock);
+      while (thr->busy)
+         scond_wait(thr->cond_done, thr->lock);
+      thr->alive = false;
+      scond_signal(thr->cond_cmd);
+      slock_unlock(thr->lock);
+
+      sthread_join(thr->thread);
+      RARCH_LOG("Video thread presented %u frames, dropped %u.\n", thr->frames, thr->dropped);
+   }
+
+   scond_free(thr->cond_cmd);
+   scond_free(thr->cond_done);
+   slock_free(thr->lock);
+   free(thr->buffer);
+   free(thr);
+}
+
+void rarch_threaded_video_sync(thread_video_t *thr)
+{
+   slock_lock(thr->lock);
+   while (thr->busy)
+      scond_wait(thr->cond_done, thr->lock);
+   slock_unlock(thr->lock);
+}
+
+void rarch_threaded_video_get_stats(thread_video_t *thr, unsigned *frames, unsigned *dropped)
+{
+   slock_lock(thr->lock);
+   *frames  = thr->frames;
+   *dropped = thr->dropped;
+   slock_unlock(thr->lock);
+}
+
+bool rarch_threaded_video_frame(thread_video_t *thr, const void *frame,
+      unsigned width, unsigned height, size_t pitch, const char *msg)
+{
+   bool ret;
+
+   slock_lock(thr->lock);
+
+   // Fast-forward must not be throttled by presentation, drop instead of waiting.
+   if (thr->busy && driver.nonblock_state && !thr->sync_frames)
+   {
+      thr->dropped++;
+      ret = thr->frame_ok;
+      slock_unlock(thr->lock);
+      return ret;
+   }
+
+   // When syncing to vblank this is where the main thread is throttled,
+   // one frame behind instead of inside retro_run().
+   while (thr->busy)
+      scond_wait(thr->cond_done, thr->lock);
+
+   ret = thr->frame_ok;
+
+   thr->has_frame = frame != NULL;
+   if (frame)
+   {
+      // The core's last row is only width * bpp long, the padding after it need not exist.
+      unsigned bpp = g_extern.system.pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888 ? 4 : 2;
+      size_t size = height ? (height - 1) * pitch + width * bpp : 0;
+      if (size > thr->buffer_size)
+      {
+         uint8_t *buffer = (uint8_t*)realloc(thr->buffer, size);
+         if (!buffer)
+         {
+            slock_unlock(thr->lock);
+            return false;
+         }
+         thr->buffer = buffer;
+         thr->buffer_size = size;
+      }
+      memcpy(thr->buffer, frame, size);
+   }
+
+   thr->width  = width;
+   thr->height = height;
+   thr->pitch  = pitch;
+
+   thr->has_msg = msg != NULL;
+   if (msg)
+      strlcpy(thr->msg, msg, sizeof(thr->msg));
+
+   thr->frames++;
+   thr->busy = true;
+   scond_signal(thr->cond_cmd);
+
+   if (thr->sync_frames)
+   {
+      while (thr->busy)
+         scond_wait(thr->cond_done, thr->lock);
+      ret = thr->frame_ok;
+   }
+
+   slock_unlock(thr->lock);
+   return ret;
+}
+
+// Poke and overlay calls run on the main thread once the worker is idle.
+
+static void thread_force_viewport_refresh(void *data)
+{
+   thread_video_t *thr = driver.video_thread;
+   rarch_threaded_video_sync(thr);
+   thr->poke->force_viewport_refresh(data);
+}
+
+static void thread_set_aspect_ratio(void *data, unsigned aspectratio_index)
+{
+   thread_video_t *thr = driver.video_thread;
+   rarch_threaded_video_sync(thr);
+   thr->poke->set_aspect_ratio(data, aspectratio_index);
+}
+
+static void thread_apply_state_changes(void *data)
+{
+   thread_video_t *thr = driver.video_thread;
+   rarch_threaded_video_sync(thr);
+   thr->poke->apply_state_changes(data);
+}
+
+static void thread_set_texture_frame(void *data, const void *frame, bool rgb32,
+      unsigned width, unsigned height, float alpha)
+{
+   thread_video_t *thr = driver.video_thread;
+   rarch_threaded_video_sync(thr);
+   thr->poke->set_texture_frame(data, frame, rgb32, width, height, alpha);
+}
+
+static void thread_set_texture_enable(void *data, bool enable, bool full_screen)
+{
+   thread_video_t *thr = driver.video_thread;
+   rarch_threaded_video_sync(thr);
+   thr->sync_frames = enable;
+   thr->poke->set_texture_enable(data, enable, full_screen);
+}
+
+static void thread_update_screen_config(void *data, unsigned res_idx, unsigned aspect_idx,
+      bool scale_integer, unsigned orientation)
+{
+   thread_video_t *thr = driver.video_thread;
+   rarch_threaded_video_sync(thr);
+   thr->poke->update_screen_config(data, res_idx, aspect_idx, scale_integer, orientation);
+}
+
+static void thread_get_resolution_info(void *data, unsigned res_index,
+      unsigned *width, unsigned *height, unsigned *type)
+{
+   thread_video_t *thr = driver.video_thread;
+   rarch_threaded_video_sync(thr);
+   thr->poke->get_resolution_info(data, res_index, width, height, type);
+}
+
+static void thread_set_refresh_rate(void *data, unsigned res_index)
+{
+   thread_video_t *thr = driver.video_thread;
+   rarch_threaded_video_sync(thr);
+   thr->poke->set_refresh_rate(data, res_index);
+}
+
+static void thread_match_resolution_auto(unsigned fbWidth, unsigned fbLines)
+{
+   thread_video_t *thr = driver.video_thread;
+   rarch_threaded_video_sync(thr);
+   thr->poke->match_resolution_auto(fbWidth, fbLines);
+}
+
+static const video_poke_interface_t thread_poke = {
+   thread_force_viewport_refresh,
+   thread_set_aspect_ratio,
+   thread_apply_state_changes,
+   thread_set_texture_frame,
+   thread_set_texture_enable,
+   thread_update_screen_config,
+   thread_get_resolution_info,
+   thread_set_refresh_rate,
+   thread_match_resolution_auto,
+};
+
+void rarch_threaded_video_get_poke_interface(thread_video_t *thr, const video_poke_interface_t **iface)
+{
+   *iface = thr->poke ? &thread_poke : NULL;
+}
+
+#ifdef HAVE_OVERLAY
+static void thread_overlay_enable(void *data, bool state)
+{
+   thread_video_t *thr = driver.video_thread;
+   rarch_threaded_video_sync(thr);
+   thr->overlay->enable(data, state);
+}
+
+static bool thread_overlay_load(void *data, const struct texture_image *images, unsigned num_images)
+{
+   thread_video_t *thr = driver.video_thread;
+   rarch_threaded_video_sync(thr);
+   return thr->overlay->load(data, images, num_images);
+}
+
+static void thread_overlay_tex_geom(void *data, unsigned image, float x, float y, float w, float h)
+{
+   thread_video_t *thr = driver.video_thread;
+   rarch_threaded_video_sync(thr);
+   thr->overlay->tex_geom(data, image, x, y, w, h);
+}
+
+static void thread_overlay_vertex_geom(void *data, unsigned image, float x, float y, float w, float h)
+{
+   thread_video_t *thr = driver.video_thread;
+   rarch_threaded_video_sync(thr);
+   thr->overlay->vertex_geom(data, image, x, y, w, h);
+}
+
+static void thread_overlay_full_screen(void *data, bool enable)
+{
+   thread_video_t *thr = driver.video_thread;
+   rarch_threaded_video_sync(thr);
+   thr->overlay->full_screen(data, enable);
+}
+
+static void thread_overlay_set_alpha(void *data, unsigned image, float mod)
+{
+   thread_video_t *thr = driver.video_thread;
+   rarch_threaded_video_sync(thr);
+   thr->overlay->set_alpha(data, image, mod);
+}
+
+static void thread_overlay_free(void *data)
+{
+   thread_video_t *thr = driver.video_thread;
+   rarch_threaded_video_sync(thr);
+   thr->overlay->free(data);
+}
+
+static const video_overlay_interface_t thread_overlay = {
+   thread_overlay_enable,
+   thread_overlay_load,
+   thread_overlay_tex_geom,
+   thread_overlay_vertex_geom,
+   thread_overlay_full_screen,
+   thread_overlay_set_alpha,
+   thread_overlay_free,
+};
+
+void rarch_threaded_video_get_overlay_interface(thread_video_t *thr, const video_overlay_interface_t **iface)
+{
+   *iface = thr->overlay ? &thread_overlay : NULL;
+}
+#endif
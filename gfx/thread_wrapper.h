@@ -0,0 +1,51 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RARCH_VIDEO_THREAD_WRAPPER_H__
+#define RARCH_VIDEO_THREAD_WRAPPER_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+
+struct video_poke_interface;
+struct video_overlay_interface;
+
+// Runs the softfilter and driver.video->frame() on a worker thread so they overlap
+// with the next retro_run(). The wrapped driver stays in driver.video/driver.video_data.
+// Every other call into the driver must go through rarch_threaded_video_sync() first,
+// which driver_funcs.h and the wrapped poke/overlay interfaces take care of.
+typedef struct thread_video thread_video_t;
+
+thread_video_t *rarch_threaded_video_new(void);
+void rarch_threaded_video_free(thread_video_t *thr);
+
+// Copies the frame and returns as soon as the worker has picked it up.
+// Waits for the previous frame to be presented unless nonblocking, in which case it drops frames instead.
+bool rarch_threaded_video_frame(thread_video_t *thr, const void *frame,
+      unsigned width, unsigned height, size_t pitch, const char *msg);
+
+// Blocks until the worker is idle.
+void rarch_threaded_video_sync(thread_video_t *thr);
+
+// Frames handed to the worker and frames dropped while it was busy.
+void rarch_threaded_video_get_stats(thread_video_t *thr, unsigned *frames, unsigned *dropped);
+
+void rarch_threaded_video_get_poke_interface(thread_video_t *thr, const struct video_poke_interface **iface);
+#ifdef HAVE_OVERLAY
+void rarch_threaded_video_get_overlay_interface(thread_video_t *thr, const struct video_overlay_interface **iface);
+#endif
+
+#endif
+
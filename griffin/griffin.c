@@ -30,6 +30,14 @@ PERFORMANCE
 ============================================================ */
 #include "../performance.c"
 
+#ifdef HAVE_THREADS
+#include "../thread.c"
+#endif
+
+#ifdef HAVE_TRACE
+#include "../trace.c"
+#endif
+
 /*============================================================
 COMPATIBILITY
 ============================================================ */
@@ -58,8 +66,19 @@ VIDEO DRIVER
 #include "../wii/vi_encoder.c"
 #include "../wii/mem2_manager.c"
 #endif
+#if defined(HW_RVL) || defined(HW_DOL)
 #include "../gx/gx_video.c"
+#endif
 #include "../gfx/gfx_common.c"
+#include "../gfx/frame_pacing.c"
+
+#ifdef HAVE_NULLDRIVERS
+#include "../gfx/null.c"
+#endif
+
+#ifdef HAVE_THREADS
+#include "../gfx/thread_wrapper.c"
+#endif
 
 /*============================================================
 INPUT
@@ -70,18 +89,26 @@ INPUT
 #include "../input/overlay.c"
 #endif
 
+#if defined(HW_RVL) || defined(HW_DOL)
 #include "../gx/gx_gxpad.c"
 #include "../gx/gx_input.c"
+#endif
 #if defined (HW_RVL) && defined(HAVE_WIIUSBPAD)
 #include "../gx/gx_usbpad.c"
 #include "../gx/gx_hid_input.c"
 #endif
 
+#ifdef HAVE_NULLDRIVERS
+#include "../input/null.c"
+#endif
+
 /*============================================================
 AUDIO RESAMPLER
 ============================================================ */
 #include "../audio/resampler.c"
 #include "../audio/sinc.c"
+#include "../audio/linear.c"
+#include "../audio/nearest.c"
 
 /*============================================================
 AUDIO UTILS
@@ -91,7 +118,13 @@ AUDIO UTILS
 /*============================================================
 AUDIO
 ============================================================ */
+#if defined(HW_RVL) || defined(HW_DOL)
 #include "../gx/gx_audio.c"
+#endif
+
+#ifdef HAVE_NULLDRIVERS
+#include "../audio/null.c"
+#endif
 
 /*============================================================
 DRIVERS
@@ -125,6 +158,9 @@ DYNAMIC
 ============================================================ */
 #include "../dynamic.c"
 #include "../dynamic_dummy.c"
+#ifdef HAVE_STRESS_CORE
+#include "../dynamic_stress.c"
+#endif
 
 /*============================================================
 FILE
@@ -148,12 +184,21 @@ REWIND
 ============================================================ */
 #include "../rewind.c"
 
+/*============================================================
+MOVIE
+============================================================ */
+#include "../movie.c"
+
 /*============================================================
 FRONTEND
 ============================================================ */
 
 #include "../frontend/frontend_context.c"
+#if defined(HW_RVL) || defined(HW_DOL)
 #include "../frontend/platform/platform_gx.c"
+#else
+#include "../frontend/platform/platform_null.c"
+#endif
 #ifdef HW_RVL
 #include "../frontend/platform/platform_wii.c"
 #endif
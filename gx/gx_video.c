@@ -20,6 +20,8 @@
 #include "../gfx/fonts/bitmap.h"
 #include "../frontend/menu/menu_common.h"
 #include "../gfx/gfx_common.h"
+#include "../trace.h"
+#include "../gfx/frame_pacing.h"
 #include "gx_video.h"
 #include <gccore.h>
 #include <ogcsys.h>
@@ -96,7 +98,7 @@ static void *g_fb[2];
 static unsigned g_curfb = 0;
 
 static bool g_vsync_state;
-static volatile bool g_vsync;
+static frame_pacer_t *g_pacer;
 #define WAIT_VBLANK true
 #define NO_WAIT false
 
@@ -142,7 +144,8 @@ static uint8_t color_ptr[16] ATTRIBUTE_ALIGN(32)  = {
 static void vblank_cb(uint32_t retrace_count)
 {
    (void)retrace_count;
-   g_vsync = NO_WAIT;
+   if (g_pacer)
+      frame_pacer_vblank(g_pacer);
 }
 
 static void gx_set_refresh_rate(void *data, unsigned res_index)
@@ -587,6 +590,15 @@ static bool gx_init(void **data, unsigned scale, bool rgb32)
          return false;
       }
 
+      /* sleeps until the retrace callback fires instead of spinning */
+      g_pacer = frame_pacer_new(NULL, 0.0f);
+      if (!g_pacer)
+      {
+         free(gx);
+         *data = NULL;
+         return false;
+      }
+
       VIDEO_Init();
       GX_Init(gx_fifo, sizeof(gx_fifo));
       GX_SetPixelFmt(GX_PF_RGB8_Z24, GX_ZC_LINEAR);
@@ -1081,17 +1093,19 @@ static bool gx_frame(void *data, const void *frame,
       
       /* when returning from 
        * menu force syncing */
-      g_vsync = g_vsync_state;
+      frame_pacer_arm(g_pacer);
    }
 
    GX_InvalidateTexAll();
    
    if (!gx->rgui_texture_enable) /* Load the game frame if menu not enabled */
    {
+      RARCH_TRACE_BEGIN(RARCH_TRACE_TEXTURE_CONVERT);
       if (gx->rgb32)
          convert_texture32(frame, game_tex.data, width, height, pitch);
       else 
          convert_texture16(frame, game_tex.data, width, height, pitch);
+      RARCH_TRACE_END(RARCH_TRACE_TEXTURE_CONVERT);
       DCStoreRange(game_tex.data, height * width * gx->bpp);
       GX_CallDispList(display_list, display_list_size);
 #ifdef HAVE_OVERLAY
@@ -1116,8 +1130,11 @@ static bool gx_frame(void *data, const void *frame,
    gx_onscreen_display(gx, msg);
 
    /* wait vertical sync */
-   while (g_vsync == WAIT_VBLANK);
-   g_vsync = g_vsync_state;
+   RARCH_TRACE_BEGIN(RARCH_TRACE_VBLANK_WAIT);
+   if (g_vsync_state)
+      frame_pacer_wait(g_pacer);
+   RARCH_TRACE_END(RARCH_TRACE_VBLANK_WAIT);
+   frame_pacer_arm(g_pacer);
 
    g_curfb ^= 1;
    GX_CopyDisp(g_fb[g_curfb], GX_TRUE);
@@ -1142,6 +1159,10 @@ static void gx_free(void *data)
    GX_Flush();
    VIDEO_SetBlack(true);
    VIDEO_Flush();
+
+   VIDEO_SetPreRetraceCallback(NULL);
+   frame_pacer_free(g_pacer);
+   g_pacer = NULL;
    
    /* game screen texture */
    if (game_tex.data)
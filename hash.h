@@ -18,27 +18,20 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 // Hashes sha256 and outputs a human readable string for comparing with the cheat XML values.
 void sha256_hash(char *out, const uint8_t *in, size_t size);
 
-#ifdef HAVE_ZLIB
-#include <zlib.h>
-
-static inline uint32_t crc32_calculate(const uint8_t *data, size_t length)
-{
-   return crc32(0, data, length);
-}
-
-static inline uint32_t crc32_adjust(uint32_t crc, uint8_t data)
-{
-   // zlib and nall have different assumptions on "sign" for this function.
-   return ~crc32(~crc, &data, 1);
-}
-#else
+// Same CRC32 as zlib's crc32(). Table driven, slice-by-8.
 uint32_t crc32_calculate(const uint8_t *data, size_t length);
+// Incremental version. Start with crc = 0, and feed the result of the previous call back in.
+// crc32_update(crc32_update(0, a, n), b, m) equals crc32_calculate() of a followed by b.
+uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t length);
+// CRC32 of a whole file, read in chunks. Returns false if it cannot be read.
+bool crc32_file(const char *path, uint32_t *crc);
+// Single byte step on the raw (not inverted) CRC register, as used by nall.
 uint32_t crc32_adjust(uint32_t crc, uint8_t data);
-#endif
 
 #endif
 
@@ -193,6 +193,7 @@ void input_joypad_hotplug(unsigned port, unsigned device_type, const char *padna
    msg_queue_push(g_extern.msg_queue, msg, 0, 80);
    
    /* Set controller's name and/or default binding */
+   input_snapshot_invalidate();
    unsigned action = (1ULL << KEYBINDS_ACTION_SET_PAD_NAME);
    action |= g_settings.input.autoconf_buttons ? (1ULL << KEYBINDS_ACTION_SET_DEFAULT_BINDS) : 0;
    
@@ -391,9 +392,9 @@ void input_get_bind_string(char *buf, const struct retro_keybind *bind, unsigned
    }
 }
 
-void input_push_analog_dpad(struct retro_keybind *binds, unsigned mode)
+// Lets the D-pad binds inherit the axes of an analog stick.
+static void input_apply_analog_dpad(struct retro_keybind *binds, unsigned mode)
 {
-   unsigned i;
    unsigned analog_base;
    switch (mode)
    {
@@ -401,12 +402,6 @@ void input_push_analog_dpad(struct retro_keybind *binds, unsigned mode)
       case ANALOG_DPAD_RSTICK:
          analog_base = mode == ANALOG_DPAD_LSTICK ? RARCH_ANALOG_LEFT_X_PLUS : RARCH_ANALOG_RIGHT_X_PLUS;
 
-         binds[RETRO_DEVICE_ID_JOYPAD_RIGHT].orig_joyaxis = binds[RETRO_DEVICE_ID_JOYPAD_RIGHT].joyaxis;
-         binds[RETRO_DEVICE_ID_JOYPAD_LEFT].orig_joyaxis  = binds[RETRO_DEVICE_ID_JOYPAD_LEFT].joyaxis;
-         binds[RETRO_DEVICE_ID_JOYPAD_DOWN].orig_joyaxis  = binds[RETRO_DEVICE_ID_JOYPAD_DOWN].joyaxis;
-         binds[RETRO_DEVICE_ID_JOYPAD_UP].orig_joyaxis    = binds[RETRO_DEVICE_ID_JOYPAD_UP].joyaxis;
-
-         // Inherit joyaxis from analogs.
          binds[RETRO_DEVICE_ID_JOYPAD_RIGHT].joyaxis = binds[analog_base + 0].joyaxis;
          binds[RETRO_DEVICE_ID_JOYPAD_LEFT].joyaxis  = binds[analog_base + 1].joyaxis;
          binds[RETRO_DEVICE_ID_JOYPAD_DOWN].joyaxis  = binds[analog_base + 2].joyaxis;
@@ -414,18 +409,106 @@ void input_push_analog_dpad(struct retro_keybind *binds, unsigned mode)
          break;
 
       default:
-         for (i = RETRO_DEVICE_ID_JOYPAD_UP; i <= RETRO_DEVICE_ID_JOYPAD_RIGHT; i++)
-            binds[i].orig_joyaxis = binds[i].joyaxis;
          break;
    }
 }
 
-// Restore binds temporarily overridden by input_push_analog_dpad.
-void input_pop_analog_dpad(struct retro_keybind *binds)
+static void input_snapshot_compile(void)
 {
-   unsigned i;
-   for (i = RETRO_DEVICE_ID_JOYPAD_UP; i <= RETRO_DEVICE_ID_JOYPAD_RIGHT; i++)
-      binds[i].joyaxis = binds[i].orig_joyaxis;
+   unsigned port, i;
+
+   for (port = 0; port < MAX_PLAYERS; port++)
+   {
+      struct retro_keybind *binds = g_extern.input.binds[port];
+      uint64_t bound = 0;
+
+      memcpy(binds, g_settings.input.binds[port], sizeof(g_extern.input.binds[port]));
+      input_apply_analog_dpad(binds, g_settings.input.analog_dpad_mode[port]);
+
+      for (i = 0; i < RARCH_BIND_LIST_END; i++)
+      {
+         if (binds[i].valid && (binds[i].joykey != NO_BTN || binds[i].joyaxis != AXIS_NONE))
+            bound |= 1ULL << i;
+      }
+
+      // Command binds are only usable for port 0.
+      if (port)
+         bound &= ~INPUT_SNAPSHOT_KEYS;
+
+      g_extern.input.bound[port] = bound;
+   }
+
+   g_extern.input.compiled = true;
+}
+
+void input_snapshot_invalidate(void)
+{
+   g_extern.input.compiled = false;
+}
+
+void input_snapshot_poll(void)
+{
+   unsigned port, i, j;
+   uint64_t keys = 0;
+
+   static const struct retro_keybind *binds[MAX_PLAYERS] = {
+      g_extern.input.binds[0],
+      g_extern.input.binds[1],
+      g_extern.input.binds[2],
+      g_extern.input.binds[3],
+   };
+
+   if (!driver.input || !driver.input_data)
+      return;
+
+   if (!g_extern.input.compiled)
+      input_snapshot_compile();
+
+   for (port = 0; port < MAX_PLAYERS; port++)
+   {
+      uint64_t bound   = g_extern.input.bound[port];
+      uint64_t buttons = 0;
+
+      for (i = 0; i < RARCH_FIRST_META_KEY; i++)
+      {
+         if ((bound & INPUT_SNAPSHOT_BUTTONS & (1ULL << i)) &&
+               input_input_state_func(binds, port, RETRO_DEVICE_JOYPAD, 0, i))
+            buttons |= 1ULL << i;
+      }
+
+      for (i = 0; i < 2; i++)
+      {
+         for (j = 0; j < 2; j++)
+         {
+            unsigned id_minus = 0;
+            unsigned id_plus  = 0;
+            input_conv_analog_id_to_bind_id(i, j, &id_minus, &id_plus);
+
+            g_extern.input.analog[port][i][j] = (bound & ((1ULL << id_minus) | (1ULL << id_plus))) ?
+               input_input_state_func(binds, port, RETRO_DEVICE_ANALOG, i, j) : 0;
+         }
+      }
+
+      g_extern.input.buttons[port] = buttons;
+   }
+
+   for (i = RARCH_FIRST_META_KEY; i < RARCH_BIND_LIST_END; i++)
+   {
+      if ((g_extern.input.bound[0] & (1ULL << i)) &&
+            driver.input->key_pressed(driver.input_data, i))
+         keys |= 1ULL << i;
+   }
+
+   // Drivers report lifecycle commands as pressed keys as well. Those are read live by
+   // input_key_pressed_func(), so a command cleared by the frontend doesn't stick around here.
+   g_extern.input.buttons[0] |= keys & ~g_extern.lifecycle_state;
+}
+
+// Records the hotkeys seen by this frame's checks, for input_key_triggered_func().
+void input_snapshot_latch(void)
+{
+   g_extern.input.keys_last = driver.block_hotkey ? 0 :
+      ((g_extern.input.buttons[0] | g_extern.lifecycle_state) & INPUT_SNAPSHOT_KEYS);
 }
 
 void quick_swap_controllers(void)
@@ -117,8 +117,15 @@ void input_config_parse_joy_button(config_file_t *conf, const char *prefix,
 void input_config_parse_joy_axis(config_file_t *conf, const char *prefix,
       const char *axis, struct retro_keybind *bind);
 
-void input_push_analog_dpad(struct retro_keybind *binds, unsigned mode);
-void input_pop_analog_dpad(struct retro_keybind *binds);
+// Per-frame input snapshot (g_extern.input).
+// Buttons and analogs of every port are resolved once per poll against a compiled copy
+// of the binds. Call input_snapshot_invalidate() after changing binds or analog D-pad modes.
+#define INPUT_SNAPSHOT_BUTTONS (((1ULL << RARCH_FIRST_CUSTOM_BIND) - 1) | (1ULL << RARCH_TURBO_ENABLE))
+#define INPUT_SNAPSHOT_KEYS (((1ULL << RARCH_BIND_LIST_END) - 1) & ~((1ULL << RARCH_FIRST_META_KEY) - 1))
+
+void input_snapshot_invalidate(void);
+void input_snapshot_poll(void);
+void input_snapshot_latch(void);
 
 void quick_swap_controllers(void);
 
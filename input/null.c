@@ -0,0 +1,92 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Null input driver. No buttons are ever pressed, apart from
+// lifecycle commands issued by the frontend itself.
+
+#include "../driver.h"
+#include "../general.h"
+#include <stdlib.h>
+
+static void *null_input_init(void)
+{
+   return calloc(1, sizeof(int));
+}
+
+static void null_input_poll(void *data)
+{
+   (void)data;
+}
+
+static int16_t null_input_state(void *data, const struct retro_keybind **retro_keybinds,
+      unsigned port, unsigned device, unsigned index, unsigned id)
+{
+   (void)data;
+   (void)retro_keybinds;
+   (void)port;
+   (void)device;
+   (void)index;
+   (void)id;
+   return 0;
+}
+
+static bool null_input_key_pressed(void *data, int key)
+{
+   (void)data;
+   return g_extern.lifecycle_state & (1ULL << key);
+}
+
+static void null_input_free(void *data)
+{
+   free(data);
+}
+
+static void null_input_set_keybinds(void *data, unsigned device, unsigned port,
+      unsigned id, unsigned keybind_action)
+{
+   (void)data;
+   (void)device;
+   (void)port;
+   (void)id;
+   (void)keybind_action;
+}
+
+static uint64_t null_input_get_capabilities(void *data)
+{
+   (void)data;
+   return (1 << RETRO_DEVICE_JOYPAD);
+}
+
+static bool null_input_set_rumble(void *data, unsigned port, enum retro_rumble_effect effect, uint16_t strength)
+{
+   (void)data;
+   (void)port;
+   (void)effect;
+   (void)strength;
+   return false;
+}
+
+const input_driver_t input_null = {
+   null_input_init,
+   null_input_poll,
+   null_input_state,
+   null_input_key_pressed,
+   null_input_free,
+   null_input_set_keybinds,
+   null_input_get_capabilities,
+   "null",
+   null_input_set_rumble,
+   NULL,
+};
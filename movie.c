@@ -0,0 +1,419 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "movie.h"
+#include "general.h"
+#include "dynamic.h"
+#include "hash.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Movie layout, all values little-endian.
+// Header: magic, content CRC32, core CRC32 (see movie_core_crc()), state size,
+// checksum interval, frame count, followed by the serialized state the movie starts from.
+// Every frame is then a 16-bit word holding the number of input_state() results
+// and flags, the results themselves unless they repeat the previous frame,
+// and a CRC32 of the serialized state after the frame if flagged.
+#define BSV_MAGIC 0x42535632 // 'BSV2'
+
+#define BSV_HEADER_MAGIC         0
+#define BSV_HEADER_CONTENT_CRC   1
+#define BSV_HEADER_CORE_CRC      2
+#define BSV_HEADER_STATE_SIZE    3
+#define BSV_HEADER_INTERVAL      4
+#define BSV_HEADER_FRAMES        5
+#define BSV_HEADER_SIZE          6
+
+#define BSV_FRAME_COUNT_MASK     0x3fff
+#define BSV_FRAME_REPEAT         0x4000
+#define BSV_FRAME_CHECKSUM       0x8000
+
+struct bsv_movie
+{
+   FILE *file;
+   bool playback;
+
+   uint8_t *state;
+   size_t state_size;
+   unsigned checksum_interval;
+
+   // Input of the current frame. When recording, prev_input holds the previous frame
+   // so repeats can be detected. Both share input_cap.
+   int16_t *input;
+   int16_t *prev_input;
+   size_t input_cap;
+   size_t input_ptr;
+   size_t input_count;
+   size_t prev_count;
+   bool have_prev;
+
+   bool expect_checksum;
+   uint32_t checksum;
+
+   unsigned frame;
+   unsigned frames;
+   unsigned mismatches;
+};
+
+// Hashes the core binary, so a rebuilt core with the same version string is told apart.
+// Statically linked cores without a known path fall back to the name and version.
+static uint32_t movie_core_crc(void)
+{
+   uint32_t crc;
+   char ident[256];
+   if (*g_settings.libretro && crc32_file(g_settings.libretro, &crc))
+      return crc;
+
+   RARCH_WARN("Could not read core \"%s\", checking movie against core name and version only.\n",
+         g_settings.libretro);
+   snprintf(ident, sizeof(ident), "%s %s",
+         g_extern.system.info.library_name, g_extern.system.info.library_version);
+   return crc32_calculate((const uint8_t*)ident, strlen(ident));
+}
+
+static uint32_t movie_state_crc(bsv_movie_t *handle)
+{
+   pretro_serialize(handle->state, handle->state_size);
+   return crc32_calculate(handle->state, handle->state_size);
+}
+
+static bool movie_read16(bsv_movie_t *handle, uint16_t *val)
+{
+   uint16_t raw;
+   if (fread(&raw, sizeof(raw), 1, handle->file) != 1)
+      return false;
+   *val = swap_if_big16(raw);
+   return true;
+}
+
+static bool movie_read32(bsv_movie_t *handle, uint32_t *val)
+{
+   uint32_t raw;
+   if (fread(&raw, sizeof(raw), 1, handle->file) != 1)
+      return false;
+   *val = swap_if_big32(raw);
+   return true;
+}
+
+static bool movie_reserve_input(bsv_movie_t *handle, size_t count)
+{
+   if (count <= handle->input_cap)
+      return true;
+
+   size_t cap = handle->input_cap ? handle->input_cap * 2 : 64;
+   while (cap < count)
+      cap *= 2;
+
+   int16_t *input = (int16_t*)realloc(handle->input, cap * sizeof(int16_t));
+   if (!input)
+      return false;
+   handle->input = input;
+
+   if (!handle->playback)
+   {
+      input = (int16_t*)realloc(handle->prev_input, cap * sizeof(int16_t));
+      if (!input)
+         return false;
+      handle->prev_input = input;
+   }
+
+   handle->input_cap = cap;
+   return true;
+}
+
+static bool init_playback(bsv_movie_t *handle, const char *path)
+{
+   unsigned i;
+   uint32_t header[BSV_HEADER_SIZE];
+
+   handle->playback = true;
+   handle->file = fopen(path, "rb");
+   if (!handle->file)
+   {
+      RARCH_ERR("Could not open movie file \"%s\" for playback.\n", path);
+      return false;
+   }
+
+   for (i = 0; i < BSV_HEADER_SIZE; i++)
+   {
+      if (!movie_read32(handle, &header[i]))
+      {
+         RARCH_ERR("Movie file \"%s\" is truncated.\n", path);
+         return false;
+      }
+   }
+
+   if (header[BSV_HEADER_MAGIC] != BSV_MAGIC)
+   {
+      RARCH_ERR("\"%s\" is not a movie file.\n", path);
+      return false;
+   }
+
+   if (header[BSV_HEADER_CONTENT_CRC] != g_extern.content_crc)
+      RARCH_WARN("Movie was recorded with different content (CRC32 0x%08x, loaded 0x%08x).\n",
+            (unsigned)header[BSV_HEADER_CONTENT_CRC], (unsigned)g_extern.content_crc);
+   if (header[BSV_HEADER_CORE_CRC] != movie_core_crc())
+      RARCH_WARN("Movie was recorded with a different core or core version.\n");
+
+   if (header[BSV_HEADER_STATE_SIZE] != handle->state_size)
+   {
+      RARCH_ERR("Movie state size (%u) does not match core (%u).\n",
+            (unsigned)header[BSV_HEADER_STATE_SIZE], (unsigned)handle->state_size);
+      return false;
+   }
+
+   handle->checksum_interval = header[BSV_HEADER_INTERVAL];
+   handle->frames = header[BSV_HEADER_FRAMES];
+
+   if (fread(handle->state, 1, handle->state_size, handle->file) != handle->state_size)
+   {
+      RARCH_ERR("Movie file \"%s\" is truncated.\n", path);
+      return false;
+   }
+
+   if (!pretro_unserialize(handle->state, handle->state_size))
+   {
+      RARCH_ERR("Core failed to load the movie's initial state.\n");
+      return false;
+   }
+
+   RARCH_LOG("Playing back movie \"%s\", %u frames.\n", path, handle->frames);
+   return true;
+}
+
+static bool init_record(bsv_movie_t *handle, const char *path)
+{
+   unsigned i;
+   uint32_t header[BSV_HEADER_SIZE];
+
+   handle->file = fopen(path, "wb");
+   if (!handle->file)
+   {
+      RARCH_ERR("Could not open movie file \"%s\" for recording.\n", path);
+      return false;
+   }
+
+   if (!pretro_serialize(handle->state, handle->state_size))
+   {
+      RARCH_ERR("Core failed to serialize the movie's initial state.\n");
+      return false;
+   }
+
+   header[BSV_HEADER_MAGIC]       = BSV_MAGIC;
+   header[BSV_HEADER_CONTENT_CRC] = g_extern.content_crc;
+   header[BSV_HEADER_CORE_CRC]    = movie_core_crc();
+   header[BSV_HEADER_STATE_SIZE]  = handle->state_size;
+   header[BSV_HEADER_INTERVAL]    = handle->checksum_interval;
+   header[BSV_HEADER_FRAMES]      = 0; // Patched when the movie is closed.
+
+   for (i = 0; i < BSV_HEADER_SIZE; i++)
+      header[i] = swap_if_big32(header[i]);
+
+   if (fwrite(header, sizeof(header), 1, handle->file) != 1 ||
+         fwrite(handle->state, 1, handle->state_size, handle->file) != handle->state_size)
+   {
+      RARCH_ERR("Failed to write movie header to \"%s\".\n", path);
+      return false;
+   }
+
+   RARCH_LOG("Recording movie to \"%s\".\n", path);
+   return true;
+}
+
+bsv_movie_t *bsv_movie_init(const char *path, enum rarch_movie_type type, unsigned checksum_interval)
+{
+   bsv_movie_t *handle = (bsv_movie_t*)calloc(1, sizeof(*handle));
+   if (!handle)
+      return NULL;
+
+   handle->state_size = pretro_serialize_size();
+   if (!handle->state_size)
+   {
+      RARCH_ERR("Implementation does not support save states. Cannot use movies.\n");
+      goto error;
+   }
+
+   handle->state = (uint8_t*)malloc(handle->state_size);
+   if (!handle->state)
+      goto error;
+
+   handle->checksum_interval = checksum_interval;
+
+   if (type == RARCH_MOVIE_PLAYBACK)
+   {
+      if (!init_playback(handle, path))
+         goto error;
+   }
+   else if (!init_record(handle, path))
+      goto error;
+
+   return handle;
+
+error:
+   bsv_movie_free(handle);
+   return NULL;
+}
+
+void bsv_movie_free(bsv_movie_t *handle)
+{
+   if (!handle)
+      return;
+
+   if (handle->file && !handle->playback)
+   {
+      uint32_t frames = swap_if_big32(handle->frame);
+      if (fseek(handle->file, BSV_HEADER_FRAMES * sizeof(uint32_t), SEEK_SET) == 0)
+         fwrite(&frames, sizeof(frames), 1, handle->file);
+      RARCH_LOG("Recorded %u movie frames.\n", handle->frame);
+   }
+   else if (handle->file)
+      RARCH_LOG("Played back %u of %u movie frames, %u checksum mismatches.\n",
+            handle->frame, handle->frames, handle->mismatches);
+
+   if (handle->file)
+      fclose(handle->file);
+   free(handle->input);
+   free(handle->prev_input);
+   free(handle->state);
+   free(handle);
+}
+
+bool bsv_movie_set_frame_start(bsv_movie_t *handle)
+{
+   uint16_t header;
+   size_t i, count;
+
+   handle->input_ptr = 0;
+   if (!handle->playback)
+      return true;
+
+   if (handle->frame >= handle->frames || !movie_read16(handle, &header))
+      return false;
+
+   count = header & BSV_FRAME_COUNT_MASK;
+   if (header & BSV_FRAME_REPEAT)
+   {
+      if (!handle->have_prev || count != handle->prev_count)
+         return false;
+   }
+   else
+   {
+      if (!movie_reserve_input(handle, count))
+         return false;
+      if (fread(handle->input, sizeof(int16_t), count, handle->file) != count)
+         return false;
+      for (i = 0; i < count; i++)
+         handle->input[i] = (int16_t)swap_if_big16((uint16_t)handle->input[i]);
+   }
+
+   handle->input_count = count;
+   handle->expect_checksum = header & BSV_FRAME_CHECKSUM;
+   if (handle->expect_checksum && !movie_read32(handle, &handle->checksum))
+      return false;
+
+   return true;
+}
+
+bool bsv_movie_set_frame_end(bsv_movie_t *handle)
+{
+   size_t i;
+   bool ret = true;
+
+   if (handle->playback)
+   {
+      if (handle->expect_checksum && movie_state_crc(handle) != handle->checksum)
+      {
+         if (!handle->mismatches)
+            RARCH_ERR("Movie desynced: state checksum mismatch at frame %u.\n", handle->frame + 1);
+         handle->mismatches++;
+         ret = false;
+      }
+
+      handle->prev_count = handle->input_count;
+      handle->have_prev = true;
+      handle->frame++;
+      return ret;
+   }
+
+   uint16_t header = handle->input_ptr;
+   if (handle->input_ptr > BSV_FRAME_COUNT_MASK)
+   {
+      RARCH_ERR("Too many input polls in one frame to record.\n");
+      header = BSV_FRAME_COUNT_MASK;
+   }
+
+   // Idle frames are common, store them as a single word.
+   if (handle->have_prev && handle->input_ptr == handle->prev_count &&
+         (!handle->input_ptr || !memcmp(handle->prev_input, handle->input, handle->input_ptr * sizeof(int16_t))))
+      header |= BSV_FRAME_REPEAT;
+
+   bool checksum = handle->checksum_interval && ((handle->frame + 1) % handle->checksum_interval) == 0;
+   if (checksum)
+      header |= BSV_FRAME_CHECKSUM;
+
+   uint16_t raw = swap_if_big16(header);
+   fwrite(&raw, sizeof(raw), 1, handle->file);
+
+   if (!(header & BSV_FRAME_REPEAT))
+   {
+      for (i = 0; i < (header & BSV_FRAME_COUNT_MASK); i++)
+      {
+         raw = swap_if_big16((uint16_t)handle->input[i]);
+         fwrite(&raw, sizeof(raw), 1, handle->file);
+      }
+   }
+
+   if (checksum)
+   {
+      uint32_t crc = swap_if_big32(movie_state_crc(handle));
+      fwrite(&crc, sizeof(crc), 1, handle->file);
+   }
+
+   int16_t *tmp = handle->prev_input;
+   handle->prev_input = handle->input;
+   handle->input = tmp;
+
+   handle->prev_count = handle->input_ptr;
+   handle->have_prev = true;
+   handle->frame++;
+   return true;
+}
+
+bool bsv_movie_get_input(bsv_movie_t *handle, int16_t *input)
+{
+   if (handle->input_ptr >= handle->input_count)
+      return false;
+
+   *input = handle->input[handle->input_ptr++];
+   return true;
+}
+
+void bsv_movie_set_input(bsv_movie_t *handle, int16_t input)
+{
+   if (!movie_reserve_input(handle, handle->input_ptr + 1))
+      return;
+
+   handle->input[handle->input_ptr++] = input;
+}
+
+unsigned bsv_movie_get_frame(bsv_movie_t *handle)
+{
+   return handle->frame;
+}
+
+unsigned bsv_movie_get_mismatches(bsv_movie_t *handle)
+{
+   return handle->mismatches;
+}
@@ -0,0 +1,52 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RARCH_MOVIE_H
+#define __RARCH_MOVIE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct bsv_movie bsv_movie_t;
+
+enum rarch_movie_type
+{
+   RARCH_MOVIE_PLAYBACK = 0,
+   RARCH_MOVIE_RECORD
+};
+
+// Opens a movie for recording or playback. The core must be loaded and support save states.
+// Recording snapshots the current state into the movie, playback unserializes the recorded one.
+// checksum_interval is the number of frames between state checksums when recording, 0 disables.
+bsv_movie_t *bsv_movie_init(const char *path, enum rarch_movie_type type, unsigned checksum_interval);
+void bsv_movie_free(bsv_movie_t *handle);
+
+// Wrap every retro_run() call.
+// set_frame_start returns false once playback is out of frames.
+// set_frame_end returns false if playback fails a state checksum.
+bool bsv_movie_set_frame_start(bsv_movie_t *handle);
+bool bsv_movie_set_frame_end(bsv_movie_t *handle);
+
+// Playback: returns false if the core polls more input than was recorded for this frame.
+bool bsv_movie_get_input(bsv_movie_t *handle, int16_t *input);
+// Recording.
+void bsv_movie_set_input(bsv_movie_t *handle, int16_t input);
+
+unsigned bsv_movie_get_frame(bsv_movie_t *handle);
+unsigned bsv_movie_get_mismatches(bsv_movie_t *handle);
+
+#endif
+
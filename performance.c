@@ -15,60 +15,293 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "libretro.h"
 #include "performance.h"
 #include "general.h"
+#include "gfx/frame_pacing.h"
 
-#define __mftb gettime
+#if defined(HW_RVL) || defined(HW_DOL)
+#include <ogc/lwp_watchdog.h>
+#define PERF_GX
+#else
+#include <time.h>
+#include <unistd.h>
+#endif
 
-#if defined(__mips__)
-#include <sys/time.h>
+#if defined(__i386__) || defined(__x86_64__)
+#include <cpuid.h>
+#define PERF_X86
 #endif
 
-#include <ogc/lwp_watchdog.h>
-#include <string.h>
+#if defined(__linux__) && defined(__arm__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+struct perf_list_entry
+{
+   const struct retro_perf_counter *counter;
+   const struct rarch_perf_stats *stats;
+};
+
+struct perf_list
+{
+   struct perf_list_entry *entries;
+   size_t size;
+   size_t cap;
+};
+
+static struct perf_list perf_counters_rarch;
+static struct perf_list perf_counters_libretro;
+
+// Open addressed map from libretro counter pointer to its stats.
+// Stats are kept on the side so the libretro counter layout is untouched.
+// Frontend counters carry their stats pointer and are not in here.
+struct perf_stats_entry
+{
+   const struct retro_perf_counter *counter;
+   struct rarch_perf_stats *stats;
+};
+
+static struct perf_stats_entry *perf_stats_map;
+static size_t perf_stats_size;
+static size_t perf_stats_cap;
+
+static inline size_t perf_stats_hash(const struct retro_perf_counter *perf)
+{
+   uintptr_t key = (uintptr_t)perf >> 3;
+   return (size_t)(key * 2654435761u);
+}
 
-#define MAX_COUNTERS 64
-static const struct retro_perf_counter *perf_counters_rarch[MAX_COUNTERS];
-static const struct retro_perf_counter *perf_counters_libretro[MAX_COUNTERS];
-static unsigned perf_ptr_rarch;
-static unsigned perf_ptr_libretro;
+static struct perf_stats_entry *perf_stats_find_entry(struct perf_stats_entry *map, size_t cap,
+      const struct retro_perf_counter *perf)
+{
+   size_t i = perf_stats_hash(perf) & (cap - 1);
+   while (map[i].counter && map[i].counter != perf)
+      i = (i + 1) & (cap - 1);
+   return &map[i];
+}
+
+static bool perf_stats_grow(void)
+{
+   size_t i;
+   size_t new_cap = perf_stats_cap ? perf_stats_cap * 2 : 64;
+   struct perf_stats_entry *map = (struct perf_stats_entry*)calloc(new_cap, sizeof(*map));
+   if (!map)
+      return false;
+
+   for (i = 0; i < perf_stats_cap; i++)
+      if (perf_stats_map[i].counter)
+         *perf_stats_find_entry(map, new_cap, perf_stats_map[i].counter) = perf_stats_map[i];
+
+   free(perf_stats_map);
+   perf_stats_map = map;
+   perf_stats_cap = new_cap;
+   return true;
+}
+
+static struct rarch_perf_stats *perf_stats_new(void)
+{
+   struct rarch_perf_stats *stats = (struct rarch_perf_stats*)calloc(1, sizeof(*stats));
+   if (stats)
+      stats->min = ~(retro_perf_tick_t)0;
+   return stats;
+}
+
+static struct rarch_perf_stats *perf_stats_insert(const struct retro_perf_counter *perf)
+{
+   // Keep load factor below 1/2.
+   if ((perf_stats_size + 1) * 2 > perf_stats_cap && !perf_stats_grow())
+      return NULL;
+
+   struct perf_stats_entry *entry = perf_stats_find_entry(perf_stats_map, perf_stats_cap, perf);
+   if (entry->counter)
+      return entry->stats;
+
+   struct rarch_perf_stats *stats = perf_stats_new();
+   if (!stats)
+      return NULL;
+
+   entry->counter = perf;
+   entry->stats   = stats;
+   perf_stats_size++;
+   return stats;
+}
 
-void rarch_perf_register(struct retro_perf_counter *perf)
+static void perf_stats_clear(void)
 {
-   if (perf->registered || perf_ptr_rarch >= MAX_COUNTERS)
+   size_t i;
+   for (i = 0; i < perf_stats_cap; i++)
+      free(perf_stats_map[i].stats);
+   free(perf_stats_map);
+   perf_stats_map  = NULL;
+   perf_stats_size = 0;
+   perf_stats_cap  = 0;
+}
+
+void rarch_perf_sample(struct rarch_perf_stats *stats, retro_perf_tick_t delta)
+{
+   unsigned bucket;
+
+   if (delta < stats->min)
+      stats->min = delta;
+   if (delta > stats->max)
+      stats->max = delta;
+
+#ifdef __GNUC__
+   bucket = delta ? 64 - __builtin_clzll(delta) : 0;
+#else
+   for (bucket = 0; bucket < 64 && (delta >> bucket); bucket++);
+#endif
+   if (bucket >= RARCH_PERF_BUCKETS)
+      bucket = RARCH_PERF_BUCKETS - 1;
+   stats->histogram[bucket]++;
+}
+
+retro_perf_tick_t rarch_perf_percentile(const struct rarch_perf_stats *stats, double pct)
+{
+   unsigned i;
+   uint64_t count = 0, cumulative = 0;
+
+   for (i = 0; i < RARCH_PERF_BUCKETS; i++)
+      count += stats->histogram[i];
+   if (!count)
+      return 0;
+
+   uint64_t target = (uint64_t)(pct * count + 0.5);
+   if (target < 1)
+      target = 1;
+
+   for (i = 0; i < RARCH_PERF_BUCKETS; i++)
+   {
+      if (cumulative + stats->histogram[i] >= target)
+      {
+         double lo = i ? (double)(1ULL << (i - 1)) : 0.0;
+         double hi = i ? (double)(1ULL << (i - 1)) * 2.0 : 0.0;
+         double frac = (double)(target - cumulative) / stats->histogram[i];
+         retro_perf_tick_t val = (retro_perf_tick_t)(lo + (hi - lo) * frac);
+
+         if (val < stats->min)
+            val = stats->min;
+         if (val > stats->max)
+            val = stats->max;
+         return val;
+      }
+      cumulative += stats->histogram[i];
+   }
+
+   return stats->max;
+}
+
+static bool perf_list_append(struct perf_list *list, const struct retro_perf_counter *perf,
+      const struct rarch_perf_stats *stats)
+{
+   if (list->size >= list->cap)
+   {
+      size_t new_cap = list->cap ? list->cap * 2 : 32;
+      struct perf_list_entry *entries = (struct perf_list_entry*)
+         realloc(list->entries, new_cap * sizeof(*entries));
+      if (!entries)
+         return false;
+
+      list->entries = entries;
+      list->cap     = new_cap;
+   }
+
+   list->entries[list->size].counter = perf;
+   list->entries[list->size].stats   = stats;
+   list->size++;
+   return true;
+}
+
+void rarch_perf_register(struct rarch_perf_counter *perf)
+{
+   struct rarch_perf_stats *stats;
+   if (perf->base.registered)
       return;
 
-   perf_counters_rarch[perf_ptr_rarch++] = perf;
-   perf->registered = true;
+   stats = perf_stats_new();
+   if (!stats || !perf_list_append(&perf_counters_rarch, &perf->base, stats))
+   {
+      free(stats);
+      return;
+   }
+
+   perf->stats = stats;
+   perf->base.registered = true;
 }
 
 void retro_perf_register(struct retro_perf_counter *perf)
 {
-   if (perf->registered || perf_ptr_libretro >= MAX_COUNTERS)
+   struct rarch_perf_stats *stats;
+   if (perf->registered)
+      return;
+
+   stats = perf_stats_insert(perf);
+   if (!perf_list_append(&perf_counters_libretro, perf, stats))
       return;
 
-   perf_counters_libretro[perf_ptr_libretro++] = perf;
    perf->registered = true;
 }
 
+void retro_perf_start(struct retro_perf_counter *perf)
+{
+   perf->call_cnt++;
+   perf->start = rarch_get_perf_counter();
+}
+
+void retro_perf_stop(struct retro_perf_counter *perf)
+{
+   retro_perf_tick_t delta = rarch_get_perf_counter() - perf->start;
+   perf->total += delta;
+
+   if (perf_stats_map)
+   {
+      struct rarch_perf_stats *stats = perf_stats_find_entry(perf_stats_map, perf_stats_cap, perf)->stats;
+      if (stats)
+         rarch_perf_sample(stats, delta);
+   }
+}
+
 void retro_perf_clear(void)
 {
-   perf_ptr_libretro = 0;
-   memset(perf_counters_libretro, 0, sizeof(perf_counters_libretro));
+   perf_stats_clear();
+   perf_counters_libretro.size = 0;
 }
 
 #define PERF_LOG_FMT "[PERF]: Avg (%s): %llu ticks, %llu runs.\n"
+#define PERF_LOG_STATS_FMT "[PERF]:    min %llu, p50 %llu, p99 %llu, max %llu ticks (p99 %.2f usec).\n"
 
-static void log_counters(const struct retro_perf_counter **counters, unsigned num)
+static void log_counters(const struct perf_list *list)
 {
-   unsigned i;
-   for (i = 0; i < num; i++)
+   size_t i;
+   double ticks_per_usec = rarch_get_perf_ticks_per_usec();
+
+   for (i = 0; i < list->size; i++)
    {
+      const struct retro_perf_counter *counter = list->entries[i].counter;
+      const struct rarch_perf_stats *stats = list->entries[i].stats;
+
+      if (!counter->call_cnt)
+         continue;
+
       RARCH_LOG(PERF_LOG_FMT,
-            counters[i]->ident,
-            (unsigned long long)counters[i]->total / (unsigned long long)counters[i]->call_cnt,
-            (unsigned long long)counters[i]->call_cnt);
+            counter->ident,
+            (unsigned long long)counter->total / (unsigned long long)counter->call_cnt,
+            (unsigned long long)counter->call_cnt);
+
+      if (stats)
+      {
+         retro_perf_tick_t p99 = rarch_perf_percentile(stats, 0.99);
+         RARCH_LOG(PERF_LOG_STATS_FMT,
+               (unsigned long long)stats->min,
+               (unsigned long long)rarch_perf_percentile(stats, 0.5),
+               (unsigned long long)p99,
+               (unsigned long long)stats->max,
+               ticks_per_usec > 0.0 ? p99 / ticks_per_usec : 0.0);
+      }
    }
 }
 
@@ -76,22 +309,23 @@ void rarch_perf_log(void)
 {
 #if defined(PERF_TEST) || !defined(RARCH_INTERNAL)
    RARCH_LOG("[PERF]: Performance counters (RetroArch):\n");
-   log_counters(perf_counters_rarch, perf_ptr_rarch);
+   log_counters(&perf_counters_rarch);
+#ifdef RARCH_INTERNAL
+   frame_pacer_log_active();
+#endif
 #endif
 }
 
 void retro_perf_log(void)
 {
    RARCH_LOG("[PERF]: Performance counters (libretro):\n");
-   log_counters(perf_counters_libretro, perf_ptr_libretro);
+   log_counters(&perf_counters_libretro);
 }
 
+#ifdef PERF_GX
 retro_perf_tick_t rarch_get_perf_counter(void)
 {
-   retro_perf_tick_t time = 0;
-   time = __mftb();
-
-   return time;
+   return gettime();
 }
 
 retro_time_t rarch_get_time_usec(void)
@@ -99,12 +333,147 @@ retro_time_t rarch_get_time_usec(void)
    return ticks_to_microsecs(gettime());
 }
 
+double rarch_get_perf_ticks_per_usec(void)
+{
+   return TB_TIMER_CLOCK / 1000.0;
+}
+#else
+retro_time_t rarch_get_time_usec(void)
+{
+   struct timespec tv;
+   if (clock_gettime(CLOCK_MONOTONIC, &tv) < 0)
+      return 0;
+   return (retro_time_t)tv.tv_sec * 1000000 + tv.tv_nsec / 1000;
+}
+
+#ifdef PERF_X86
+retro_perf_tick_t rarch_get_perf_counter(void)
+{
+   uint32_t lo, hi;
+   __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+   return ((retro_perf_tick_t)hi << 32) | lo;
+}
+
+// TSC rate isn't exposed anywhere portable, so measure it against the monotonic clock.
+double rarch_get_perf_ticks_per_usec(void)
+{
+   static double ticks_per_usec;
+   if (ticks_per_usec <= 0.0)
+   {
+      retro_time_t start = rarch_get_time_usec(), end;
+      retro_perf_tick_t ticks = rarch_get_perf_counter();
+
+      do
+      {
+         end = rarch_get_time_usec();
+      } while (end - start < 20000);
+
+      ticks_per_usec = (rarch_get_perf_counter() - ticks) / (double)(end - start);
+      RARCH_LOG("[PERF]: Calibrated TSC at %.2f MHz.\n", ticks_per_usec);
+   }
+   return ticks_per_usec;
+}
+#else
+retro_perf_tick_t rarch_get_perf_counter(void)
+{
+   struct timespec tv;
+   if (clock_gettime(CLOCK_MONOTONIC, &tv) < 0)
+      return 0;
+   return (retro_perf_tick_t)tv.tv_sec * 1000000000 + tv.tv_nsec;
+}
+
+double rarch_get_perf_ticks_per_usec(void)
+{
+   return 1000.0;
+}
+#endif
+#endif
+
+#ifdef PERF_X86
+static uint64_t x86_cpu_features(void)
+{
+   unsigned eax, ebx, ecx, edx;
+   uint64_t cpu = 0;
+
+   if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+      return 0;
+
+   if (edx & (1 << 23))
+      cpu |= RETRO_SIMD_MMX;
+   if (edx & (1 << 25))
+      cpu |= RETRO_SIMD_SSE | RETRO_SIMD_MMXEXT; // SSE implies MMXEXT.
+   if (edx & (1 << 26))
+      cpu |= RETRO_SIMD_SSE2;
+   if (ecx & (1 << 0))
+      cpu |= RETRO_SIMD_SSE3;
+   if (ecx & (1 << 9))
+      cpu |= RETRO_SIMD_SSSE3;
+   if (ecx & (1 << 19))
+      cpu |= RETRO_SIMD_SSE4;
+   if (ecx & (1 << 20))
+      cpu |= RETRO_SIMD_SSE42;
+
+   // AVX needs OS support for saving YMM state as well (OSXSAVE + XCR0).
+   bool avx_os = false;
+   if ((ecx & (1 << 27)) && (ecx & (1 << 28)))
+   {
+      uint32_t xcr0_lo, xcr0_hi;
+      __asm__ volatile ("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+      avx_os = (xcr0_lo & 0x6) == 0x6;
+   }
+
+   if (avx_os)
+   {
+      cpu |= RETRO_SIMD_AVX;
+      if (__get_cpuid_max(0, NULL) >= 7)
+      {
+         __cpuid_count(7, 0, eax, ebx, ecx, edx);
+         if (ebx & (1 << 5))
+            cpu |= RETRO_SIMD_AVX2;
+      }
+   }
+
+   return cpu;
+}
+#endif
+
+unsigned rarch_get_cpu_cores(void)
+{
+#if defined(PERF_GX)
+   return 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+   long cores = sysconf(_SC_NPROCESSORS_ONLN);
+   return cores > 0 ? cores : 1;
+#else
+   return 1;
+#endif
+}
+
 uint64_t rarch_get_cpu_features(void)
 {
    uint64_t cpu = 0;
 
+#if defined(PERF_GX)
    cpu |= RETRO_SIMD_PS;
-   RARCH_LOG("[CPUID]: PS: %u\n", !!(cpu & RETRO_SIMD_PS));
+#elif defined(PERF_X86)
+   cpu = x86_cpu_features();
+#elif defined(__aarch64__)
+   cpu |= RETRO_SIMD_NEON;
+#elif defined(__linux__) && defined(__arm__)
+   if (getauxval(AT_HWCAP) & HWCAP_NEON)
+      cpu |= RETRO_SIMD_NEON;
+#endif
+
+   RARCH_LOG("[CPUID]: SSE: %u\n",    !!(cpu & RETRO_SIMD_SSE));
+   RARCH_LOG("[CPUID]: SSE2: %u\n",   !!(cpu & RETRO_SIMD_SSE2));
+   RARCH_LOG("[CPUID]: SSE3: %u\n",   !!(cpu & RETRO_SIMD_SSE3));
+   RARCH_LOG("[CPUID]: SSSE3: %u\n",  !!(cpu & RETRO_SIMD_SSSE3));
+   RARCH_LOG("[CPUID]: SSE4: %u\n",   !!(cpu & RETRO_SIMD_SSE4));
+   RARCH_LOG("[CPUID]: SSE42: %u\n",  !!(cpu & RETRO_SIMD_SSE42));
+   RARCH_LOG("[CPUID]: AVX: %u\n",    !!(cpu & RETRO_SIMD_AVX));
+   RARCH_LOG("[CPUID]: AVX2: %u\n",   !!(cpu & RETRO_SIMD_AVX2));
+   RARCH_LOG("[CPUID]: NEON: %u\n",   !!(cpu & RETRO_SIMD_NEON));
+   RARCH_LOG("[CPUID]: PS: %u\n",     !!(cpu & RETRO_SIMD_PS));
 
    return cpu;
 }
@@ -25,33 +25,68 @@ extern "C" {
 #include "libretro.h"
 #include <stdint.h>
 
+// Log2 buckets of ticks per sample. Bucket i holds samples in [2^(i-1), 2^i).
+#define RARCH_PERF_BUCKETS 64
+
+// Per-counter statistics kept on the side, as retro_perf_counter is fixed by the libretro ABI.
+struct rarch_perf_stats
+{
+   retro_perf_tick_t min;
+   retro_perf_tick_t max;
+   uint32_t histogram[RARCH_PERF_BUCKETS];
+};
+
+// Frontend counter. Stats are attached when it is registered, so stopping it does no lookup.
+// Libretro counters can't carry this, as retro_perf_counter is fixed by the ABI.
+struct rarch_perf_counter
+{
+   struct retro_perf_counter base;
+   struct rarch_perf_stats *stats;
+};
+
 retro_perf_tick_t rarch_get_perf_counter(void);
 retro_time_t rarch_get_time_usec(void);
-void rarch_perf_register(struct retro_perf_counter *perf);
-void retro_perf_register(struct retro_perf_counter *perf); // Same as rarch_perf_register, just for libretro cores.
+double rarch_get_perf_ticks_per_usec(void); // Calibrated on first call where needed.
+void rarch_perf_register(struct rarch_perf_counter *perf);
+void retro_perf_register(struct retro_perf_counter *perf); // Libretro cores. Stats are looked up on every stop.
+void retro_perf_start(struct retro_perf_counter *perf);
+void retro_perf_stop(struct retro_perf_counter *perf);
 void retro_perf_clear(void);
 void rarch_perf_log(void);
 void retro_perf_log(void);
 
-static inline void rarch_perf_start(struct retro_perf_counter *perf)
+// Records a single start/stop delta into min/max and histogram.
+void rarch_perf_sample(struct rarch_perf_stats *stats, retro_perf_tick_t delta);
+
+// Approximate percentile (0.0 - 1.0) in ticks, interpolated inside the histogram bucket.
+retro_perf_tick_t rarch_perf_percentile(const struct rarch_perf_stats *stats, double pct);
+
+static inline void rarch_perf_start(struct rarch_perf_counter *perf)
 {
-   perf->call_cnt++;
-   perf->start = rarch_get_perf_counter();
+   perf->base.call_cnt++;
+   perf->base.start = rarch_get_perf_counter();
 }
 
-static inline void rarch_perf_stop(struct retro_perf_counter *perf)
+static inline void rarch_perf_stop(struct rarch_perf_counter *perf)
 {
-   perf->total += rarch_get_perf_counter() - perf->start;
+   retro_perf_tick_t delta = rarch_get_perf_counter() - perf->base.start;
+   perf->base.total += delta;
+   if (perf->stats)
+      rarch_perf_sample(perf->stats, delta);
 }
 
 uint64_t rarch_get_cpu_features(void);
+// Number of online CPU cores, 1 if unknown.
+unsigned rarch_get_cpu_cores(void);
 
 // Used internally by RetroArch.
+// Registration is not thread safe. Counters used off the main thread must be
+// registered up front with rarch_perf_register() before that thread starts.
 #if defined(PERF_TEST) || !defined(RARCH_INTERNAL)
 #define RARCH_PERFORMANCE_INIT(X) \
-   static struct retro_perf_counter X = {#X}; \
+   static struct rarch_perf_counter X = {{#X}}; \
    do { \
-      if (!(X).registered) \
+      if (!(X).base.registered) \
          rarch_perf_register(&(X)); \
    } while(0)
 #define RARCH_PERFORMANCE_START(X) rarch_perf_start(&(X))
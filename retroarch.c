@@ -29,33 +29,118 @@
 #include "performance.h"
 #include "audio/utils.h"
 #include "rewind.h"
+#include "trace.h"
 #include "compat/strl.h"
 #include "screenshot.h"
 #include "compat/getopt_rarch.h"
 #include "input/input_common.h"
 
+#ifdef HAVE_ZLIB
+#include "file_extract.h"
+#endif
+
+static void fastforward_begin(void)
+{
+   retro_time_t now = rarch_get_time_usec();
+
+   memset(&g_extern.fastforward, 0, sizeof(g_extern.fastforward));
+   g_extern.fastforward.start        = now;
+   g_extern.fastforward.last_frame   = now;
+   g_extern.fastforward.report_start = now;
+}
+
+static void fastforward_end(void)
+{
+   float elapsed = (rarch_get_time_usec() - g_extern.fastforward.start) / 1000000.0f;
+   float fps     = g_extern.system.av_info.timing.fps;
+
+   if (elapsed <= 0.0f || fps <= 0.0f)
+      return;
+
+   RARCH_LOG("Fast-forward: %u frames in %.2f s (%.2fx), %u presented.\n",
+         g_extern.fastforward.frames, elapsed,
+         g_extern.fastforward.frames / (elapsed * fps),
+         g_extern.fastforward.presented);
+}
+
+static void set_fast_forward(bool enable)
+{
+   if (enable == driver.nonblock_state)
+      return;
+
+   if (enable)
+      fastforward_begin();
+   else
+      fastforward_end();
+
+   driver.nonblock_state = enable;
+   driver_set_nonblock_state(enable);
+}
+
 // To avoid continous switching if we hold the button down, we require that the button must go from pressed,
 // unpressed back to pressed to be able to toggle between then.
 static void check_fast_forward_button(void)
 {
-   bool new_button_state = input_key_pressed_func(RARCH_FAST_FORWARD_KEY);
-   bool new_hold_button_state = input_key_pressed_func(RARCH_FAST_FORWARD_HOLD_KEY);
-   static bool old_button_state = false;
-   static bool old_hold_button_state = false;
+   bool hold_button_state = input_key_pressed_func(RARCH_FAST_FORWARD_HOLD_KEY);
+
+   if (input_key_triggered_func(RARCH_FAST_FORWARD_KEY))
+      set_fast_forward(!driver.nonblock_state);
+   else if (hold_button_state != input_key_pressed_last_func(RARCH_FAST_FORWARD_HOLD_KEY))
+      set_fast_forward(hold_button_state);
+}
+
+// While fast-forwarding only some emulated frames reach the screen,
+// the rest skip filtering and the video driver entirely.
+static bool fastforward_present_frame(void)
+{
+   unsigned skip = g_settings.video.fastforward_frameskip;
 
-   if (new_button_state && !old_button_state)
+   if (skip)
+   {
+      if (g_extern.fastforward.frames % skip)
+         return false;
+   }
+   else
    {
-      driver.nonblock_state = !driver.nonblock_state;
-      driver_set_nonblock_state(driver.nonblock_state);
+      float refresh = g_settings.video.refresh_rate > 0.0f ? g_settings.video.refresh_rate : 60.0f;
+      retro_time_t now = rarch_get_time_usec();
+
+      if (now - g_extern.fastforward.last_present < (retro_time_t)(1000000.0f / refresh))
+         return false;
+      g_extern.fastforward.last_present = now;
    }
-   else if (old_hold_button_state != new_hold_button_state)
+
+   g_extern.fastforward.presented++;
+   return true;
+}
+
+// Reports the achieved speed multiplier about once a second.
+static void fastforward_update(void)
+{
+   retro_time_t now = rarch_get_time_usec();
+   float fps = g_extern.system.av_info.timing.fps;
+
+   g_extern.fastforward.frames++;
+
+   // Don't count time spent in the menu or paused.
+   if (now - g_extern.fastforward.last_frame > 250000)
    {
-      driver.nonblock_state = new_hold_button_state;
-      driver_set_nonblock_state(driver.nonblock_state);
+      g_extern.fastforward.report_start  = now;
+      g_extern.fastforward.report_frames = g_extern.fastforward.frames;
    }
+   g_extern.fastforward.last_frame = now;
+
+   if (now - g_extern.fastforward.report_start < 1000000 || fps <= 0.0f)
+      return;
+
+   char msg[64];
+   float speed = (g_extern.fastforward.frames - g_extern.fastforward.report_frames) /
+      ((now - g_extern.fastforward.report_start) / 1000000.0f) / fps;
+   snprintf(msg, sizeof(msg), "Fast-forward: %.1fx", speed);
+   msg_queue_push(g_extern.msg_queue, msg, 0, (unsigned)(g_settings.video.refresh_rate + 0.5f) + 1);
 
-   old_button_state = new_button_state;
-   old_hold_button_state = new_hold_button_state;
+   g_extern.fastforward.report_start  = now;
+   g_extern.fastforward.report_frames = g_extern.fastforward.frames;
 }
 
 #if defined(HAVE_SCREENSHOTS)
@@ -118,6 +203,22 @@ void rarch_take_screenshot(void)
 }
 #endif
 
+#ifdef HAVE_TRACE
+void rarch_dump_trace(void)
+{
+   char path[PATH_MAX];
+
+   if (*g_settings.screenshot_directory)
+      fill_pathname_join(path, g_settings.screenshot_directory, "retroarch-trace.json", sizeof(path));
+   else if (*g_extern.basename)
+      fill_pathname_noext(path, g_extern.basename, "-trace.json", sizeof(path));
+   else
+      strlcpy(path, "retroarch-trace.json", sizeof(path));
+
+   rarch_trace_dump(path);
+}
+#endif
+
 static void readjust_audio_input_rate(void)
 {
    int avail = audio_write_avail_func();
@@ -140,6 +241,9 @@ static void video_frame(const void *data, unsigned width, unsigned height, size_
    g_extern.frame_cache.height = height;
    g_extern.frame_cache.pitch  = pitch;
 
+   if (driver.nonblock_state && !g_extern.is_paused && !fastforward_present_frame())
+      return;
+
    const char *msg = msg_queue_pull(g_extern.msg_queue);
    driver.current_msg = msg;
 
@@ -150,12 +254,19 @@ static void video_frame(const void *data, unsigned width, unsigned height, size_
             &g_extern.frame.width, &g_extern.frame.height, width, height);
 
       g_extern.frame.pitch = g_extern.frame.width * g_extern.filter.out_bpp;
-      
-      rarch_softfilter_process(g_extern.filter.filter,
-            g_extern.filter.buffer, g_extern.frame.pitch,
-            data, width, height, pitch);
-
       g_extern.frame.data = g_extern.filter.buffer;
+
+#ifdef HAVE_THREADS
+      // The video thread runs the filter itself.
+      if (!driver.video_thread)
+#endif
+      {
+         RARCH_TRACE_BEGIN(RARCH_TRACE_SOFTFILTER);
+         rarch_softfilter_process(g_extern.filter.filter,
+               g_extern.filter.buffer, g_extern.frame.pitch,
+               data, width, height, pitch);
+         RARCH_TRACE_END(RARCH_TRACE_SOFTFILTER);
+      }
    }
    else 
 #endif
@@ -166,6 +277,16 @@ static void video_frame(const void *data, unsigned width, unsigned height, size_
       g_extern.frame.pitch  = pitch;
    }
    
+#ifdef HAVE_THREADS
+   // Hand over the unfiltered frame, the thread filters it.
+   if (driver.video_thread)
+   {
+      if (!video_frame_func(data, width, height, pitch, msg))
+         g_extern.video_active = false;
+      return;
+   }
+#endif
+
    if (!video_frame_func(g_extern.frame.data, g_extern.frame.width, 
                          g_extern.frame.height, g_extern.frame.pitch, msg))
       g_extern.video_active = false;
@@ -179,6 +300,57 @@ void rarch_render_cached_frame(void)
          g_extern.frame_cache.pitch);
 }
 
+static unsigned audio_resampler_mode(void)
+{
+   if (driver.nonblock_state)
+   {
+      if (g_settings.audio.fastforward_mute)
+         return AUDIO_RESAMPLER_DROP;
+      if (g_extern.audio_data.fast_resampler)
+         return AUDIO_RESAMPLER_FAST;
+   }
+   else if (g_extern.is_slowmotion && g_extern.audio_data.slow_resampler)
+      return AUDIO_RESAMPLER_SLOW;
+
+   return AUDIO_RESAMPLER_QUALITY;
+}
+
+// Sinc history is stale after running in a cheap mode. Keep running the cheap resampler
+// alongside it for a few frames and crossfade into the sinc output to avoid clicks.
+// Coming out of DROP, the output was silent, so fade in from silence instead.
+static void audio_crossfade(float *samples, const float *from, size_t frames)
+{
+   size_t i;
+   for (i = 0; i < frames && g_extern.audio_data.fade_frames; i++)
+   {
+      float gain = 1.0f - (float)g_extern.audio_data.fade_frames / AUDIO_RESAMPLER_FADE_FRAMES;
+      float l = from ? from[(i << 1) + 0] : 0.0f;
+      float r = from ? from[(i << 1) + 1] : 0.0f;
+      samples[(i << 1) + 0] = l + (samples[(i << 1) + 0] - l) * gain;
+      samples[(i << 1) + 1] = r + (samples[(i << 1) + 1] - r) * gain;
+      g_extern.audio_data.fade_frames--;
+   }
+}
+
+static void audio_resampler_process(unsigned mode, struct resampler_data *data)
+{
+   switch (mode)
+   {
+      case AUDIO_RESAMPLER_FAST:
+         rarch_resampler_process(g_extern.audio_data.fast_resampler,
+               g_extern.audio_data.fast_resampler_data, data);
+         break;
+      case AUDIO_RESAMPLER_SLOW:
+         rarch_resampler_process(g_extern.audio_data.slow_resampler,
+               g_extern.audio_data.slow_resampler_data, data);
+         break;
+      default:
+         rarch_resampler_process(g_extern.audio_data.resampler,
+               g_extern.audio_data.resampler_data, data);
+         break;
+   }
+}
+
 static bool audio_flush(const int16_t *data, size_t samples)
 {
    if (g_extern.is_paused || g_settings.audio.mute)
@@ -186,6 +358,24 @@ static bool audio_flush(const int16_t *data, size_t samples)
    if (!g_extern.audio_active)
       return false;
 
+   unsigned mode = audio_resampler_mode();
+   if (mode != g_extern.audio_data.resampler_mode)
+   {
+      if (mode == AUDIO_RESAMPLER_QUALITY)
+      {
+         g_extern.audio_data.fade_mode   = g_extern.audio_data.resampler_mode;
+         g_extern.audio_data.fade_frames = AUDIO_RESAMPLER_FADE_FRAMES;
+      }
+      else
+         g_extern.audio_data.fade_frames = 0;
+      g_extern.audio_data.resampler_mode = mode;
+   }
+
+   if (mode == AUDIO_RESAMPLER_DROP)
+      return true;
+
+   RARCH_TRACE_BEGIN(RARCH_TRACE_AUDIO_FLUSH);
+
    const float *output_data = NULL;
    unsigned output_frames      = 0;
 
@@ -205,21 +395,34 @@ static bool audio_flush(const int16_t *data, size_t samples)
    if (g_extern.is_slowmotion)
       src_data.ratio *= g_settings.slowmotion_ratio;
 
-   rarch_resampler_process(g_extern.audio_data.resampler,
-         g_extern.audio_data.resampler_data, &src_data);
+   audio_resampler_process(mode, &src_data);
 
    output_data   = g_extern.audio_data.outsamples;
    output_frames = src_data.output_frames;
 
+   if (g_extern.audio_data.fade_frames && g_extern.audio_data.fade_mode == AUDIO_RESAMPLER_DROP)
+      audio_crossfade(g_extern.audio_data.outsamples, NULL, output_frames);
+   else if (g_extern.audio_data.fade_frames)
+   {
+      struct resampler_data fade_data = src_data;
+      fade_data.data_out = g_extern.audio_data.fade_outsamples;
+      audio_resampler_process(g_extern.audio_data.fade_mode, &fade_data);
+
+      audio_crossfade(g_extern.audio_data.outsamples, g_extern.audio_data.fade_outsamples,
+            min(output_frames, fade_data.output_frames));
+   }
+
    audio_convert_float_to_s16(g_extern.audio_data.conv_outsamples,
          output_data, output_frames * 2);
 
    if (audio_write_func(g_extern.audio_data.conv_outsamples, output_frames * sizeof(int16_t) * 2) < 0)
    {
       RARCH_ERR("Audio backend failed to write. Will continue without sound.\n");
+      RARCH_TRACE_END(RARCH_TRACE_AUDIO_FLUSH);
       return false;
    }
 
+   RARCH_TRACE_END(RARCH_TRACE_AUDIO_FLUSH);
    return true;
 }
 
@@ -263,9 +466,42 @@ size_t audio_sample_batch(const int16_t *data, size_t frames)
    return frames;
 }
 
-void rarch_input_poll(void)
+#ifdef PERF_TEST
+// Time from the start of pretro_run() to the first input poll of the frame.
+static struct rarch_perf_counter input_poll_delay = {{"input_poll_delay"}};
+#endif
+
+static void input_poll_now(void)
 {
+   g_extern.input.poll_pending = false;
+
+#ifdef PERF_TEST
+   if (g_extern.input.in_core_run && !g_extern.input.polled)
+   {
+      if (!input_poll_delay.base.registered)
+         rarch_perf_register(&input_poll_delay);
+      input_poll_delay.base.call_cnt++;
+      input_poll_delay.base.start = g_extern.input.frame_start;
+      rarch_perf_stop(&input_poll_delay);
+   }
+#endif
+   g_extern.input.polled = true;
+
+   RARCH_TRACE_BEGIN(RARCH_TRACE_INPUT_POLL);
    input_poll_func();
+   input_snapshot_poll();
+   RARCH_TRACE_END(RARCH_TRACE_INPUT_POLL);
+}
+
+// With lazy polling, a poll requested by the core while it runs is only recorded.
+// The first input_state() call does the actual poll, so the controllers are sampled
+// as late in the frame as the core allows.
+void rarch_input_poll(void)
+{
+   if (g_settings.input.lazy_poll && g_extern.input.in_core_run)
+      g_extern.input.poll_pending = true;
+   else
+      input_poll_now();
 }
 
 // Turbo scheme: If turbo button is held, all buttons pressed except for D-pad will go into
@@ -289,22 +525,55 @@ static int16_t input_state(unsigned port, unsigned device, unsigned index, unsig
    device &= RETRO_DEVICE_MASK;
 
    static const struct retro_keybind *binds[MAX_PLAYERS] = {
-      g_settings.input.binds[0],
-      g_settings.input.binds[1],
-      g_settings.input.binds[2],
-      g_settings.input.binds[3],
+      g_extern.input.binds[0],
+      g_extern.input.binds[1],
+      g_extern.input.binds[2],
+      g_extern.input.binds[3],
    };
 
-   /* Change the port according to the mapping */
-   port = g_settings.input.device_port[port];
-
    int16_t res = 0;
-   if (id < RARCH_FIRST_META_KEY)
-      res = input_input_state_func(binds, port, device, index, id);
 
-   // Don't allow turbo for D-pad.
-   if (device == RETRO_DEVICE_JOYPAD && (id < RETRO_DEVICE_ID_JOYPAD_UP || id > RETRO_DEVICE_ID_JOYPAD_RIGHT))
-      res = input_apply_turbo(port, id, res);
+   if (g_extern.input.poll_pending)
+      input_poll_now();
+
+   if (g_extern.bsv.movie && g_extern.bsv.movie_playback)
+   {
+      if (bsv_movie_get_input(g_extern.bsv.movie, &res))
+         return res;
+
+      // Core polled more than was recorded, we are out of sync. Feed zeros.
+      return 0;
+   }
+
+   if (port < MAX_PLAYERS)
+   {
+      /* Change the port according to the mapping */
+      port = g_settings.input.device_port[port];
+
+      switch (device)
+      {
+         case RETRO_DEVICE_JOYPAD:
+            if (id < RARCH_FIRST_META_KEY)
+               res = (g_extern.input.buttons[port] >> id) & 1;
+            break;
+
+         case RETRO_DEVICE_ANALOG:
+            if (index < 2 && id < 2)
+               res = g_extern.input.analog[port][index][id];
+            break;
+
+         default:
+            res = input_input_state_func(binds, port, device, index, id);
+            break;
+      }
+
+      // Don't allow turbo for D-pad.
+      if (device == RETRO_DEVICE_JOYPAD && (id < RETRO_DEVICE_ID_JOYPAD_UP || id > RETRO_DEVICE_ID_JOYPAD_RIGHT))
+         res = input_apply_turbo(port, id, res);
+   }
+
+   if (g_extern.bsv.movie && !g_extern.bsv.movie_playback)
+      bsv_movie_set_input(g_extern.bsv.movie, res);
 
    return res;
 }
@@ -344,6 +613,7 @@ static void parse_input(int argc, char *argv[])
 {
    g_extern.libretro_no_rom = false;
    g_extern.libretro_dummy = false;
+   g_extern.libretro_stress = false;
 
    if (argc < 2)
    {
@@ -360,6 +630,13 @@ static void parse_input(int argc, char *argv[])
       { "save", 1, NULL, 's' },
       { "config", 1, NULL, 'c' },
       { "savestate", 1, NULL, 'S' },
+      { "benchmark", 1, NULL, 'B' },
+      { "bsvplay", 1, NULL, 'P' },
+      { "record", 1, NULL, 'R' },
+      { "bsvverify", 0, NULL, 'V' },
+#ifdef HAVE_STRESS_CORE
+      { "stress", 0, NULL, 'T' },
+#endif
       { NULL, 0, NULL, 0 }
    };
 
@@ -388,6 +665,24 @@ static void parse_input(int argc, char *argv[])
             strlcpy(g_extern.config_path, optarg, sizeof(g_extern.config_path));
             break;
 
+         case 'B':
+            g_extern.benchmark_frames = strtoul(optarg, NULL, 0);
+            break;
+
+         case 'P':
+         case 'R':
+            strlcpy(g_extern.bsv.movie_path, optarg, sizeof(g_extern.bsv.movie_path));
+            g_extern.bsv.movie_playback = c == 'P';
+            break;
+
+         case 'V':
+            g_extern.bsv.movie_verify = true;
+            break;
+
+         case 'T':
+            g_extern.libretro_stress = true;
+            break;
+
          case 0:
             switch (val)
             {
@@ -492,6 +787,12 @@ void rarch_init_rewind(void)
    if (!g_settings.rewind_enable || g_extern.state_manager)
       return;
 
+   if (g_extern.bsv.movie)
+   {
+      RARCH_WARN("Rewind is disabled while a movie is active.\n");
+      return;
+   }
+
    g_extern.state_size = pretro_serialize_size();
    if (!g_extern.state_size)
    {
@@ -511,6 +812,26 @@ void rarch_init_rewind(void)
    state_manager_push_do(g_extern.state_manager);
 }
 
+static void init_movie(void)
+{
+   if (!*g_extern.bsv.movie_path)
+      return;
+
+   g_extern.bsv.movie = bsv_movie_init(g_extern.bsv.movie_path,
+         g_extern.bsv.movie_playback ? RARCH_MOVIE_PLAYBACK : RARCH_MOVIE_RECORD,
+         g_settings.movie_checksum_interval);
+
+   if (!g_extern.bsv.movie)
+      RARCH_ERR("Failed to start movie \"%s\", continuing without it.\n", g_extern.bsv.movie_path);
+}
+
+static void deinit_movie(void)
+{
+   if (g_extern.bsv.movie)
+      bsv_movie_free(g_extern.bsv.movie);
+   g_extern.bsv.movie = NULL;
+}
+
 void rarch_deinit_rewind(void)
 {
    if (g_extern.state_manager)
@@ -642,22 +963,13 @@ void rarch_save_state(void)
 // Save or load state here.
 static void check_savestates(bool immutable)
 {
-   static bool old_should_savestate = false;
    bool should_savestate = input_key_pressed_func(RARCH_SAVE_STATE_KEY);
 
-   if (should_savestate && !old_should_savestate)
+   if (input_key_triggered_func(RARCH_SAVE_STATE_KEY))
       rarch_save_state();
-   old_should_savestate = should_savestate;
 
-   if (!immutable)
-   {
-      static bool old_should_loadstate = false;
-      bool should_loadstate = input_key_pressed_func(RARCH_LOAD_STATE_KEY);
-
-      if (!should_savestate && should_loadstate && !old_should_loadstate)
-         rarch_load_state();
-      old_should_loadstate = should_loadstate;
-   }
+   if (!immutable && !should_savestate && input_key_triggered_func(RARCH_LOAD_STATE_KEY))
+      rarch_load_state();
 }
 
 void rarch_reset_drivers(void)
@@ -667,7 +979,7 @@ void rarch_reset_drivers(void)
 
    // Poll input to avoid possibly stale data to corrupt things.
    if (driver.input)
-      input_poll_func();
+      rarch_input_poll();
 }
 
 void rarch_state_slot_increase(void)
@@ -707,17 +1019,11 @@ void rarch_state_slot_decrease(void)
 static void check_stateslots(void)
 {
    // Save state slots
-   static bool old_should_slot_increase = false;
-   bool should_slot_increase = input_key_pressed_func(RARCH_STATE_SLOT_PLUS);
-   if (should_slot_increase && !old_should_slot_increase)
+   if (input_key_triggered_func(RARCH_STATE_SLOT_PLUS))
       rarch_state_slot_increase();
-   old_should_slot_increase = should_slot_increase;
 
-   static bool old_should_slot_decrease = false;
-   bool should_slot_decrease = input_key_pressed_func(RARCH_STATE_SLOT_MINUS);
-   if (should_slot_decrease && !old_should_slot_decrease)
+   if (input_key_triggered_func(RARCH_STATE_SLOT_MINUS))
       rarch_state_slot_decrease();
-   old_should_slot_decrease = should_slot_decrease;
 }
 
 static inline void flush_rewind_audio(void)
@@ -771,12 +1077,14 @@ static void check_rewind(void)
          setup_rewind_audio();
 
          msg_queue_push(g_extern.msg_queue, "Rewinding.", 0, g_extern.is_paused ? 1 : 30);
+         RARCH_TRACE_BEGIN(RARCH_TRACE_REWIND_POP);
          pretro_unserialize(buf, g_extern.state_size);
+         RARCH_TRACE_END(RARCH_TRACE_REWIND_POP);
       }
       else
          msg_queue_push(g_extern.msg_queue, "Reached end of rewind buffer.", 0, 30);
    }
-   else
+   else if (!driver.nonblock_state || g_settings.rewind_fastforward)
    {
       static unsigned cnt = 0;
       cnt = (cnt + 1) % (g_settings.rewind_granularity ? g_settings.rewind_granularity : 1); // Avoid possible SIGFPE.
@@ -784,9 +1092,11 @@ static void check_rewind(void)
       if (cnt == 0)
       {
          void *state;
+         RARCH_TRACE_BEGIN(RARCH_TRACE_REWIND_PUSH);
          state_manager_push_where(g_extern.state_manager, &state);
          pretro_serialize(state, g_extern.state_size);
          state_manager_push_do(g_extern.state_manager);
+         RARCH_TRACE_END(RARCH_TRACE_REWIND_PUSH);
       }
    }
 
@@ -808,13 +1118,12 @@ static void check_slowmotion(void)
 
 static void check_pause(void)
 {
-   static bool old_state = false;
-   bool new_state = input_key_pressed_func(RARCH_PAUSE_TOGGLE);
+   bool new_state = input_key_triggered_func(RARCH_PAUSE_TOGGLE);
 
    // FRAMEADVANCE will set us into pause mode.
-   new_state |= !g_extern.is_paused && input_key_pressed_func(RARCH_FRAMEADVANCE);
+   new_state |= !g_extern.is_paused && input_key_triggered_func(RARCH_FRAMEADVANCE);
 
-   if (new_state && !old_state)
+   if (new_state)
    {
       g_extern.is_paused = !g_extern.is_paused;
 
@@ -837,22 +1146,14 @@ static void check_pause(void)
          }
       }
    }
-   
-   old_state = new_state;
 }
 
 static void check_oneshot(void)
 {
-   static bool old_state = false;
-   bool new_state = input_key_pressed_func(RARCH_FRAMEADVANCE);
-   g_extern.is_oneshot = (new_state && !old_state);
-   old_state = new_state;
+   g_extern.is_oneshot = input_key_triggered_func(RARCH_FRAMEADVANCE);
 
    // Rewind buttons works like FRAMEREWIND when paused. We will one-shot in that case.
-   static bool old_rewind_state = false;
-   bool new_rewind_state = input_key_pressed_func(RARCH_REWIND);
-   g_extern.is_oneshot |= new_rewind_state && !old_rewind_state;
-   old_rewind_state = new_rewind_state;
+   g_extern.is_oneshot |= input_key_triggered_func(RARCH_REWIND);
 }
 
 void rarch_game_reset(void)
@@ -863,12 +1164,8 @@ void rarch_game_reset(void)
 
 static void check_reset(void)
 {
-   static bool old_state = false;
-   bool new_state = input_key_pressed_func(RARCH_RESET);
-   if (new_state && !old_state)
+   if (input_key_triggered_func(RARCH_RESET))
       rarch_game_reset();
-
-   old_state = new_state;
 }
 
 static void check_turbo(void)
@@ -877,16 +1174,8 @@ static void check_turbo(void)
 
    g_extern.turbo_count++;
 
-   static const struct retro_keybind *binds[MAX_PLAYERS] = {
-      g_settings.input.binds[0],
-      g_settings.input.binds[1],
-      g_settings.input.binds[2],
-      g_settings.input.binds[3],
-   };
-
    for (i = 0; i < MAX_PLAYERS; i++)
-      g_extern.turbo_frame_enable[i] =
-         input_input_state_func(binds, i, RETRO_DEVICE_JOYPAD, 0, RARCH_TURBO_ENABLE);
+      g_extern.turbo_frame_enable[i] = g_extern.input.buttons[i] & (1ULL << RARCH_TURBO_ENABLE);
 }
 
 void rarch_disk_control_append_image(const char *path)
@@ -1000,18 +1289,12 @@ static void check_disk(void)
    if (!control->get_num_images)
       return;
 
-   static bool old_pressed_eject;
-   static bool old_pressed_next;
-
-   bool pressed_eject = input_key_pressed_func(RARCH_DISK_EJECT_TOGGLE);
-   bool pressed_next  = input_key_pressed_func(RARCH_DISK_NEXT);
-
-   if (pressed_eject && !old_pressed_eject)
+   if (input_key_triggered_func(RARCH_DISK_EJECT_TOGGLE))
    {
       bool new_state = !control->get_eject_state();
       rarch_disk_control_set_eject(new_state, true);
    }
-   else if (pressed_next && !old_pressed_next)
+   else if (input_key_triggered_func(RARCH_DISK_NEXT))
    {
       unsigned num_disks = control->get_num_images();
       unsigned current   = control->get_image_index();
@@ -1024,35 +1307,30 @@ static void check_disk(void)
       else
          RARCH_ERR("Got invalid disk index from libretro.\n");
    }
-
-   old_pressed_eject = pressed_eject;
-   old_pressed_next  = pressed_next;
 }
 
 #if defined(HAVE_SCREENSHOTS)
 static void check_screenshot(void)
 {
-   static bool old_pressed;
-   bool pressed = input_key_pressed_func(RARCH_SCREENSHOT);
-   if (pressed && !old_pressed)
+   if (input_key_triggered_func(RARCH_SCREENSHOT))
+   {
       rarch_take_screenshot();
-
-   old_pressed = pressed;
+#ifdef HAVE_TRACE
+      // A screenshot is usually taken right after seeing a hitch, so grab the trace too.
+      rarch_dump_trace();
+#endif
+   }
 }
 #endif
 
 static void check_quick_swap(void)
 {
-   static bool old_pressed;
-   
    if (g_settings.input.quick_swap_players < 2 ||
          g_settings.input.quick_swap_players > MAX_PLAYERS)
       return;
 
-   bool pressed = input_key_pressed_func(RARCH_QUICK_SWAP);
-   if (pressed && !old_pressed) quick_swap_controllers();
-
-   old_pressed = pressed;
+   if (input_key_triggered_func(RARCH_QUICK_SWAP))
+      quick_swap_controllers();
 }
 
 static void check_mute(void)
@@ -1060,9 +1338,7 @@ static void check_mute(void)
    if (!g_extern.audio_active)
       return;
 
-   static bool old_pressed;
-   bool pressed = input_key_pressed_func(RARCH_MUTE);
-   if (pressed && !old_pressed)
+   if (input_key_triggered_func(RARCH_MUTE))
    {
       g_settings.audio.mute = !g_settings.audio.mute;
 
@@ -1083,8 +1359,6 @@ static void check_mute(void)
 
       RARCH_LOG("%s\n", msg);
    }
-
-   old_pressed = pressed;
 }
 
 static void check_volume(void)
@@ -1150,12 +1424,14 @@ static void do_state_checks(void)
 
    check_fast_forward_button();
    check_stateslots();
-   check_savestates(false);
+   // Anything that changes state behind the core's back breaks a movie.
+   check_savestates(g_extern.bsv.movie != NULL);
    check_rewind();
    check_slowmotion();
    check_disk();
    check_quick_swap();
-   check_reset();
+   if (!g_extern.bsv.movie)
+      check_reset();
 }
 
 static void init_state(void)
@@ -1172,6 +1448,9 @@ static void init_state_first(void)
    
 #ifdef HAVE_FILE_LOGGER
    g_extern.log_file = fopen(LOG_FILENAME, "a");
+   // Host builds have no /retroarch, log to the console instead.
+   if (!g_extern.log_file)
+      g_extern.log_file = stderr;
 #endif
 
    /* Default pixel format */
@@ -1186,10 +1465,18 @@ void rarch_main_clear_state(void)
    memset(&g_settings, 0, sizeof(g_settings));
 
 #ifdef HAVE_FILE_LOGGER
-   if (g_extern.log_file)
+   if (g_extern.log_file && g_extern.log_file != stderr)
       fclose(g_extern.log_file);
 #endif
 
+   // Core options or core info loaded since startup might still be pending.
+   config_cache_flush(g_extern.config_cache);
+   config_cache_free(g_extern.config_cache);
+
+#ifdef HAVE_ZLIB
+   zlib_dir_cache_free();
+#endif
+
    memset(&g_extern, 0, sizeof(g_extern));
 
    init_state_first();
@@ -1235,6 +1522,36 @@ static void validate_cpu_features(void)
    RARCH_ERR(simd_type " code is compiled in, but CPU does not support this feature. Cannot continue.\n"); \
    rarch_fail(1, "validate_cpu_features()"); \
 } while(0)
+
+#ifdef __SSE__
+   if (!(cpu & RETRO_SIMD_SSE))
+      FAIL_CPU("SSE");
+#endif
+#ifdef __SSE2__
+   if (!(cpu & RETRO_SIMD_SSE2))
+      FAIL_CPU("SSE2");
+#endif
+#ifdef __AVX__
+   if (!(cpu & RETRO_SIMD_AVX))
+      FAIL_CPU("AVX");
+#endif
+}
+
+// Benchmark runs as fast as possible regardless of config, and must not write config back.
+// Runs before find_drivers(), main() skips the global driver init for --benchmark.
+static void init_benchmark_settings(void)
+{
+#ifdef HAVE_NULLDRIVERS
+   strlcpy(g_settings.video.driver, "null", sizeof(g_settings.video.driver));
+   strlcpy(g_settings.audio.driver, "null", sizeof(g_settings.audio.driver));
+   strlcpy(g_settings.input.driver, "null", sizeof(g_settings.input.driver));
+#endif
+   g_settings.video.vsync          = false;
+   g_settings.audio.sync           = false;
+   g_settings.audio.rate_control   = false;
+   g_settings.config_save_on_exit  = false;
+
+   RARCH_LOG("Benchmarking %u frames.\n", g_extern.benchmark_frames);
 }
 
 int rarch_main_init(int argc, char *argv[])
@@ -1250,6 +1567,8 @@ int rarch_main_init(int argc, char *argv[])
    parse_input(argc, argv);
    validate_cpu_features();
    config_load();
+   if (g_extern.benchmark_frames)
+      init_benchmark_settings();
    init_libretro_sym(g_extern.libretro_dummy);
    rarch_init_system_info();
    verify_api_version();
@@ -1281,8 +1600,9 @@ int rarch_main_init(int argc, char *argv[])
    pretro_get_system_av_info(&g_extern.system.av_info);
    find_drivers();   
    init_drivers();
-   rarch_init_rewind();
    init_controllers();
+   init_movie();
+   rarch_init_rewind();
 
    g_extern.use_sram = g_extern.use_sram && !g_extern.sram_save_disable;
 
@@ -1350,7 +1670,7 @@ static inline void update_frame_time(void)
 
 bool rarch_main_iterate(void)
 {
-   unsigned i;
+   bool movie_ended = false;
 
    // SHUTDOWN on consoles should exit RetroArch completely.
    if (g_extern.system.core_shutdown)
@@ -1363,24 +1683,61 @@ bool rarch_main_iterate(void)
    if (check_enter_rgui())
       return false; // Enter menu, don't exit.
 
+   RARCH_TRACE_BEGIN(RARCH_TRACE_FRAME);
+
    // Checks for stuff like save states, etc.
    do_state_checks();
-
-   // Update binds for analog dpad modes.
-   for (i = 0; i < MAX_PLAYERS; i++)
-      input_push_analog_dpad(g_settings.input.binds[i], g_settings.input.analog_dpad_mode[i]);
+   input_snapshot_latch();
 
    update_frame_time();
-   pretro_run();
 
-   for (i = 0; i < MAX_PLAYERS; i++)
-      input_pop_analog_dpad(g_settings.input.binds[i]);
+   if (g_extern.bsv.movie && !bsv_movie_set_frame_start(g_extern.bsv.movie))
+   {
+      RARCH_LOG("Movie playback ended.\n");
+      movie_ended = true;
+   }
 
-   return true;
+   if (!movie_ended)
+   {
+#ifdef PERF_TEST
+      g_extern.input.frame_start = rarch_get_perf_counter();
+#endif
+      g_extern.input.polled      = false;
+      g_extern.input.in_core_run = true;
+
+      RARCH_TRACE_BEGIN(RARCH_TRACE_CORE_RUN);
+      pretro_run();
+      RARCH_TRACE_END(RARCH_TRACE_CORE_RUN);
+
+      // The core asked for a poll but never read input, hotkeys still need fresh state.
+      g_extern.input.in_core_run = false;
+      if (g_extern.input.poll_pending)
+         input_poll_now();
+
+      if (g_extern.bsv.movie && !bsv_movie_set_frame_end(g_extern.bsv.movie) && g_extern.bsv.movie_verify)
+         movie_ended = true;
+
+      if (driver.nonblock_state)
+         fastforward_update();
+   }
+
+   RARCH_TRACE_END(RARCH_TRACE_FRAME);
+
+   // Playback is meant for repeatable runs, so stop when the movie does.
+   return !movie_ended;
 }
 
 void rarch_main_deinit(void)
 {
+   // Fast-forward carries over to the next game, but the summary is per game.
+   if (driver.nonblock_state)
+   {
+      fastforward_end();
+      fastforward_begin();
+   }
+
+   deinit_movie();
+
    if (g_extern.use_sram)
       save_files();
 
@@ -1469,6 +1826,7 @@ bool rarch_main_idle_iterate(void)
       return false;
 
    do_state_checks();
+   input_snapshot_latch();
    rarch_input_poll();
    rarch_sleep(10);
    return true;
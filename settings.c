@@ -22,6 +22,10 @@
 #include "input/input_common.h"
 #include <ctype.h>
 
+#ifndef ATTRIBUTE_ALIGN // libogc macro, missing on host builds.
+#define ATTRIBUTE_ALIGN(v) __attribute__((aligned(v)))
+#endif
+
 struct settings g_settings ATTRIBUTE_ALIGN(32);
 struct global g_extern ATTRIBUTE_ALIGN(32);
 
@@ -35,6 +39,8 @@ void config_set_defaults(void)
    strlcpy(g_settings.audio.resampler, DEFAULT_RESAMPLER_DRIVER, sizeof(g_settings.audio.resampler));   
 
    g_settings.video.vsync = DEFAULT_VIDEO_VSYNC;
+   g_settings.video.threaded = DEFAULT_VIDEO_THREADED;
+   g_settings.video.fastforward_frameskip = DEFAULT_VIDEO_FASTFORWARD_FRAMESKIP;
    g_settings.video.bilinear_filter = DEFAULT_VIDEO_BILINEAR_FILTER;
    g_settings.video.force_aspect = DEFAULT_VIDEO_FORCE_ASPECT;
    g_settings.video.scale_integer = DEFAULT_VIDEO_SCALE_INTEGER;
@@ -68,6 +74,8 @@ void config_set_defaults(void)
    g_settings.audio.rate_control_delta = DEFAULT_AUDIO_RATE_CONTROL_DELTA;
    g_settings.audio.volume = DEFAULT_AUDIO_VOLUME;
    g_settings.audio.mute = DEFAULT_AUDIO_MUTE;
+   g_settings.audio.fast_resampler = DEFAULT_AUDIO_FAST_RESAMPLER;
+   g_settings.audio.fastforward_mute = DEFAULT_AUDIO_FASTFORWARD_MUTE;
    g_extern.audio_data.volume_db   = DEFAULT_AUDIO_VOLUME;
    g_extern.audio_data.volume_gain = db_to_gain(DEFAULT_AUDIO_VOLUME);
    g_extern.audio_data.in_rate = DEFAULT_AUDIO_OUT_RATE;
@@ -75,6 +83,8 @@ void config_set_defaults(void)
    g_settings.rewind_enable = DEFAULT_REWIND_ENABLE;
    g_settings.rewind_buffer_size = DEFAULT_REWIND_BUFFER_SIZE;
    g_settings.rewind_granularity = DEFAULT_REWIND_GRANULARITY;
+   g_settings.rewind_fastforward = DEFAULT_REWIND_FASTFORWARD;
+   g_settings.movie_checksum_interval = DEFAULT_MOVIE_CHECKSUM_INTERVAL;
 
    g_settings.block_sram_overwrite = DEFAULT_BLOCK_SRAM_OVERWRITE;
    g_settings.savestate_auto_save  = DEFAULT_SAVESTATE_AUTO_SAVE;
@@ -101,6 +111,7 @@ void config_set_defaults(void)
    g_settings.input.turbo_period = DEFAULT_TURBO_PERIOD;
    g_settings.input.turbo_duty_cycle = DEFAULT_TURBO_DUTY_CYCLE;
    g_settings.input.autoconf_buttons = DEFAULT_INPUT_AUTOCONF_BUTTONS;
+   g_settings.input.lazy_poll = DEFAULT_INPUT_LAZY_POLL;
    g_settings.input.menu_all_players_enable = DEFAULT_MENU_ALL_PLAYERS_ENABLE;
    g_settings.input.quick_swap_players = DEFAULT_QUICK_SWAP_PLAYERS;
    *g_settings.input.overlay_path = DEFAULT_INPUT_OVERLAY_PATH;
@@ -113,6 +124,7 @@ void config_set_defaults(void)
    memcpy(g_settings.input.menu_binds, retro_keybinds_menu, sizeof(retro_keybinds_menu));
    for (i = 1; i < MAX_PLAYERS; i++)
       memcpy(g_settings.input.binds[i], retro_keybinds_rest, sizeof(retro_keybinds_rest));
+   input_snapshot_invalidate();
 
    // Verify that binds are in proper order.
    for (i = 0; i < MAX_PLAYERS; i++)
@@ -284,7 +296,7 @@ bool global_config_load_file(const char *path)
 
    if (*path)
    {
-      conf = config_file_new(path);
+      conf = config_cache_load(g_extern.config_cache, path);
       if (!conf)
          return false;
    }
@@ -341,7 +353,7 @@ bool config_load_file(const char *path)
 
    if (*path)
    {
-      conf = config_file_new(path);
+      conf = config_cache_load(g_extern.config_cache, path);
       if (!conf)
          return false;
    }
@@ -349,6 +361,8 @@ bool config_load_file(const char *path)
       return false;
 
    CONFIG_GET_BOOL(video.vsync, "video_vsync");
+   CONFIG_GET_BOOL(video.threaded, "video_threaded");
+   CONFIG_GET_INT(video.fastforward_frameskip, "video_fastforward_frameskip");
    CONFIG_GET_BOOL(video.bilinear_filter, "video_bilinear_filter");
    CONFIG_GET_BOOL(video.force_aspect, "video_force_aspect");
    CONFIG_GET_BOOL(video.scale_integer, "video_scale_integer");
@@ -393,6 +407,8 @@ bool config_load_file(const char *path)
    CONFIG_GET_BOOL(audio.sync, "audio_sync");
    CONFIG_GET_BOOL(audio.rate_control, "audio_rate_control");
    CONFIG_GET_FLOAT(audio.rate_control_delta, "audio_rate_control_delta");
+   CONFIG_GET_BOOL(audio.fast_resampler, "audio_fast_resampler");
+   CONFIG_GET_BOOL(audio.fastforward_mute, "audio_fastforward_mute");
    CONFIG_GET_FLOAT(audio.volume, "audio_volume");
    g_extern.audio_data.volume_db   = g_settings.audio.volume;
    g_extern.audio_data.volume_gain = db_to_gain(g_settings.audio.volume);
@@ -406,6 +422,8 @@ bool config_load_file(const char *path)
    if (config_get_int(conf, "rewind_buffer_size", &buffer_size))
       g_settings.rewind_buffer_size = buffer_size * UINT64_C(1000000);
    CONFIG_GET_INT(rewind_granularity, "rewind_granularity");
+   CONFIG_GET_BOOL(rewind_fastforward, "rewind_fastforward");
+   CONFIG_GET_INT(movie_checksum_interval, "movie_checksum_interval");
    CONFIG_GET_FLOAT(slowmotion_ratio, "slowmotion_ratio");
    if (g_settings.slowmotion_ratio < 1.0f)
       g_settings.slowmotion_ratio = DEFAULT_SLOWMOTION_RATIO;
@@ -415,6 +433,7 @@ bool config_load_file(const char *path)
    CONFIG_GET_INT(input.turbo_period, "input_turbo_period");
    CONFIG_GET_INT(input.turbo_duty_cycle, "input_duty_cycle");
    CONFIG_GET_BOOL(input.autoconf_buttons, "input_autoconf_buttons");
+   CONFIG_GET_BOOL(input.lazy_poll, "input_lazy_poll");
    CONFIG_GET_INT(input.quick_swap_players, "quick_swap_players");
 
    config_read_keybinds_conf(conf);
@@ -464,6 +483,8 @@ static void config_read_keybinds_conf(config_file_t *conf)
    unsigned i;
    for (i = 0; i < MAX_PLAYERS; i++)
       read_keybinds_player(conf, i);
+
+   input_snapshot_invalidate();
 }
 
 static void save_keybind_joykey(config_file_t *conf, const char *prefix, const char *base,
@@ -529,9 +550,28 @@ static void save_keybinds_player(config_file_t *conf, unsigned player)
    }
 }
 
+// Writes the config only if saving changed anything. A rewritten file is parsed back into
+// config_cache, so the next boot still hits the cache for it.
+static bool config_save_if_modified(config_file_t *conf, const char *path)
+{
+   bool ret = true;
+
+   if (config_file_is_modified(conf))
+   {
+      ret = config_file_write(conf, path);
+      if (ret)
+         config_file_free(config_cache_load(g_extern.config_cache, path));
+   }
+   else
+      RARCH_LOG("Config at path \"%s\" is unchanged, not rewriting.\n", path);
+
+   config_file_free(conf);
+   return ret;
+}
+
 bool global_config_save_file(const char *path)
 {
-   config_file_t *conf = config_file_new(path);
+   config_file_t *conf = config_cache_load(g_extern.config_cache, path);
    if (!conf)
       conf = config_file_new(NULL);
    if (!conf)
@@ -560,15 +600,13 @@ bool global_config_save_file(const char *path)
    config_set_path(conf, "savefile_directory", g_settings.savefile_directory);
    config_set_path(conf, "savestate_directory", g_settings.savestate_directory);
 
-   bool ret = config_file_write(conf, path);
-   config_file_free(conf);
-   return ret;
+   return config_save_if_modified(conf, path);
 }
 
 bool config_save_file(const char *path)
 {
    unsigned i = 0;
-   config_file_t *conf = config_file_new(path);
+   config_file_t *conf = config_cache_load(g_extern.config_cache, path);
    if (!conf)
       conf = config_file_new(NULL);
    if (!conf)
@@ -581,16 +619,22 @@ bool config_save_file(const char *path)
    config_set_int(conf,   "filter_index",  g_settings.video.filter_idx);
 #endif
    config_set_int(conf, "rewind_granularity", g_settings.rewind_granularity);
+   config_set_bool(conf, "rewind_fastforward", g_settings.rewind_fastforward);
+   config_set_int(conf, "movie_checksum_interval", g_settings.movie_checksum_interval);
    config_set_bool(conf, "video_crop_overscan", g_settings.video.crop_overscan);
    config_set_bool(conf, "video_scale_integer", g_settings.video.scale_integer);
    config_set_bool(conf, "video_force_aspect", g_settings.video.force_aspect);
    config_set_bool(conf, "video_bilinear_filter", g_settings.video.bilinear_filter);
    config_set_float(conf, "video_refresh_rate", g_settings.video.refresh_rate);
    config_set_bool(conf, "video_vsync", g_settings.video.vsync);
+   config_set_bool(conf, "video_threaded", g_settings.video.threaded);
+   config_set_int(conf, "video_fastforward_frameskip", g_settings.video.fastforward_frameskip);
    config_set_int(conf, "video_rotation", g_settings.video.rotation);
    config_set_int(conf, "aspect_ratio_index", g_settings.video.aspect_ratio_idx);
    config_set_bool(conf, "audio_rate_control", g_settings.audio.rate_control);
    config_set_float(conf, "audio_rate_control_delta", g_settings.audio.rate_control_delta);
+   config_set_bool(conf, "audio_fast_resampler", g_settings.audio.fast_resampler);
+   config_set_bool(conf, "audio_fastforward_mute", g_settings.audio.fastforward_mute);
    config_set_int(conf, "audio_out_rate", g_settings.audio.out_rate);
    g_settings.audio.volume = g_extern.audio_data.volume_db;
    config_set_float(conf, "audio_volume", g_settings.audio.volume);
@@ -615,6 +659,7 @@ bool config_save_file(const char *path)
    config_set_bool(conf, "savestate_auto_load", g_settings.savestate_auto_load);
    config_set_int(conf, "state_slot", g_settings.state_slot);
    config_set_bool(conf, "input_autoconf_buttons", g_settings.input.autoconf_buttons);
+   config_set_bool(conf, "input_lazy_poll", g_settings.input.lazy_poll);
    config_set_int(conf, "quick_swap_players", g_settings.input.quick_swap_players);
    
    for (i = 0; i < MAX_PLAYERS; i++)
@@ -629,7 +674,5 @@ bool config_save_file(const char *path)
    for (i = 0; i < MAX_PLAYERS; i++)
       save_keybinds_player(conf, i);
 
-   bool ret = config_file_write(conf, path);
-   config_file_free(conf);
-   return ret;
+   return config_save_if_modified(conf, path);
 }
@@ -0,0 +1,134 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host-side check and microbenchmark for the CRC32 in hash.c.
+// Cross-checks crc32_calculate() and crc32_update() against the bundled zlib crc32() for
+// every length and alignment up to a few hundred bytes and for random splits, then times
+// the byte-at-a-time loop, slice-by-8 and zlib.
+// Build with the Makefile in this directory. Prints a markdown table to stdout.
+
+#include "../hash.h"
+#include <zlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MIN_SECONDS 0.5
+#define CHECK_SIZE 1024
+
+static const size_t sizes[] = { 64, 1024, 64 * 1024, 4 * 1024 * 1024 };
+
+static double get_time(void)
+{
+   struct timespec tv;
+   clock_gettime(CLOCK_MONOTONIC, &tv);
+   return tv.tv_sec + tv.tv_nsec / 1000000000.0;
+}
+
+// The old fallback, kept as the baseline.
+static uint32_t crc32_bytewise(uint32_t crc, const uint8_t *data, size_t length)
+{
+   size_t i;
+   crc = ~crc;
+   for (i = 0; i < length; i++)
+      crc = crc32_adjust(crc, data[i]);
+   return ~crc;
+}
+
+static uint32_t crc32_zlib(uint32_t crc, const uint8_t *data, size_t length)
+{
+   return crc32(crc, data, length);
+}
+
+static bool check(const uint8_t *buf)
+{
+   unsigned i;
+   size_t offset, length;
+
+   for (offset = 0; offset < 8; offset++)
+   {
+      for (length = 0; length <= 300; length++)
+      {
+         uint32_t ref = crc32(0, buf + offset, length);
+         if (crc32_calculate(buf + offset, length) != ref ||
+               crc32_bytewise(0, buf + offset, length) != ref)
+         {
+            fprintf(stderr, "CRC mismatch, offset %u, length %u.\n", (unsigned)offset, (unsigned)length);
+            return false;
+         }
+      }
+   }
+
+   // Incremental use, as when checksumming inflate output chunk by chunk.
+   for (i = 0; i < 10000; i++)
+   {
+      size_t split = rand() % CHECK_SIZE;
+      uint32_t crc = crc32_update(0, buf, split);
+      crc = crc32_update(crc, buf + split, CHECK_SIZE - split);
+      if (crc != crc32(0, buf, CHECK_SIZE))
+      {
+         fprintf(stderr, "Incremental CRC mismatch, split %u.\n", (unsigned)split);
+         return false;
+      }
+   }
+
+   return true;
+}
+
+static double bench(uint32_t (*func)(uint32_t, const uint8_t*, size_t), const uint8_t *buf, size_t size,
+      uint32_t *crc)
+{
+   unsigned runs;
+   double start = get_time();
+   for (runs = 0; get_time() - start < MIN_SECONDS; runs++)
+      *crc = func(*crc, buf, size);
+
+   return (double)size * runs / (get_time() - start) / (1024.0 * 1024.0);
+}
+
+int main(void)
+{
+   size_t i, s;
+   size_t max_size = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+   uint8_t *buf = (uint8_t*)malloc(max_size + 8);
+   if (!buf)
+      return 1;
+
+   srand(1);
+   for (i = 0; i < max_size + 8; i++)
+      buf[i] = rand();
+
+   if (!check(buf))
+      return 1;
+
+   printf("CRC32 throughput in MB/s. Results cross-checked against zlib crc32().\n\n");
+   printf("| Bytes | Byte at a time | Slice-by-8 | zlib |\n");
+   printf("|-------|----------------|------------|------|\n");
+
+   for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+   {
+      uint32_t crcs[3] = {0};
+      double bytewise = bench(crc32_bytewise, buf, sizes[s], &crcs[0]);
+      double sliced   = bench(crc32_update, buf, sizes[s], &crcs[1]);
+      double zlib     = bench(crc32_zlib, buf, sizes[s], &crcs[2]);
+
+      printf("| %u | %.0f | %.0f | %.0f |\n", (unsigned)sizes[s], bytewise, sliced, zlib);
+   }
+
+   free(buf);
+   return 0;
+}
@@ -0,0 +1,309 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "thread.h"
+#include <stdlib.h>
+
+#if defined(HW_RVL) || defined(HW_DOL)
+#include <ogc/lwp.h>
+#include <ogc/mutex.h>
+#include <ogc/cond.h>
+#include <time.h>
+
+// The main thread runs at priority 64.
+#define STHREAD_PRIORITY_BELOW_MAIN 63
+#define STHREAD_PRIORITY_ABOVE_MAIN 65
+#define STHREAD_STACK_SIZE (64 * 1024)
+
+struct sthread
+{
+   lwp_t id;
+   void (*func)(void*);
+   void *userdata;
+};
+
+struct slock
+{
+   mutex_t lock;
+};
+
+struct scond
+{
+   cond_t cond;
+};
+
+static void *thread_wrap(void *data)
+{
+   sthread_t *thread = (sthread_t*)data;
+   thread->func(thread->userdata);
+   return NULL;
+}
+
+sthread_t *sthread_create_priority(void (*thread_func)(void*), void *userdata, enum sthread_priority priority)
+{
+   sthread_t *thread = (sthread_t*)calloc(1, sizeof(*thread));
+   if (!thread)
+      return NULL;
+
+   thread->func = thread_func;
+   thread->userdata = userdata;
+
+   if (LWP_CreateThread(&thread->id, thread_wrap, thread, NULL, STHREAD_STACK_SIZE,
+            priority == STHREAD_PRIORITY_REALTIME ? STHREAD_PRIORITY_ABOVE_MAIN : STHREAD_PRIORITY_BELOW_MAIN) < 0)
+   {
+      free(thread);
+      return NULL;
+   }
+
+   return thread;
+}
+
+void sthread_join(sthread_t *thread)
+{
+   LWP_JoinThread(thread->id, NULL);
+   free(thread);
+}
+
+slock_t *slock_new(void)
+{
+   slock_t *lock = (slock_t*)calloc(1, sizeof(*lock));
+   if (!lock)
+      return NULL;
+
+   if (LWP_MutexInit(&lock->lock, false) < 0)
+   {
+      free(lock);
+      return NULL;
+   }
+
+   return lock;
+}
+
+void slock_free(slock_t *lock)
+{
+   if (!lock)
+      return;
+
+   LWP_MutexDestroy(lock->lock);
+   free(lock);
+}
+
+void slock_lock(slock_t *lock)
+{
+   LWP_MutexLock(lock->lock);
+}
+
+void slock_unlock(slock_t *lock)
+{
+   LWP_MutexUnlock(lock->lock);
+}
+
+scond_t *scond_new(void)
+{
+   scond_t *cond = (scond_t*)calloc(1, sizeof(*cond));
+   if (!cond)
+      return NULL;
+
+   if (LWP_CondInit(&cond->cond) < 0)
+   {
+      free(cond);
+      return NULL;
+   }
+
+   return cond;
+}
+
+void scond_free(scond_t *cond)
+{
+   if (!cond)
+      return;
+
+   LWP_CondDestroy(cond->cond);
+   free(cond);
+}
+
+void scond_wait(scond_t *cond, slock_t *lock)
+{
+   LWP_CondWait(cond->cond, lock->lock);
+}
+
+bool scond_wait_timeout(scond_t *cond, slock_t *lock, int64_t timeout_us)
+{
+   // LWP takes a relative timeout.
+   struct timespec ts;
+   ts.tv_sec  = timeout_us / 1000000;
+   ts.tv_nsec = (timeout_us % 1000000) * 1000;
+   return LWP_CondTimedWait(cond->cond, lock->lock, &ts) == 0;
+}
+
+void scond_signal(scond_t *cond)
+{
+   LWP_CondSignal(cond->cond);
+}
+
+void scond_broadcast(scond_t *cond)
+{
+   LWP_CondBroadcast(cond->cond);
+}
+
+#else
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+struct sthread
+{
+   pthread_t id;
+   void (*func)(void*);
+   void *userdata;
+};
+
+struct slock
+{
+   pthread_mutex_t lock;
+};
+
+struct scond
+{
+   pthread_cond_t cond;
+};
+
+static void *thread_wrap(void *data)
+{
+   sthread_t *thread = (sthread_t*)data;
+   thread->func(thread->userdata);
+   return NULL;
+}
+
+sthread_t *sthread_create_priority(void (*thread_func)(void*), void *userdata, enum sthread_priority priority)
+{
+   sthread_t *thread = (sthread_t*)calloc(1, sizeof(*thread));
+   if (!thread)
+      return NULL;
+
+   (void)priority;
+   thread->func = thread_func;
+   thread->userdata = userdata;
+
+   if (pthread_create(&thread->id, NULL, thread_wrap, thread) != 0)
+   {
+      free(thread);
+      return NULL;
+   }
+
+   return thread;
+}
+
+void sthread_join(sthread_t *thread)
+{
+   pthread_join(thread->id, NULL);
+   free(thread);
+}
+
+slock_t *slock_new(void)
+{
+   slock_t *lock = (slock_t*)calloc(1, sizeof(*lock));
+   if (!lock)
+      return NULL;
+
+   if (pthread_mutex_init(&lock->lock, NULL) != 0)
+   {
+      free(lock);
+      return NULL;
+   }
+
+   return lock;
+}
+
+void slock_free(slock_t *lock)
+{
+   if (!lock)
+      return;
+
+   pthread_mutex_destroy(&lock->lock);
+   free(lock);
+}
+
+void slock_lock(slock_t *lock)
+{
+   pthread_mutex_lock(&lock->lock);
+}
+
+void slock_unlock(slock_t *lock)
+{
+   pthread_mutex_unlock(&lock->lock);
+}
+
+scond_t *scond_new(void)
+{
+   scond_t *cond = (scond_t*)calloc(1, sizeof(*cond));
+   if (!cond)
+      return NULL;
+
+   if (pthread_cond_init(&cond->cond, NULL) != 0)
+   {
+      free(cond);
+      return NULL;
+   }
+
+   return cond;
+}
+
+void scond_free(scond_t *cond)
+{
+   if (!cond)
+      return;
+
+   pthread_cond_destroy(&cond->cond);
+   free(cond);
+}
+
+void scond_wait(scond_t *cond, slock_t *lock)
+{
+   pthread_cond_wait(&cond->cond, &lock->lock);
+}
+
+bool scond_wait_timeout(scond_t *cond, slock_t *lock, int64_t timeout_us)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_REALTIME, &ts);
+
+   ts.tv_sec  += timeout_us / 1000000;
+   ts.tv_nsec += (timeout_us % 1000000) * 1000;
+   if (ts.tv_nsec >= 1000000000)
+   {
+      ts.tv_sec++;
+      ts.tv_nsec -= 1000000000;
+   }
+
+   return pthread_cond_timedwait(&cond->cond, &lock->lock, &ts) != ETIMEDOUT;
+}
+
+void scond_signal(scond_t *cond)
+{
+   pthread_cond_signal(&cond->cond);
+}
+
+void scond_broadcast(scond_t *cond)
+{
+   pthread_cond_broadcast(&cond->cond);
+}
+
+#endif
+
+sthread_t *sthread_create(void (*thread_func)(void*), void *userdata)
+{
+   return sthread_create_priority(thread_func, userdata, STHREAD_PRIORITY_BACKGROUND);
+}
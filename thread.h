@@ -0,0 +1,53 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RARCH_THREAD_H
+#define __RARCH_THREAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Minimal threading abstraction, pthreads on POSIX and LWP on GX.
+
+typedef struct sthread sthread_t;
+typedef struct slock slock_t;
+typedef struct scond scond_t;
+
+enum sthread_priority
+{
+   STHREAD_PRIORITY_BACKGROUND = 0, // Below the main thread.
+   STHREAD_PRIORITY_REALTIME        // Above the main thread. Must block regularly or it starves emulation.
+};
+
+// Priorities only apply on GX, POSIX threads are created with the default policy.
+sthread_t *sthread_create(void (*thread_func)(void*), void *userdata);
+sthread_t *sthread_create_priority(void (*thread_func)(void*), void *userdata, enum sthread_priority priority);
+void sthread_join(sthread_t *thread);
+
+slock_t *slock_new(void);
+void slock_free(slock_t *lock);
+void slock_lock(slock_t *lock);
+void slock_unlock(slock_t *lock);
+
+scond_t *scond_new(void);
+void scond_free(scond_t *cond);
+void scond_wait(scond_t *cond, slock_t *lock);
+// Returns false on timeout.
+bool scond_wait_timeout(scond_t *cond, slock_t *lock, int64_t timeout_us);
+void scond_signal(scond_t *cond);
+void scond_broadcast(scond_t *cond);
+
+#endif
+
@@ -0,0 +1,139 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trace.h"
+#include "general.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+struct rarch_trace_event rarch_trace_ring[RARCH_TRACE_EVENTS];
+unsigned rarch_trace_ptr;
+
+#if defined(HAVE_THREADS) && defined(__GNUC__)
+__thread unsigned rarch_trace_tid;
+
+void rarch_trace_set_thread(enum rarch_trace_thread tid)
+{
+   rarch_trace_tid = tid;
+}
+#else
+void rarch_trace_set_thread(enum rarch_trace_thread tid)
+{
+   (void)tid;
+}
+#endif
+
+static const char *trace_thread_names[RARCH_TRACE_THREAD_LAST] = {
+   "main",
+   "video",
+};
+
+static const char *trace_stage_names[RARCH_TRACE_STAGE_LAST] = {
+   "frame",
+   "input_poll",
+   "retro_run",
+   "rewind_push",
+   "rewind_pop",
+   "softfilter",
+   "texture_convert",
+   "audio_flush",
+   "vblank_wait",
+};
+
+// Copies the event behind ticket, false if it is not complete or was overwritten meanwhile.
+static bool trace_read_event(unsigned ticket, struct rarch_trace_event *out)
+{
+   const volatile struct rarch_trace_event *ev = &rarch_trace_ring[ticket & (RARCH_TRACE_EVENTS - 1)];
+
+   uint32_t seq = ev->seq;
+   RARCH_TRACE_BARRIER();
+   out->time  = ev->time;
+   out->stage = ev->stage;
+   out->end   = ev->end;
+   out->tid   = ev->tid;
+   RARCH_TRACE_BARRIER();
+
+   return seq == ticket + 1 && ev->seq == seq &&
+      out->stage < RARCH_TRACE_STAGE_LAST && out->tid < RARCH_TRACE_THREAD_LAST;
+}
+
+bool rarch_trace_dump(const char *path)
+{
+   unsigned i, start, count, events = 0, written = 0;
+   unsigned depth[RARCH_TRACE_THREAD_LAST][RARCH_TRACE_STAGE_LAST] = {{0}};
+
+   unsigned end = rarch_trace_ptr;
+   count = end < RARCH_TRACE_EVENTS ? end : RARCH_TRACE_EVENTS;
+   start = end - count;
+
+   struct rarch_trace_event *snapshot = (struct rarch_trace_event*)malloc(count * sizeof(*snapshot) + 1);
+   if (!snapshot)
+      return false;
+
+   // Slot order is not time order across threads, so the oldest event need not be in the first slot.
+   retro_perf_tick_t base = 0;
+   for (i = 0; i < count; i++)
+   {
+      struct rarch_trace_event *ev = &snapshot[events];
+      if (!trace_read_event(start + i, ev))
+         continue;
+      if (!events || ev->time < base)
+         base = ev->time;
+      events++;
+   }
+
+   FILE *file = fopen(path, "w");
+   if (!file)
+   {
+      RARCH_ERR("Failed to open trace file \"%s\".\n", path);
+      free(snapshot);
+      return false;
+   }
+
+   double ticks_per_usec = rarch_get_perf_ticks_per_usec();
+
+   fprintf(file, "{\"traceEvents\":[\n");
+   for (i = 0; i < RARCH_TRACE_THREAD_LAST; i++)
+      fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+            i ? ",\n" : "", i, trace_thread_names[i]);
+
+   for (i = 0; i < events; i++)
+   {
+      const struct rarch_trace_event *ev = &snapshot[i];
+
+      // Begin was overwritten when the ring wrapped, drop the orphaned end.
+      // Nesting is tracked per thread, as B/E pairs only have to match within one.
+      unsigned *stage_depth = &depth[ev->tid][ev->stage];
+      if (ev->end)
+      {
+         if (!*stage_depth)
+            continue;
+         (*stage_depth)--;
+      }
+      else
+         (*stage_depth)++;
+
+      fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%u}",
+            trace_stage_names[ev->stage], ev->end ? 'E' : 'B',
+            (ev->time - base) / ticks_per_usec, (unsigned)ev->tid);
+      written++;
+   }
+   fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+   fclose(file);
+   free(snapshot);
+   RARCH_LOG("Dumped %u trace events to \"%s\".\n", written, path);
+   return true;
+}
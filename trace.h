@@ -0,0 +1,117 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ * 
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RARCH_TRACE_H
+#define __RARCH_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-frame stage tracing. Compiled out entirely unless HAVE_TRACE is defined.
+// Events go into a fixed ring buffer and can be dumped as Chrome trace-event JSON
+// (chrome://tracing, Perfetto).
+
+enum rarch_trace_stage
+{
+   RARCH_TRACE_FRAME = 0,
+   RARCH_TRACE_INPUT_POLL,
+   RARCH_TRACE_CORE_RUN,
+   RARCH_TRACE_REWIND_PUSH,
+   RARCH_TRACE_REWIND_POP,
+   RARCH_TRACE_SOFTFILTER,
+   RARCH_TRACE_TEXTURE_CONVERT,
+   RARCH_TRACE_AUDIO_FLUSH,
+   RARCH_TRACE_VBLANK_WAIT,
+
+   RARCH_TRACE_STAGE_LAST
+};
+
+#ifdef HAVE_TRACE
+#include "performance.h"
+
+#define RARCH_TRACE_EVENTS (1 << 14) // Must be power of two. Roughly 1000 frames.
+
+// Threads which emit events. Each gets its own track in the trace.
+enum rarch_trace_thread
+{
+   RARCH_TRACE_THREAD_MAIN = 0,
+   RARCH_TRACE_THREAD_VIDEO,
+
+   RARCH_TRACE_THREAD_LAST
+};
+
+struct rarch_trace_event
+{
+   retro_perf_tick_t time;
+   uint16_t stage;
+   uint8_t end;
+   uint8_t tid;
+   // Slot ticket + 1 once the event is complete, 0 while it is being written.
+   uint32_t seq;
+};
+
+extern struct rarch_trace_event rarch_trace_ring[RARCH_TRACE_EVENTS];
+extern unsigned rarch_trace_ptr;
+
+#if defined(HAVE_THREADS) && defined(__GNUC__)
+extern __thread unsigned rarch_trace_tid;
+// Slots are claimed atomically, so the main and video threads can both record.
+#define RARCH_TRACE_NEXT_SLOT() __sync_fetch_and_add(&rarch_trace_ptr, 1)
+#define RARCH_TRACE_BARRIER() __sync_synchronize()
+#else
+#define rarch_trace_tid RARCH_TRACE_THREAD_MAIN
+#define RARCH_TRACE_NEXT_SLOT() (rarch_trace_ptr++)
+#define RARCH_TRACE_BARRIER() ((void)0)
+#endif
+
+// The slot is claimed before the clock is read, so with two threads a later slot
+// can hold an earlier time. rarch_trace_dump() takes care of that.
+static inline void rarch_trace_mark(unsigned stage, bool end)
+{
+   unsigned ticket = RARCH_TRACE_NEXT_SLOT();
+   struct rarch_trace_event *ev = &rarch_trace_ring[ticket & (RARCH_TRACE_EVENTS - 1)];
+   ev->seq   = 0;
+   RARCH_TRACE_BARRIER();
+   ev->time  = rarch_get_perf_counter();
+   ev->stage = stage;
+   ev->end   = end;
+   ev->tid   = rarch_trace_tid;
+   RARCH_TRACE_BARRIER();
+   ev->seq   = ticket + 1;
+}
+
+// Tags events recorded from the calling thread from now on.
+void rarch_trace_set_thread(enum rarch_trace_thread tid);
+
+// Writes the current ring contents, oldest first. Slots still being written are skipped.
+bool rarch_trace_dump(const char *path);
+
+#define RARCH_TRACE_BEGIN(stage) rarch_trace_mark(stage, false)
+#define RARCH_TRACE_END(stage) rarch_trace_mark(stage, true)
+#else
+#define RARCH_TRACE_BEGIN(stage) ((void)0)
+#define RARCH_TRACE_END(stage) ((void)0)
+#define rarch_trace_set_thread(tid) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif